@@ -0,0 +1,35 @@
+#ifndef ASYNC_IO_H
+#define ASYNC_IO_H
+
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <sys/types.h>
+
+namespace logicmaze {
+
+// Completion callback, ok is true when all requested bytes were transferred.
+// Runs on an engine thread, or on the submitting one if the request cannot
+// be submitted, and must not block on submitting more I/O.
+using IOCallback = std::function<void(bool ok)>;
+
+// Asynchronous positional file I/O with up to queue_depth requests in flight.
+// Submission blocks only when the queue is full.
+class AsyncIOEngine {
+public:
+    virtual ~AsyncIOEngine() = default;
+
+    virtual void SubmitRead(int fd, char* buffer, size_t size, off_t offset,
+                            IOCallback callback) = 0;
+    virtual void SubmitWrite(int fd, const char* buffer, size_t size, off_t offset,
+                             IOCallback callback) = 0;
+    virtual const char* Name() const = 0;
+
+    // io_uring when the kernel allows it (and allow_io_uring is set),
+    // otherwise ASYNC_IO_THREADS threads doing blocking pread/pwrite
+    static std::unique_ptr<AsyncIOEngine> Create(size_t queue_depth, bool allow_io_uring = true);
+};
+
+}  // namespace logicmaze
+
+#endif  // ASYNC_IO_H
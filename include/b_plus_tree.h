@@ -0,0 +1,155 @@
+#ifndef B_PLUS_TREE_H
+#define B_PLUS_TREE_H
+
+#include "config.h"
+#include "buffer_pool_manager.h"
+#include "page_guard.h"
+#include "b_plus_tree_page.h"
+#include <atomic>
+#include <functional>
+#include <utility>
+#include <vector>
+
+namespace logicmaze {
+
+template <typename KeyType, typename KeyComparator>
+class BPlusTreeIndex;
+
+// Walks leaf entries in key order, holding the current leaf's read latch
+template <typename KeyType, typename KeyComparator = std::less<KeyType>>
+class BPlusTreeIndexIterator {
+    using LeafPage = BPlusTreeLeafPage<KeyType, KeyComparator>;
+
+public:
+    bool IsEnd() const { return !guard_.IsValid(); }
+    void Next();
+
+    KeyType GetKey() const { return LeafPage::View(guard_.GetPage()).KeyAt(index_); }
+    const RID& GetRID() const { return LeafPage::View(guard_.GetPage()).ValueAt(index_); }
+
+private:
+    friend class BPlusTreeIndex<KeyType, KeyComparator>;
+    BPlusTreeIndexIterator(BufferPoolManager* bpm, ReadPageGuard guard, uint32_t index);
+    // Move on to the next leaf while index_ is past the current one's end
+    void SkipExhausted();
+
+    BufferPoolManager* bpm_;
+    ReadPageGuard guard_;
+    uint32_t index_;
+};
+
+// Unique-key B+ tree index from KeyType to RID on INDEX pages of the
+// buffer pool, keys ordered by KeyComparator. Nodes keep their keys in
+// one contiguous array of the key type (see BPlusTreeNodeLayout), so the
+// narrower the key, the more children a node has. A node whose composite
+// keys, ordered by BPlusTreeCompositeKeyComparator, all share their first
+// field stores it once and only the second field per entry (see
+// BPlusTreeKeyPrefix). It is compiled for int32_t,
+// int64_t and BPlusTreeCompositeKey keys. A header page holds the root and
+// the node sizes, so a tree is opened again from that page's id. Leaves
+// are linked left to right for range scans.
+//
+// Concurrency is latch crabbing on the page guards. Lookups take read
+// latches down the tree, releasing each parent once the child is held.
+// Inserts and removes first go down the same way, write-latching only the
+// leaf; if the leaf might split or underflow they give up and restart,
+// write-latching from the header page down and releasing the ancestors
+// above every node that is safe. Latches on siblings are always taken
+// left before right, like a scan's, so the two cannot deadlock.
+template <typename KeyType, typename KeyComparator = std::less<KeyType>>
+class BPlusTreeIndex {
+    using LeafPage = BPlusTreeLeafPage<KeyType, KeyComparator>;
+    using InternalPage = BPlusTreeInternalPage<KeyType, KeyComparator>;
+
+public:
+    using Iterator = BPlusTreeIndexIterator<KeyType, KeyComparator>;
+    // Entry source for BulkLoad: sets the next key and RID, or returns
+    // false at the end
+    using EntrySource = std::function<bool(KeyType*, RID*)>;
+
+    // Create an empty tree whose nodes fill a page
+    explicit BPlusTreeIndex(BufferPoolManager* bpm);
+    // Create an empty tree with smaller nodes
+    BPlusTreeIndex(BufferPoolManager* bpm, uint32_t leaf_max_size, uint32_t internal_max_size);
+    // Open a tree created earlier
+    BPlusTreeIndex(BufferPoolManager* bpm, page_id_t header_page_id);
+
+    BPlusTreeIndex(const BPlusTreeIndex&) = delete;
+    BPlusTreeIndex& operator=(const BPlusTreeIndex&) = delete;
+
+    bool GetValue(const KeyType& key, RID* rid);
+    // False if the key is already in the tree
+    bool Insert(const KeyType& key, const RID& rid);
+    // False if the key is not in the tree
+    bool Remove(const KeyType& key);
+
+    // Build an empty tree bottom-up from entries in strictly ascending key
+    // order, in one pass and without searching it. Nodes are filled to
+    // fill_factor of their max size (but at least their min size), leaving
+    // room for later inserts. Leaves come from runs of consecutive pages,
+    // so range scans read the file in order. Other threads wait until it
+    // is done. Returns the number of entries loaded. Throws
+    // std::logic_error if the tree is not empty and std::invalid_argument
+    // on an out-of-order key, in which case the tree stays empty.
+    size_t BulkLoad(const EntrySource& source, double fill_factor = 1.0);
+
+    // First entry, or the first with a key not below key
+    Iterator Begin();
+    Iterator Begin(const KeyType& key);
+
+    page_id_t GetHeaderPageId() const { return header_page_id_; }
+    uint32_t GetHeight();
+    // Inserts and removes that had to redo their descent with write latches
+    size_t GetPessimisticCount() const { return pessimistic_count_; }
+
+private:
+    enum class Operation { INSERT, REMOVE };
+
+    // Write latches held by a pessimistic descent: the header page while
+    // the root may change, then the nodes from the topmost unsafe one down.
+    // new_pages are pinned pages set aside for splits.
+    struct WriteContext {
+        WritePageGuard header;
+        std::vector<WritePageGuard> path;
+        std::vector<std::pair<page_id_t, Page*>> new_pages;
+    };
+
+    ReadPageGuard FetchRead(page_id_t page_id);
+    WritePageGuard FetchWrite(page_id_t page_id);
+    Page* NewNode(page_id_t* page_id);
+    // Give back the pages set aside for splits that were not needed
+    void ReleaseNewPages(WriteContext* ctx);
+
+    // Read-latched leaf that would hold key
+    ReadPageGuard FindLeafRead(const KeyType& key, bool leftmost);
+    // Optimistic descent: the write-latched leaf for key if the operation
+    // cannot change its parent, else an invalid guard
+    WritePageGuard FindLeafOptimistic(const KeyType& key, Operation op);
+    // Pessimistic descent, filling ctx
+    void FindLeafPessimistic(const KeyType& key, Operation op, WriteContext* ctx);
+    // Whether an operation on key cannot change the node's parent
+    bool IsSafe(const Page* page, const KeyType& key, Operation op, bool is_root) const;
+
+    // A node at ctx->path[index] split off right_page_id, whose smallest
+    // key is key: add it to the parent, splitting upwards as needed
+    void InsertIntoParent(WriteContext* ctx, size_t index, const KeyType& key, page_id_t right_page_id);
+    // ctx->path[index] fell below its minimum: borrow from or merge with a
+    // sibling, then fix the parent
+    void HandleUnderflow(WriteContext* ctx, size_t index);
+    void DeleteNode(WritePageGuard* guard);
+
+    BufferPoolManager* bpm_;
+    page_id_t header_page_id_;
+    uint32_t leaf_max_size_;
+    uint32_t internal_max_size_;
+    std::atomic<size_t> pessimistic_count_;
+};
+
+// The index over 64-bit keys the rest of the code uses
+using BPlusTree = BPlusTreeIndex<BPlusTreeKey>;
+using BPlusTreeIterator = BPlusTree::Iterator;
+using BPlusTreeEntrySource = BPlusTree::EntrySource;
+
+}  // namespace logicmaze
+
+#endif  // B_PLUS_TREE_H
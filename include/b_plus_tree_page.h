@@ -0,0 +1,309 @@
+#ifndef B_PLUS_TREE_PAGE_H
+#define B_PLUS_TREE_PAGE_H
+
+#include "config.h"
+#include "page.h"
+#include "table_page.h"
+#include <cstring>
+#include <functional>
+#include <type_traits>
+
+namespace logicmaze {
+
+using BPlusTreeKey = int64_t;
+
+// Two 32-bit fields ordered by the first, then the second, such as
+// (session_id, row_index)
+struct BPlusTreeCompositeKey {
+    int32_t first;
+    int32_t second;
+};
+
+struct BPlusTreeCompositeKeyComparator {
+    bool operator()(const BPlusTreeCompositeKey& a, const BPlusTreeCompositeKey& b) const {
+        return a.first < b.first || (a.first == b.first && a.second < b.second);
+    }
+};
+
+// Start of the data area of a tree's header page
+struct BPlusTreeHeader {
+    page_id_t root_page_id;
+    uint32_t root_level;        // Height of the tree minus one
+    uint32_t leaf_max_size;
+    uint32_t internal_max_size;
+};
+
+// How a key splits into a prefix, stored once in a node whose keys all
+// share it, and a suffix stored per entry. Nodes search prefixes and
+// suffixes with operator<, so a specialization is only valid for a
+// comparator ordering keys by prefix, then by suffix. Other key and
+// comparator pairs are always stored in full.
+template <typename KeyType, typename KeyComparator>
+struct BPlusTreeKeyPrefix {
+    static constexpr bool ENABLED = false;
+    using Prefix = int32_t;
+    using Suffix = KeyType;
+    static Prefix PrefixOf(const KeyType&) { return 0; }
+    static Suffix SuffixOf(const KeyType& key) { return key; }
+    static KeyType Join(Prefix, const Suffix& suffix) { return suffix; }
+};
+
+// Composite keys in their lexicographic order drop first, so a node
+// within one session holds row indexes only
+template <>
+struct BPlusTreeKeyPrefix<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator> {
+    static constexpr bool ENABLED = true;
+    using Prefix = int32_t;
+    using Suffix = int32_t;
+    static Prefix PrefixOf(const BPlusTreeCompositeKey& key) { return key.first; }
+    static Suffix SuffixOf(const BPlusTreeCompositeKey& key) { return key.second; }
+    static BPlusTreeCompositeKey Join(Prefix prefix, Suffix suffix) { return {prefix, suffix}; }
+};
+
+// Start of the data area of every node
+struct BPlusTreeNodeHeader {
+    uint16_t level;             // 0 for leaves, parents of leaves are 1
+    uint16_t prefix_max_size;   // Max size while the keys share a prefix, 0 when stored in full
+    uint32_t size;              // Entries in a leaf, children of an internal node
+    uint32_t max_size;          // With keys stored in full
+    page_id_t next_page_id;     // Leaves only: right sibling
+};
+
+// Fields shared by both node kinds, viewed over an INDEX page
+class BPlusTreeNode {
+public:
+    explicit BPlusTreeNode(Page* page) : page_(page) {}
+
+    bool IsLeaf() const { return GetNodeHeader()->level == 0; }
+    uint16_t GetLevel() const { return GetNodeHeader()->level; }
+    uint32_t GetSize() const { return GetNodeHeader()->size; }
+    // A node whose keys share a prefix holds more entries
+    bool HasPrefix() const { return GetNodeHeader()->prefix_max_size != 0; }
+    uint32_t GetMaxSize() const {
+        return HasPrefix() ? GetNodeHeader()->prefix_max_size : GetNodeHeader()->max_size;
+    }
+    // Fewest entries a node other than the root may have. It follows the
+    // max size with full keys, so two nodes at their minimum always fit
+    // in one and an underfull node can take an entry of any key.
+    uint32_t GetMinSize() const {
+        uint32_t max_size = GetNodeHeader()->max_size;
+        return IsLeaf() ? max_size / 2 : (max_size + 1) / 2;
+    }
+
+protected:
+    void InitNode(page_id_t page_id, uint16_t level, uint32_t max_size);
+    BPlusTreeNodeHeader* GetNodeHeader() {
+        return reinterpret_cast<BPlusTreeNodeHeader*>(page_->GetData());
+    }
+    const BPlusTreeNodeHeader* GetNodeHeader() const {
+        return reinterpret_cast<const BPlusTreeNodeHeader*>(page_->GetData());
+    }
+    void SetSize(uint32_t size) { GetNodeHeader()->size = size; }
+
+    Page* page_;
+};
+
+// Node layout for fixed-width keys: after the node header (and, for nodes
+// with a shared prefix, the prefix), an array of CAPACITY keys and then
+// one of CAPACITY values, so binary search reads only keys and a page
+// holds as many entries as their combined width allows. Nodes may go one
+// over their max size while they are being split, so max sizes are at
+// most CAPACITY minus one.
+template <typename KeyType, typename ValueType, size_t PREFIX_SIZE = 0>
+struct BPlusTreeNodeLayout {
+    static constexpr size_t PREFIX_OFFSET = sizeof(BPlusTreeNodeHeader);
+    static constexpr uint32_t CAPACITY = static_cast<uint32_t>(
+        (PAGE_DATA_SIZE - sizeof(BPlusTreeNodeHeader) - PREFIX_SIZE) /
+        (sizeof(KeyType) + sizeof(ValueType)));
+    static constexpr size_t KEYS_OFFSET = PREFIX_OFFSET + PREFIX_SIZE;
+    static constexpr size_t VALUES_OFFSET =
+        (KEYS_OFFSET + CAPACITY * sizeof(KeyType) + alignof(ValueType) - 1) / alignof(ValueType) *
+        alignof(ValueType);
+
+    static_assert(VALUES_OFFSET + CAPACITY * sizeof(ValueType) <= PAGE_DATA_SIZE,
+                  "B+ tree node must fit a page");
+    static_assert(KEYS_OFFSET % alignof(KeyType) == 0, "B+ tree keys must be aligned");
+};
+
+// Entry storage shared by both node kinds. Keys are stored in full, or,
+// when the keys from FIRST_KEY on share a prefix (see BPlusTreeKeyPrefix),
+// as suffixes behind the prefix stored once. A node switches to full keys
+// when a key without the prefix comes in, and back when a split, merge or
+// borrow leaves its keys sharing one again; the callers make sure a node
+// never has more entries than fit with full keys when it switches.
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+class BPlusTreeEntryNode : public BPlusTreeNode {
+protected:
+    using KeyPrefix = BPlusTreeKeyPrefix<KeyType, KeyComparator>;
+    using Prefix = typename KeyPrefix::Prefix;
+    using Suffix = typename KeyPrefix::Suffix;
+    using FullLayout = BPlusTreeNodeLayout<KeyType, ValueType>;
+    using PrefixLayout = std::conditional_t<KeyPrefix::ENABLED,
+                                            BPlusTreeNodeLayout<Suffix, ValueType, sizeof(Prefix)>,
+                                            FullLayout>;
+
+public:
+    static constexpr uint32_t CAPACITY = FullLayout::CAPACITY;
+    static constexpr uint32_t PREFIX_CAPACITY =
+        KeyPrefix::ENABLED ? PrefixLayout::CAPACITY : FullLayout::CAPACITY;
+
+    explicit BPlusTreeEntryNode(Page* page) : BPlusTreeNode(page) {}
+
+    KeyType KeyAt(uint32_t index) const {
+        if (HasPrefix()) {
+            return KeyPrefix::Join(GetPrefix(), GetSuffixes()[index]);
+        }
+        return GetFullKeys()[index];
+    }
+    const ValueType& ValueAt(uint32_t index) const { return GetValues()[index]; }
+    bool HasPrefix() const { return KeyPrefix::ENABLED && BPlusTreeNode::HasPrefix(); }
+    // Max size the node has once key is added
+    uint32_t MaxSizeWith(const KeyType& key) const {
+        return HasPrefix() && !SharesPrefix(key) ? GetFullMaxSize() : GetMaxSize();
+    }
+
+protected:
+    uint32_t GetFullMaxSize() const { return GetNodeHeader()->max_size; }
+    bool SharesPrefix(const KeyType& key) const { return KeyPrefix::PrefixOf(key) == GetPrefix(); }
+    Prefix GetPrefix() const {
+        Prefix prefix;
+        std::memcpy(&prefix, page_->GetData() + PrefixLayout::PREFIX_OFFSET, sizeof(prefix));
+        return prefix;
+    }
+
+    // Index of the first key in [begin, end) above key, or not below it
+    uint32_t Search(const KeyType& key, uint32_t begin, uint32_t end, bool upper) const;
+    // Store a key or value; a key without the node's prefix at FIRST_KEY
+    // or later switches the node to full keys
+    void SetKey(uint32_t index, const KeyType& key);
+    void SetValue(uint32_t index, const ValueType& value) { GetValues()[index] = value; }
+    // Add an entry at index; the first key stored decides the prefix
+    void InsertEntry(uint32_t index, const KeyType& key, const ValueType& value);
+    // Copy count entries of source from index from to index to of this
+    // node, which already has room for them. A node being filled from the
+    // start takes the source's prefix.
+    void CopyEntries(const BPlusTreeEntryNode& source, uint32_t from, uint32_t to, uint32_t count);
+    // Open a one-entry gap at index, or close the one there
+    void ShiftRight(uint32_t index);
+    void ShiftLeft(uint32_t index);
+    // Store the shared prefix once if the keys have one
+    void Compact();
+    // Switch to full keys; throws if they do not fit
+    void Expand();
+
+private:
+    KeyType* GetFullKeys() {
+        return reinterpret_cast<KeyType*>(page_->GetData() + FullLayout::KEYS_OFFSET);
+    }
+    const KeyType* GetFullKeys() const {
+        return reinterpret_cast<const KeyType*>(page_->GetData() + FullLayout::KEYS_OFFSET);
+    }
+    Suffix* GetSuffixes() {
+        return reinterpret_cast<Suffix*>(page_->GetData() + PrefixLayout::KEYS_OFFSET);
+    }
+    const Suffix* GetSuffixes() const {
+        return reinterpret_cast<const Suffix*>(page_->GetData() + PrefixLayout::KEYS_OFFSET);
+    }
+    ValueType* GetValues() {
+        return reinterpret_cast<ValueType*>(
+            page_->GetData() + (HasPrefix() ? PrefixLayout::VALUES_OFFSET : FullLayout::VALUES_OFFSET));
+    }
+    const ValueType* GetValues() const {
+        return reinterpret_cast<const ValueType*>(
+            page_->GetData() + (HasPrefix() ? PrefixLayout::VALUES_OFFSET : FullLayout::VALUES_OFFSET));
+    }
+    // Max size while the keys share a prefix: as many more entries as the
+    // narrower keys make room for, but few enough that either half of a
+    // split node takes another entry with full keys
+    uint32_t PrefixMaxSize() const;
+};
+
+// Leaf node for KeyType keys ordered by KeyComparator, a stateless strict
+// weak ordering. The tree is compiled for int32_t, int64_t and
+// BPlusTreeCompositeKey keys.
+template <typename KeyType, typename KeyComparator = std::less<KeyType>>
+class BPlusTreeLeafPage : public BPlusTreeEntryNode<KeyType, RID, KeyComparator, 0> {
+    using Base = BPlusTreeEntryNode<KeyType, RID, KeyComparator, 0>;
+
+public:
+    explicit BPlusTreeLeafPage(Page* page) : Base(page) {}
+    // Read-only view; only const members can be called on it
+    static const BPlusTreeLeafPage View(const Page* page) {
+        return BPlusTreeLeafPage(const_cast<Page*>(page));
+    }
+
+    void Init(page_id_t page_id, uint32_t max_size);
+
+    page_id_t GetNextPageId() const { return this->GetNodeHeader()->next_page_id; }
+    void SetNextPageId(page_id_t page_id) { this->GetNodeHeader()->next_page_id = page_id; }
+
+    // First entry with a key not below key (GetSize() if none)
+    uint32_t LowerBound(const KeyType& key) const;
+    bool Lookup(const KeyType& key, RID* rid) const;
+    // False if the key is already there
+    bool Insert(const KeyType& key, const RID& rid);
+    // False if the key is not there
+    bool Remove(const KeyType& key);
+    // Bulk loading: add an entry past the last one, key being the largest
+    void Append(const KeyType& key, const RID& rid);
+
+    // Split: move the upper half to an empty right sibling
+    void MoveHalfTo(BPlusTreeLeafPage* recipient);
+    // Merge: append everything to the left sibling
+    void MoveAllTo(BPlusTreeLeafPage* recipient);
+    // Borrow between siblings
+    void MoveFirstToEndOf(BPlusTreeLeafPage* recipient);
+    void MoveLastToFrontOf(BPlusTreeLeafPage* recipient);
+};
+
+// Internal node: entry i holds child i and the smallest key of its
+// subtree; the key of entry 0 is unused and not part of a shared prefix
+template <typename KeyType, typename KeyComparator = std::less<KeyType>>
+class BPlusTreeInternalPage : public BPlusTreeEntryNode<KeyType, page_id_t, KeyComparator, 1> {
+    using Base = BPlusTreeEntryNode<KeyType, page_id_t, KeyComparator, 1>;
+
+public:
+    explicit BPlusTreeInternalPage(Page* page) : Base(page) {}
+    static const BPlusTreeInternalPage View(const Page* page) {
+        return BPlusTreeInternalPage(const_cast<Page*>(page));
+    }
+
+    void Init(page_id_t page_id, uint16_t level, uint32_t max_size);
+
+    void SetKeyAt(uint32_t index, const KeyType& key);
+    // Whether SetKeyAt(index, key) keeps the node within its max size
+    bool CanSetKeyAt(uint32_t index, const KeyType& key) const;
+    page_id_t ChildAt(uint32_t index) const { return this->ValueAt(index); }
+
+    // Index of the child whose subtree covers key
+    uint32_t ChildIndex(const KeyType& key) const;
+    // Index of a child page, GetSize() if it is not one
+    uint32_t IndexOf(page_id_t child) const;
+    // Max size the node has once the child at child_index splits and adds
+    // its separator: keys between two of the node's own share its prefix
+    uint32_t MaxSizeAfterSplitOf(uint32_t child_index) const;
+
+    // Fill a new root with two children
+    void PopulateNewRoot(page_id_t left, const KeyType& key, page_id_t right);
+    // Add a child right after entry index, key being its smallest key
+    void InsertAfter(uint32_t index, const KeyType& key, page_id_t child);
+    void RemoveAt(uint32_t index);
+    // Bulk loading: add a child past the last one, key being its smallest
+    void Append(const KeyType& key, page_id_t child);
+
+    // Split: move the upper half to an empty right sibling; *middle_key
+    // gets the key that separates the two and goes up to the parent
+    void MoveHalfTo(BPlusTreeInternalPage* recipient, KeyType* middle_key);
+    // Merge into the left sibling; middle_key separates the two in the parent
+    void MoveAllTo(BPlusTreeInternalPage* recipient, const KeyType& middle_key);
+    // Borrow between siblings through the parent's separator middle_key;
+    // *new_middle_key is the separator that replaces it
+    void MoveFirstToEndOf(BPlusTreeInternalPage* recipient, const KeyType& middle_key,
+                          KeyType* new_middle_key);
+    void MoveLastToFrontOf(BPlusTreeInternalPage* recipient, const KeyType& middle_key,
+                           KeyType* new_middle_key);
+};
+
+}  // namespace logicmaze
+
+#endif  // B_PLUS_TREE_PAGE_H
@@ -4,16 +4,65 @@
 #include "config.h"
 #include "page.h"
 #include "disk_manager.h"
-#include "lru_replacer.h"
-#include <unordered_map>
+#include "log_manager.h"
+#include "replacer.h"
+#include "page_table.h"
+#include "page_guard.h"
+#include "frame_arena.h"
+#include <vector>
+#include <atomic>
 #include <mutex>
+#include <condition_variable>
+#include <shared_mutex>
 #include <memory>
+#include <string>
+#include <thread>
 
 namespace logicmaze {
 
+class ParallelBufferPoolManager;
+
+// Construction-time knobs for BufferPoolManager
+struct BufferPoolOptions {
+    ReplacerType replacer_type = ReplacerType::LRU;
+    // Only used by ReplacerType::LRU_K
+    size_t lru_k = LRUK_K;
+    uint64_t correlated_reference_period = LRUK_CORRELATED_PERIOD;
+    // Backing of the frame arena; huge pages cut TLB misses on large pools
+    HugePageMode huge_pages = HugePageMode::NONE;
+    // Largest size Resize may grow the pool to; 0 means the initial size.
+    // Frame memory for it is only reserved, not touched.
+    size_t max_pool_size = 0;
+
+    // Warm-up across restarts: when set, the pool reloads the pages listed
+    // in this file on construction and writes its resident set there on
+    // destruction (see DumpResidentPages/RestoreResidentPages)
+    std::string warm_up_file;
+    // Pages read ahead of a detected sequential scan, 0 disables it.
+    // Capped at a quarter of the pool.
+    size_t read_ahead_pages = READ_AHEAD_PAGES;
+
+    // Background thread that writes dirty unpinned pages ahead of eviction.
+    // It keeps the cleaner_lru_depth coldest evictable frames clean; once
+    // more than cleaner_dirty_ratio_high of the pool is dirty it also writes
+    // hotter frames until the ratio is back under cleaner_dirty_ratio_low.
+    bool enable_page_cleaner = false;
+    size_t cleaner_lru_depth = CLEANER_LRU_DEPTH;
+    double cleaner_dirty_ratio_high = 0.5;
+    double cleaner_dirty_ratio_low = 0.25;
+
+    // Write-ahead logging: before any dirty page is written back, the log
+    // is flushed up to the page's LSN. Not owned by the pool, and must
+    // outlive it (the destructor writes back dirty pages).
+    LogManager* log_manager = nullptr;
+};
+
 class BufferPoolManager {
 public:
-    BufferPoolManager(size_t pool_size, DiskManager* disk_manager);
+    BufferPoolManager(size_t pool_size, DiskManager* disk_manager,
+                      const BufferPoolOptions& options = BufferPoolOptions());
+    // Writes back every page through FlushAllPages, so no write guard may
+    // still be alive
     ~BufferPoolManager();
 
     BufferPoolManager(const BufferPoolManager&) = delete;
@@ -21,12 +70,70 @@ public:
 
     Page* FetchPage(page_id_t page_id);
     bool UnpinPage(page_id_t page_id, bool is_dirty);
+    // Write back a page, or every page. Unpinned pages are written if
+    // dirty; pinned ones always, as their users may not have reported a
+    // change yet, from a copy taken under the frame's shared latch. So the
+    // calling thread must not hold a write guard on any page it flushes.
     bool FlushPage(page_id_t page_id);
     void FlushAllPages();
     Page* NewPage(page_id_t* page_id);
     bool DeletePage(page_id_t page_id);
+    // Allocate count consecutive pages on disk for a caller that wants
+    // them side by side, and return the first id. Each one is brought in
+    // with NewPageWithId; DeletePage gives back those left unused.
+    page_id_t AllocatePages(size_t count);
+    // Create a page for an id that was already allocated on disk by the caller
+    Page* NewPageWithId(page_id_t page_id);
+
+    // Pin the page and hold its frame latch for the life of the guard.
+    // An invalid guard is returned when no frame is available.
+    ReadPageGuard FetchPageRead(page_id_t page_id);
+    WritePageGuard FetchPageWrite(page_id_t page_id);
+
+    // Hint that pages [first, first + count) will be fetched soon. Missing
+    // pages are read asynchronously into free or evictable frames and left
+    // unpinned; stops early once every frame is pinned. Returns the number
+    // of reads issued.
+    size_t Prefetch(page_id_t first, size_t count);
+
+    // Write the ids of resident pages to path, hottest first: pinned pages,
+    // then the replacer's order from most to least recently used. Safe to
+    // call at any time, e.g. periodically so a crash does not lose it.
+    void DumpResidentPages(const std::string& path) const;
+    // Load pages listed by DumpResidentPages into free frames: the hottest
+    // ones that fit are read in page-id order as batched asynchronous
+    // reads, then ranked in the replacer by their recorded recency. Returns
+    // the number of pages now resident; a missing file loads nothing.
+    size_t RestoreResidentPages(const std::string& path);
+
+    // Change the number of frames, up to BufferPoolOptions::max_pool_size,
+    // while other threads keep using the pool. Growing is immediate.
+    // Shrinking writes back and evicts the pages in the removed frames,
+    // waiting for any that are pinned to be unpinned, so the caller must
+    // not hold pins itself. The memory of removed frames is returned to
+    // the OS. If a write-back fails the pool keeps its old size and the
+    // error is rethrown.
+    void Resize(size_t new_size);
+
+    // Fuzzy checkpoint, needs BufferPoolOptions::log_manager. Writes back
+    // the pages that are dirty when it starts, a batch at a time without
+    // holding the pool latch across I/O, so other threads keep working.
+    // It then logs the remaining dirty pages with their recovery LSNs and
+    // the active transactions, and records in the header page where
+    // recovery has to start redo. Returns the number of pages written.
+    // Pages that stay pinned throughout keep the redo point at their
+    // recovery LSN.
+    size_t Checkpoint();
 
     size_t GetPoolSize() const { return pool_size_; }
+    size_t GetMaxPoolSize() const { return max_pool_size_; }
+    HugePageMode GetHugePageMode() const { return arena_.GetHugePageMode(); }
+    // Pages brought in by Prefetch or read-ahead
+    size_t GetPrefetchCount() const { return prefetch_count_; }
+    // Dirty pages written back by a thread that needed their frame, and
+    // by the page cleaner ahead of time (explicit flushes count as neither)
+    size_t GetForegroundWriteCount() const { return foreground_write_count_; }
+    size_t GetBackgroundWriteCount() const { return background_write_count_; }
     size_t GetHitCount() const { return hit_count_; }
     size_t GetMissCount() const { return miss_count_; }
     double GetHitRate() const {
@@ -35,24 +142,130 @@ public:
     }
 
 private:
+    friend class ParallelBufferPoolManager;
+
+    // Per-frame metadata, cache-line aligned so frames do not false-share.
+    // Everything except the frame latch is guarded by latch_; the frame
+    // latch protects the page bytes and is taken by page guards, and in
+    // shared mode by flushes of pinned pages. It is never waited for while
+    // holding latch_.
+    //
+    // Disk I/O runs without latch_. While it does, io_pending is set and
+    // the frame is already mapped to page_id; if a dirty victim is being
+    // written back, its old page id also stays mapped to the frame so
+    // nobody re-reads it from disk before the write lands.
+    //
+    // cleaning is set while the page cleaner writes a copy of the page. It
+    // belongs to the cleaner and survives Reset(), so a thread that takes
+    // the frame over can wait for that write to finish.
+    //
+    // rec_lsn (only kept with a log manager) is the end of the log when the
+    // frame last matched its disk copy: redo of the frame's page from
+    // there reproduces it. It also survives Reset(), so while a dirty
+    // victim is written back the frame still covers the old page's changes.
+    struct alignas(64) FrameDescriptor {
+        page_id_t page_id = INVALID_PAGE_ID;
+        int pin_count = 0;
+        bool is_dirty = false;
+        bool io_pending = false;
+        bool cleaning = false;
+        bool prefetched = false;  // Read ahead and not fetched since
+        lsn_t rec_lsn = INVALID_LSN;
+        std::shared_mutex latch;
+
+        void Reset() {
+            page_id = INVALID_PAGE_ID;
+            pin_count = 0;
+            is_dirty = false;
+            io_pending = false;
+            prefetched = false;
+        }
+    };
+
     frame_id_t GetVictimFrame();
+    void MakeEvictable(frame_id_t frame_id);
+    // Forget the unpinned page in a frame without writing it back
+    void DiscardFrame(frame_id_t frame_id);
+    void ReleaseFrame(frame_id_t frame_id);
+    frame_id_t FindResidentFrame(page_id_t page_id, std::unique_lock<std::mutex>& lock);
+    frame_id_t FindIdleFrame(page_id_t page_id, std::unique_lock<std::mutex>& lock);
+    frame_id_t AcquireFrame(page_id_t page_id, std::unique_lock<std::mutex>& lock);
+    Page* InstallNewPage(page_id_t page_id, std::unique_lock<std::mutex>& lock);
+    // Copy the pages of pinned frames under their shared frame latches,
+    // so a page guard's holder is not midway through changing one. Pins
+    // each frame once more and drops latch_ while copying; give the pins
+    // back with UnpinCopiedFrames.
+    void CopyPinnedPages(const std::vector<frame_id_t>& frame_ids, std::vector<Page>* copies,
+                         std::unique_lock<std::mutex>& lock);
+    void UnpinCopiedFrames(const std::vector<frame_id_t>& frame_ids);
+    size_t StartPrefetch(page_id_t first, size_t count, std::unique_lock<std::mutex>& lock);
+    void CompletePrefetch(page_id_t page_id, frame_id_t frame_id, bool ok);
+    void ReadAhead(page_id_t page_id, std::unique_lock<std::mutex>& lock);
+    void CleanerLoop();
+    // Write copies of the dirty idle frames among candidates, starting at
+    // *position, up to one batch of copies; the write runs without latch_.
+    // Advances *position past the frames looked at and returns the number
+    // of pages written. On failure the frames are dirty again and the
+    // error is rethrown.
+    size_t WriteBackCopies(const std::vector<frame_id_t>& candidates, size_t* position,
+                           std::vector<Page>* copies, std::unique_lock<std::mutex>& lock);
+    // First step of a checkpoint: write back the frames dirty right now
+    size_t CheckpointWriteBack();
+    // Append the frames that may differ from disk to dirty_pages and return
+    // the oldest recovery LSN among them, or the end of the log if none
+    lsn_t SnapshotDirtyPages(std::vector<std::pair<page_id_t, lsn_t>>* dirty_pages) const;
+    // Write-ahead rule, call before writing a page with this LSN to disk
+    void FlushLogUntil(lsn_t lsn);
+    // End of the log, the recovery LSN of a frame that matches disk now
+    lsn_t CurrentLSN() const {
+        return log_manager_ == nullptr ? INVALID_LSN : log_manager_->GetNextLSN();
+    }
 
-    size_t pool_size_;
+    // Frames [0, pool_size_) are in use; the rest of the arena is spare
+    // capacity for Resize. Written under latch_, read anywhere.
+    std::atomic<size_t> pool_size_;
+    size_t max_pool_size_;
+    std::mutex resize_mutex_;  // One Resize at a time
+    std::mutex checkpoint_mutex_;  // One Checkpoint at a time
+    FrameArena arena_;
     Page* pages_;
     DiskManager* disk_manager_;
-    LRUReplacer* replacer_;
+    LogManager* log_manager_;
+    Replacer* replacer_;
     
-    std::unordered_map<page_id_t, frame_id_t> page_table_;
-    std::unordered_map<frame_id_t, page_id_t> frame_table_;
-    std::unordered_map<frame_id_t, int> pin_count_;
-    std::unordered_map<frame_id_t, bool> dirty_;
+    std::vector<FrameDescriptor> frames_;
+    PageTable page_table_;
     
     std::vector<frame_id_t> free_list_;
     
     mutable std::mutex latch_;
+    // Signalled whenever a frame finishes I/O
+    std::condition_variable io_cv_;
+
+    // Sequential scan detection, guarded by latch_
+    size_t read_ahead_limit_;  // From the options, before the pool-size cap
+    size_t read_ahead_pages_;
+    page_id_t last_fetch_page_id_;
+    size_t sequential_run_;
+    page_id_t read_ahead_end_;  // Read-ahead has been issued up to here
+    size_t prefetch_in_flight_;
+
+    // Page cleaner state, guarded by latch_
+    size_t cleaner_lru_depth_;
+    double cleaner_dirty_ratio_high_;
+    double cleaner_dirty_ratio_low_;
+    bool cleaner_flushing_;  // Went over the high ratio, not yet under the low one
+    bool cleaner_stop_;
+    size_t frames_cleaning_;
+    std::condition_variable cleaner_cv_;
+    std::thread cleaner_;
     
-    size_t hit_count_;
-    size_t miss_count_;
+    std::atomic<size_t> hit_count_;
+    std::atomic<size_t> miss_count_;
+    std::atomic<size_t> prefetch_count_;
+    std::string warm_up_file_;
+    std::atomic<size_t> foreground_write_count_;
+    std::atomic<size_t> background_write_count_;
 };
 
 }  // namespace logicmaze
@@ -0,0 +1,41 @@
+#ifndef CLOCK_REPLACER_H
+#define CLOCK_REPLACER_H
+
+#include "config.h"
+#include "replacer.h"
+#include <atomic>
+#include <vector>
+
+namespace logicmaze {
+
+// CLOCK (second chance) replacement over a fixed frame array.
+// Pin/Unpin only flip per-frame atomic bits; Victim sweeps the clock hand,
+// clearing reference bits until it finds an unreferenced evictable frame.
+class ClockReplacer : public Replacer {
+public:
+    explicit ClockReplacer(size_t num_frames);
+    ~ClockReplacer() override = default;
+
+    ClockReplacer(const ClockReplacer&) = delete;
+    ClockReplacer& operator=(const ClockReplacer&) = delete;
+
+    bool Victim(frame_id_t* frame_id) override;
+    void Pin(frame_id_t frame_id) override;
+    void Unpin(frame_id_t frame_id) override;
+    void Remove(frame_id_t frame_id) override { Pin(frame_id); }
+    size_t Size() const override;
+    void ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const override;
+
+private:
+    static constexpr uint8_t EVICTABLE = 0x1;
+    static constexpr uint8_t REFERENCED = 0x2;
+
+    size_t num_frames_;
+    std::vector<std::atomic<uint8_t>> state_;
+    std::atomic<size_t> hand_;
+    std::atomic<size_t> size_;
+};
+
+}  // namespace logicmaze
+
+#endif  // CLOCK_REPLACER_H
@@ -10,17 +10,55 @@ namespace logicmaze {
 constexpr size_t PAGE_SIZE = 8192;  // 8KB pages
 constexpr size_t PAGE_HEADER_SIZE = 128;  // 128 bytes for page header
 constexpr size_t PAGE_DATA_SIZE = PAGE_SIZE - PAGE_HEADER_SIZE;  // 8064 bytes
+constexpr size_t PAGE_ALIGNMENT = 4096;  // Page buffers are usable for O_DIRECT I/O
 
 // Buffer pool configuration
 constexpr size_t BUFFER_POOL_SIZE = 100;  // 100 pages = 800KB
 
+// How the buffer pool's frame arena is backed
+enum class HugePageMode : uint8_t {
+    NONE = 0,         // Regular 4KB pages
+    TRANSPARENT = 1,  // madvise(MADV_HUGEPAGE), kernel promotes when it can
+    EXPLICIT = 2      // MAP_HUGETLB from the reserved pool, else TRANSPARENT
+};
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Maximum number of asynchronous disk requests in flight per DiskManager
+constexpr size_t ASYNC_IO_QUEUE_DEPTH = 64;
+// Worker threads doing blocking I/O when io_uring is not available
+constexpr size_t ASYNC_IO_THREADS = 4;
+
+// Sequential read-ahead: after this many fetches of consecutive page ids,
+// the buffer pool keeps up to READ_AHEAD_PAGES pages ahead of the scan
+constexpr size_t READ_AHEAD_TRIGGER = 4;
+constexpr size_t READ_AHEAD_PAGES = 32;
+
+// Background page cleaner: wake-up interval, pages per write batch, and how
+// many frames at the cold end of the replacer it keeps clean by default
+constexpr size_t CLEANER_INTERVAL_MS = 10;
+constexpr size_t CLEANER_BATCH_PAGES = 32;
+constexpr size_t CLEANER_LRU_DEPTH = 64;
+
+// Page replacement policies for the buffer pool
+enum class ReplacerType : uint8_t {
+    LRU = 0,
+    CLOCK = 1,
+    LRU_K = 2
+};
+
+// LRU-K defaults: K, and the correlated reference period in page accesses
+// (re-references of a frame within this window count as one reference)
+constexpr size_t LRUK_K = 2;
+constexpr uint64_t LRUK_CORRELATED_PERIOD = 4;
+
 // Page types
 enum class PageType : uint8_t {
     INVALID = 0,
     HEADER = 1,
     DATA = 2,
     INDEX = 3,
-    FREE_LIST = 4
+    FREE_LIST = 4,        // Version 1 free page list, migrated on open
+    FREE_SPACE_MAP = 5
 };
 
 // Page ID type
@@ -28,6 +66,45 @@ using page_id_t = uint32_t;
 constexpr page_id_t INVALID_PAGE_ID = 0xFFFFFFFF;
 constexpr page_id_t HEADER_PAGE_ID = 0;
 
+// Header page (page 0) layout, as offsets into its data area. Version 1
+// kept the free page ids as a list on page 1 and had no allocated count.
+constexpr uint32_t DB_VERSION = 2;
+constexpr size_t HEADER_VERSION_OFFSET = 0;
+constexpr size_t HEADER_PAGE_SIZE_OFFSET = 4;
+constexpr size_t HEADER_NUM_PAGES_OFFSET = 8;         // Pages in use
+constexpr size_t HEADER_ALLOCATED_PAGES_OFFSET = 12;  // Pages the file has room for
+constexpr size_t HEADER_CHECKPOINT_LSN_OFFSET = 16;   // Start of the last checkpoint record
+constexpr size_t HEADER_REDO_LSN_OFFSET = 24;         // Where recovery starts redo
+
+// The database file grows in extents of this many pages (8MB)
+constexpr size_t FILE_EXTENT_PAGES = 1024;
+
+// B+ tree bulk loading takes leaf pages from the disk manager in runs of
+// this many consecutive pages (2MB), so leaves are laid out in key order
+constexpr size_t BPLUS_TREE_BULK_LOAD_RUN_PAGES = 256;
+
+// A table heap inserts into a page before its last one again once deletes
+// have freed this many bytes there, so records are not scattered over
+// pages with small gaps
+constexpr size_t TABLE_PAGE_REUSE_SPACE = PAGE_DATA_SIZE / 4;
+
+// Free space map: page 1 and every FSM_PAGE_BITS pages after it hold a
+// bitmap of the free pages in the run of FSM_PAGE_BITS pages they start
+constexpr size_t FSM_PAGE_BITS = PAGE_DATA_SIZE * 8;  // 64512 pages
+constexpr page_id_t FIRST_FSM_PAGE_ID = 1;
+
+// Log sequence number: offset in the log just past a record, so the log
+// is durable for a record once it is flushed up to the record's LSN
+using lsn_t = uint64_t;
+constexpr lsn_t INVALID_LSN = 0;
+
+using txn_id_t = uint64_t;
+constexpr txn_id_t INVALID_TXN_ID = 0;  // Log records that belong to no transaction
+
+// Write-ahead log: appends go to one in-memory buffer while the other is
+// being written out, each this many bytes
+constexpr size_t LOG_BUFFER_SIZE = 1024 * 1024;
+
 // Frame ID type (buffer pool frame)
 using frame_id_t = int32_t;
 constexpr frame_id_t INVALID_FRAME_ID = -1;
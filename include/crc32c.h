@@ -0,0 +1,23 @@
+#ifndef CRC32C_H
+#define CRC32C_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace logicmaze {
+
+// CRC32C (Castagnoli polynomial). Passing a previous result as crc
+// continues it, so Crc32c(b, Crc32c(a)) is the CRC of a followed by b.
+// Uses the SSE4.2 crc32 instruction when the CPU has it (checked once at
+// startup), otherwise the portable table-driven version.
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc = 0);
+
+// Slicing-by-8 table implementation, available on every CPU
+uint32_t Crc32cPortable(const void* data, size_t size, uint32_t crc = 0);
+
+// "sse4.2" or "table", whichever Crc32c uses
+const char* Crc32cImplementation();
+
+}  // namespace logicmaze
+
+#endif  // CRC32C_H
@@ -3,38 +3,123 @@
 
 #include "config.h"
 #include "page.h"
+#include "async_io.h"
 #include <string>
-#include <fstream>
+#include <atomic>
+#include <future>
+#include <memory>
 #include <mutex>
+#include <utility>
 #include <vector>
 
 namespace logicmaze {
 
+// Page-granular access to the database file through positional
+// pread/pwrite, so reads and writes of different pages run concurrently.
+// mutex_ only guards allocation state (the free space map).
+//
+// Free pages are tracked by a bitmap spread over free space map (FSM) pages
+// at fixed positions, so it scales to any file size. Changes are kept in
+// memory and only the FSM pages that changed are written back, together
+// with the page count in the header, on Flush() and on close.
+//
+// The file is grown ahead of allocation in extents of preallocated pages;
+// the header records both the pages in use and the pages allocated.
+//
+// Writes only reach the OS; nothing is durable until Flush().
 class DiskManager {
 public:
-    explicit DiskManager(const std::string& db_filename);
-    ~DiskManager();
+    // direct_io opens the file with O_DIRECT to bypass the OS page cache;
+    // falls back to buffered I/O if the filesystem does not support it
+    // allow_io_uring = false forces the thread-pool async backend
+    // extent_pages is the file growth step (fallocate); 0 grows page by page
+    explicit DiskManager(const std::string& db_filename, bool direct_io = false,
+                         bool allow_io_uring = true,
+                         size_t extent_pages = FILE_EXTENT_PAGES);
+    virtual ~DiskManager();
 
     DiskManager(const DiskManager&) = delete;
     DiskManager& operator=(const DiskManager&) = delete;
 
-    void ReadPage(page_id_t page_id, Page* page);
-    void WritePage(page_id_t page_id, const Page* page);
+    virtual void ReadPage(page_id_t page_id, Page* page);
+    virtual void WritePage(page_id_t page_id, const Page* page);
+    // Write a batch of pages: sorted by page id, runs of consecutive ids
+    // go out as a single vectored write
+    virtual void WritePages(std::vector<std::pair<page_id_t, const Page*>> pages);
+
+    // Asynchronous page I/O with many requests in flight at once. The page
+    // buffer must stay valid (and, for reads, untouched) until completion.
+    // Callbacks run on an I/O thread; futures rethrow failures from get().
+    void ReadPageAsync(page_id_t page_id, Page* page, IOCallback callback);
+    void WritePageAsync(page_id_t page_id, const Page* page, IOCallback callback);
+    std::future<void> ReadPageAsync(page_id_t page_id, Page* page);
+    std::future<void> WritePageAsync(page_id_t page_id, const Page* page);
+    // "io_uring" or "thread-pool"; starts the async engine if needed
+    const char* GetAsyncBackendName();
+
     page_id_t AllocatePage();
+    // Allocate count consecutive pages and return the first id; reuses a
+    // free run if there is one, else extends the file
+    page_id_t AllocatePages(size_t count);
     void DeallocatePage(page_id_t page_id);
-    page_id_t GetNumPages() const { return num_pages_; }
+    // Record a page as in use if it is free. Allocations are not logged,
+    // so recovery claims every page the log changed this way
+    void MarkAllocated(page_id_t page_id);
+    page_id_t GetNumPages() const { return num_pages_.load(); }
+    // Pages the file has room for, at least GetNumPages()
+    page_id_t GetAllocatedPages() const;
+    size_t GetFreePageCount() const;
+
+    // Last completed checkpoint, kept in the header page: where its log
+    // record starts and where recovery starts redo. Persisted by Flush().
+    void SetCheckpoint(lsn_t checkpoint_lsn, lsn_t redo_lsn);
+    lsn_t GetCheckpointLSN() const;
+    lsn_t GetRedoLSN() const;
+    bool IsDirectIO() const { return direct_io_; }
+    // Durability point: fdatasync everything written so far
     void Flush();
 
 private:
     void InitializeDatabase();
-    void LoadFreePageList();
-    void SaveFreePageList();
+    void LoadFreeSpaceMap();
+    void MigrateFreePageList();
+    void WriteFreeSpaceMap();
+    void WriteHeaderPage();
+    void EnsureFsmGroups(size_t num_groups);
+    void MarkFree(page_id_t page_id);
+    void MarkUsed(page_id_t page_id);
+    page_id_t FindFreeRun(size_t count);
+    page_id_t ExtendFile(size_t count);
+    void ReserveExtent(page_id_t num_pages);
+    void ExtendNumPages(page_id_t num_pages);
+    void VerifyPage(page_id_t page_id, const Page* page) const;
+    AsyncIOEngine* GetAsyncEngine();
 
     std::string db_filename_;
-    std::fstream db_file_;
-    page_id_t num_pages_;
-    std::vector<page_id_t> free_pages_;
+    int fd_;
+    bool direct_io_;
+    std::atomic<page_id_t> num_pages_;
     mutable std::mutex mutex_;
+    page_id_t allocated_pages_;       // File size in pages after preallocation
+    size_t extent_pages_;
+
+    // Free space map, one group of FSM_PAGE_BITS pages per FSM page.
+    // Bit (page_id - 1) is set while the page is free.
+    std::vector<uint64_t> fsm_bits_;
+    std::vector<uint32_t> fsm_free_count_;
+    std::vector<uint32_t> fsm_hint_;  // No free page below this word
+    std::vector<bool> fsm_dirty_;
+    size_t free_count_;
+    size_t first_free_group_;         // No free page in earlier groups
+    page_id_t persisted_num_pages_;
+    lsn_t checkpoint_lsn_;
+    lsn_t redo_lsn_;
+    bool header_dirty_;
+
+    // Created on first async request
+    bool allow_io_uring_;
+    std::once_flag async_init_;
+    std::unique_ptr<AsyncIOEngine> async_engine_;
 };
 
 }  // namespace logicmaze
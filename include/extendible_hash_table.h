@@ -0,0 +1,70 @@
+#ifndef EXTENDIBLE_HASH_TABLE_H
+#define EXTENDIBLE_HASH_TABLE_H
+
+#include "config.h"
+#include "buffer_pool_manager.h"
+#include "page_guard.h"
+#include "extendible_hash_table_page.h"
+#include <atomic>
+#include <memory>
+#include <string>
+
+namespace logicmaze {
+
+// Key of the (session_id, row_index, col_index) position index: the three
+// fields packed side by side, so no two positions share a key
+std::string HashTablePositionKey(int32_t session_id, int32_t row_index, int32_t col_index);
+
+// Extendible hash index from byte-string keys of up to
+// HASH_TABLE_MAX_KEY_SIZE bytes (positions, player names) to RIDs, on
+// INDEX pages of the buffer pool. The header page picks a directory by the
+// top bits of a key's hash and the directory picks a bucket by the low
+// bits. A full bucket splits in two by one more bit, doubling its
+// directory only when the bucket already used all of the directory's
+// bits; no other bucket moves, so the table is never rehashed as a
+// whole. Buckets are not merged when they empty.
+//
+// Directory page ids never change once set, so they are also kept in
+// memory and a lookup latches just the directory and then the bucket.
+// Inserts write-latch only the bucket unless it is full; then they retry
+// with the directory write-latched to split it.
+class ExtendibleHashTable {
+public:
+    // Create an empty table
+    explicit ExtendibleHashTable(BufferPoolManager* bpm);
+    // Open a table created earlier
+    ExtendibleHashTable(BufferPoolManager* bpm, page_id_t header_page_id);
+
+    ExtendibleHashTable(const ExtendibleHashTable&) = delete;
+    ExtendibleHashTable& operator=(const ExtendibleHashTable&) = delete;
+
+    bool GetValue(const std::string& key, RID* rid);
+    // False if the key is already in the table. Throws
+    // std::invalid_argument for a key that is too long, and
+    // std::runtime_error if a directory is full (too many keys share
+    // HASH_TABLE_DIRECTORY_MAX_DEPTH + 1 low hash bits for one bucket).
+    bool Insert(const std::string& key, const RID& rid);
+    // False if the key is not in the table
+    bool Remove(const std::string& key);
+
+    page_id_t GetHeaderPageId() const { return header_page_id_; }
+    size_t GetBucketCount();
+
+private:
+    ReadPageGuard FetchRead(page_id_t page_id);
+    WritePageGuard FetchWrite(page_id_t page_id);
+    Page* NewIndexPage(page_id_t* page_id);
+
+    // Directory for a hash; with create, one is made if there is none yet,
+    // else INVALID_PAGE_ID is returned
+    page_id_t GetDirectoryPageId(uint64_t hash, bool create);
+
+    BufferPoolManager* bpm_;
+    page_id_t header_page_id_;
+    uint32_t header_depth_;
+    std::unique_ptr<std::atomic<page_id_t>[]> directory_page_ids_;
+};
+
+}  // namespace logicmaze
+
+#endif  // EXTENDIBLE_HASH_TABLE_H
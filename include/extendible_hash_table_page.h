@@ -0,0 +1,151 @@
+#ifndef EXTENDIBLE_HASH_TABLE_PAGE_H
+#define EXTENDIBLE_HASH_TABLE_PAGE_H
+
+#include "config.h"
+#include "page.h"
+#include "table_page.h"
+
+namespace logicmaze {
+
+// Longest key a hash index can hold
+constexpr size_t HASH_TABLE_MAX_KEY_SIZE = 30;
+
+// Top bits of a key's hash pick a directory from the header page, low bits
+// pick a bucket within the directory, and the byte at
+// HASH_TABLE_FINGERPRINT_SHIFT is the fingerprint kept in the bucket
+constexpr uint32_t HASH_TABLE_HEADER_MAX_DEPTH = 8;      // Up to 256 directories
+constexpr uint32_t HASH_TABLE_DIRECTORY_MAX_DEPTH = 10;  // Up to 1024 buckets each
+constexpr uint32_t HASH_TABLE_FINGERPRINT_SHIFT = 32;
+
+// 64-bit hash of a key (multiply-rotate over 8-byte words, then the
+// MurmurHash3 finalizer), so every bit depends on every key byte
+uint64_t HashTableHash(const char* key, size_t size);
+
+// Data area of the header page: a directory per value of the top depth
+// bits of the hash, INVALID_PAGE_ID until its first key arrives
+class HashTableHeaderPage {
+public:
+    explicit HashTableHeaderPage(Page* page) : page_(page) {}
+    static const HashTableHeaderPage View(const Page* page) {
+        return HashTableHeaderPage(const_cast<Page*>(page));
+    }
+
+    void Init(page_id_t page_id, uint32_t depth);
+
+    uint32_t GetDepth() const { return GetHeader()->depth; }
+    uint32_t GetSize() const { return 1u << GetDepth(); }
+    page_id_t GetDirectoryPageId(uint32_t index) const { return GetHeader()->directory_page_ids[index]; }
+    void SetDirectoryPageId(uint32_t index, page_id_t page_id) {
+        GetHeader()->directory_page_ids[index] = page_id;
+    }
+
+private:
+    struct Header {
+        uint32_t depth;
+        page_id_t directory_page_ids[1u << HASH_TABLE_HEADER_MAX_DEPTH];
+    };
+    Header* GetHeader() { return reinterpret_cast<Header*>(page_->GetData()); }
+    const Header* GetHeader() const { return reinterpret_cast<const Header*>(page_->GetData()); }
+
+    Page* page_;
+};
+
+// Data area of a directory page: 2^global depth slots, each a bucket page
+// and that bucket's local depth. A bucket of local depth d is in every
+// slot whose low d bits match.
+class HashTableDirectoryPage {
+public:
+    explicit HashTableDirectoryPage(Page* page) : page_(page) {}
+    static const HashTableDirectoryPage View(const Page* page) {
+        return HashTableDirectoryPage(const_cast<Page*>(page));
+    }
+
+    // Starts with global depth 0 and the one bucket
+    void Init(page_id_t page_id, page_id_t bucket_page_id);
+
+    uint32_t GetGlobalDepth() const { return GetHeader()->global_depth; }
+    uint32_t GetSize() const { return 1u << GetGlobalDepth(); }
+    uint32_t BucketIndex(uint64_t hash) const {
+        return static_cast<uint32_t>(hash & (GetSize() - 1));
+    }
+    page_id_t GetBucketPageId(uint32_t index) const { return GetHeader()->bucket_page_ids[index]; }
+    uint32_t GetLocalDepth(uint32_t index) const { return GetHeader()->local_depths[index]; }
+
+    // Double the directory, the upper half mirroring the lower one
+    void Grow();
+    // Split the bucket at index into it and new_bucket_page_id: slots of
+    // the old bucket whose next bit is set move to the new one, and all of
+    // them get one more bit of local depth
+    void SplitBucket(uint32_t index, page_id_t new_bucket_page_id);
+
+private:
+    struct Header {
+        uint32_t global_depth;
+        page_id_t bucket_page_ids[1u << HASH_TABLE_DIRECTORY_MAX_DEPTH];
+        uint8_t local_depths[1u << HASH_TABLE_DIRECTORY_MAX_DEPTH];
+    };
+    Header* GetHeader() { return reinterpret_cast<Header*>(page_->GetData()); }
+    const Header* GetHeader() const { return reinterpret_cast<const Header*>(page_->GetData()); }
+
+    Page* page_;
+};
+
+// Bucket entry; key bytes past key_size are zero
+struct HashTableEntry {
+    RID rid;
+    uint16_t key_size;
+    char key[HASH_TABLE_MAX_KEY_SIZE];
+};
+
+static_assert(sizeof(HashTableEntry) == 40, "Hash table entries must be 40 bytes");
+
+// Data area of a bucket page: the entries in no particular order, with a
+// separate array of one-byte hash fingerprints in front of them. A lookup
+// compares its fingerprint against 16 of them at a time (SSE2 where
+// available) and only reads the entries that match, so a miss rarely
+// touches an entry at all.
+class HashTableBucketPage {
+public:
+    // A multiple of 16, so the fingerprint scan needs no tail loop
+    static constexpr uint32_t CAPACITY = 192;
+
+    explicit HashTableBucketPage(Page* page) : page_(page) {}
+    static const HashTableBucketPage View(const Page* page) {
+        return HashTableBucketPage(const_cast<Page*>(page));
+    }
+
+    void Init(page_id_t page_id);
+
+    uint32_t GetSize() const { return GetHeader()->size; }
+    bool IsFull() const { return GetSize() == CAPACITY; }
+    const HashTableEntry& EntryAt(uint32_t index) const { return GetHeader()->entries[index]; }
+
+    bool Lookup(const char* key, uint16_t key_size, uint8_t fingerprint, RID* rid) const;
+    // False if the key is already there; the bucket must not be full
+    bool Insert(const char* key, uint16_t key_size, uint8_t fingerprint, const RID& rid);
+    // False if the key is not there
+    bool Remove(const char* key, uint16_t key_size, uint8_t fingerprint);
+    // Split: move the entries whose hash has bit set to an empty bucket
+    void MoveSplitTo(HashTableBucketPage* recipient, uint32_t bit);
+
+private:
+    struct Header {
+        uint32_t size;
+        uint32_t padding;
+        uint8_t fingerprints[CAPACITY];
+        HashTableEntry entries[CAPACITY];
+    };
+    Header* GetHeader() { return reinterpret_cast<Header*>(page_->GetData()); }
+    const Header* GetHeader() const { return reinterpret_cast<const Header*>(page_->GetData()); }
+
+    // Index of the entry holding key, GetSize() if none
+    uint32_t Find(const char* key, uint16_t key_size, uint8_t fingerprint) const;
+    void Append(const HashTableEntry& entry, uint8_t fingerprint);
+    void RemoveAt(uint32_t index);
+
+    Page* page_;
+};
+
+}  // namespace logicmaze
+
+#endif  // EXTENDIBLE_HASH_TABLE_PAGE_H
@@ -0,0 +1,48 @@
+#ifndef FILE_IO_H
+#define FILE_IO_H
+
+#include <cerrno>
+#include <cstddef>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace logicmaze {
+
+// pread until size bytes are read, EOF, or an error; returns bytes read or -1
+inline ssize_t PreadFull(int fd, char* buffer, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pread(fd, buffer + done, size - done, offset + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        if (n == 0) {
+            break;  // End of file
+        }
+        done += n;
+    }
+    return done;
+}
+
+// pwrite until size bytes are written or an error; returns bytes written or -1
+inline ssize_t PwriteFull(int fd, const char* buffer, size_t size, off_t offset) {
+    size_t done = 0;
+    while (done < size) {
+        ssize_t n = pwrite(fd, buffer + done, size - done, offset + done);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n < 0) {
+            return -1;
+        }
+        done += n;
+    }
+    return done;
+}
+
+}  // namespace logicmaze
+
+#endif  // FILE_IO_H
@@ -0,0 +1,43 @@
+#ifndef FRAME_ARENA_H
+#define FRAME_ARENA_H
+
+#include "config.h"
+#include "page.h"
+
+namespace logicmaze {
+
+// Memory for the buffer pool's frames: one anonymous mmap region. The
+// kernel hands out zeroed memory on first touch, so no frame is written
+// at startup and creating a large pool costs only the mapping. Frames are
+// OS-page aligned and therefore usable for O_DIRECT.
+//
+// Untouched frames read as all zeroes, which is exactly what a freshly
+// constructed Page holds.
+class FrameArena {
+public:
+    FrameArena(size_t num_frames, HugePageMode mode = HugePageMode::NONE);
+    ~FrameArena();
+
+    FrameArena(const FrameArena&) = delete;
+    FrameArena& operator=(const FrameArena&) = delete;
+
+    Page* GetFrames() const { return frames_; }
+    size_t GetNumFrames() const { return num_frames_; }
+    // What the arena actually got, EXPLICIT falls back to TRANSPARENT when
+    // no huge pages are reserved
+    HugePageMode GetHugePageMode() const { return mode_; }
+
+    // Give the memory of unused frames back to the OS; they read as empty
+    // pages again when next touched
+    void Release(size_t first, size_t count);
+
+private:
+    Page* frames_;
+    size_t num_frames_;
+    size_t mapped_size_;
+    HugePageMode mode_;
+};
+
+}  // namespace logicmaze
+
+#endif  // FRAME_ARENA_H
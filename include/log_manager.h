@@ -0,0 +1,170 @@
+#ifndef LOG_MANAGER_H
+#define LOG_MANAGER_H
+
+#include "config.h"
+#include "page.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace logicmaze {
+
+enum class LogRecordType : uint8_t {
+    INVALID = 0,
+    UPDATE = 1,      // Bytes of a page after a change (redo image)
+    PAGE_IMAGE = 2,  // The whole page, repairs a torn write
+    COMMIT = 3,
+    ABORT = 4,
+    CHECKPOINT = 5   // Payload laid out as below
+};
+
+// On-disk log record header (32 bytes), followed by the payload
+struct LogRecordHeader {
+    uint32_t size;        // Header plus payload
+    uint32_t checksum;    // CRC32C of the record, with this field taken as zero
+    lsn_t lsn;            // End of this record in the log
+    txn_id_t txn_id;
+    page_id_t page_id;    // INVALID_PAGE_ID if the record is not about a page
+    uint16_t offset;      // UPDATE: where the payload goes in the page
+    LogRecordType type;
+    uint8_t padding;
+};
+
+static_assert(sizeof(LogRecordHeader) == 32, "LogRecordHeader size must be exactly 32 bytes");
+
+// CHECKPOINT payload: a CheckpointHeader, num_dirty_pages DirtyPageEntry
+// and num_active_txns ActiveTxnEntry
+struct CheckpointHeader {
+    lsn_t redo_lsn;       // Oldest recovery LSN in the dirty page table
+    uint32_t num_dirty_pages;
+    uint32_t num_active_txns;
+};
+
+struct DirtyPageEntry {
+    page_id_t page_id;
+    uint32_t padding;
+    lsn_t rec_lsn;        // Redo of the page starts here
+};
+
+struct ActiveTxnEntry {
+    txn_id_t txn_id;
+    lsn_t first_lsn;      // Start of the transaction's first record
+};
+
+struct LogRecord {
+    LogRecordHeader header;
+    std::vector<char> payload;
+};
+
+// Write-ahead log. Records are appended to an in-memory buffer and reach
+// the log file when someone waits for them (FlushUntil, Commit) or the
+// buffer fills up.
+//
+// Group commit: one waiter at a time becomes the leader and writes and
+// syncs everything appended so far, while the others keep appending to
+// the second buffer. When the leader is done, every waiter whose record
+// it covered returns, and the next one still waiting leads the next
+// batch, so concurrent commits share one fdatasync.
+//
+// Torn page protection: the first change to a page after the full page
+// image LSN (moved forward by each checkpoint) logs the whole page, so
+// recovery can rebuild a page whose last write was torn.
+class LogManager {
+public:
+    // Opens or creates the log; a torn tail left by a crash is cut off
+    explicit LogManager(const std::string& log_filename);
+    // Flushes whatever is still buffered
+    ~LogManager();
+
+    LogManager(const LogManager&) = delete;
+    LogManager& operator=(const LogManager&) = delete;
+
+    // Append a record and return its LSN. Only blocks if the buffer is full.
+    lsn_t AppendRecord(LogRecordType type, txn_id_t txn_id, page_id_t page_id,
+                       uint16_t offset, const char* data, size_t length);
+    // Log bytes [offset, offset + length) of a page the caller just changed
+    // and stamp the page with the record's LSN; the caller holds the page's
+    // write latch. Logs a full page image instead if the page has not been
+    // logged since the full page image LSN.
+    lsn_t LogUpdate(txn_id_t txn_id, page_id_t page_id, Page* page, size_t offset, size_t length);
+    // Log a full image of the page and stamp its LSN
+    lsn_t LogPageImage(txn_id_t txn_id, page_id_t page_id, Page* page);
+    // Append a commit record and wait until it is durable
+    lsn_t Commit(txn_id_t txn_id);
+    // Append a checkpoint record with the dirty page table and the active
+    // transactions and wait until it is durable; returns where it starts
+    lsn_t LogCheckpoint(lsn_t redo_lsn, const std::vector<std::pair<page_id_t, lsn_t>>& dirty_pages);
+
+    // Pages whose LSN is at or below this get a full image on their next
+    // LogUpdate; starts at the end of the log when it is opened
+    void SetFullPageImageLSN(lsn_t lsn) { full_page_image_lsn_ = lsn; }
+    // Transactions with records but no commit or abort yet, with the start
+    // of their first record
+    std::vector<std::pair<txn_id_t, lsn_t>> GetActiveTransactions() const;
+
+    // Block until the log is durable up to lsn, or to its end if lsn is
+    // past it
+    void FlushUntil(lsn_t lsn);
+    void FlushAll() { FlushUntil(GetNextLSN()); }
+
+    // End of the last appended record, and of the durable part of the log
+    lsn_t GetNextLSN() const;
+    lsn_t GetFlushedLSN() const { return flushed_lsn_.load(); }
+    // Number of log syncs so far; commits per sync shows group commit at work
+    size_t GetSyncCount() const { return sync_count_.load(); }
+
+private:
+    void FlushLocked(lsn_t lsn, std::unique_lock<std::mutex>& lock);
+
+    std::string log_filename_;
+    int fd_;
+
+    mutable std::mutex latch_;
+    std::condition_variable flush_cv_;  // A flush finished
+    std::vector<char> buffer_;          // Appends go here, guarded by latch_
+    std::vector<char> flush_buffer_;    // Owned by the leader while flushing_
+    size_t buffer_used_;
+    lsn_t next_lsn_;
+    bool flushing_;
+    bool failed_;                       // A flush failed, the log has a hole
+    std::unordered_map<txn_id_t, lsn_t> active_txns_;
+    std::atomic<lsn_t> full_page_image_lsn_;
+    std::atomic<lsn_t> flushed_lsn_;
+    std::atomic<size_t> sync_count_;
+};
+
+// Reads a log file back in order. Stops at the end of the file or at the
+// first record that is torn or fails its checksum.
+class LogReader {
+public:
+    explicit LogReader(const std::string& log_filename);
+    ~LogReader();
+
+    LogReader(const LogReader&) = delete;
+    LogReader& operator=(const LogReader&) = delete;
+
+    // Read the record at lsn (the end of the previous one) onwards
+    void Seek(lsn_t lsn);
+    // False once there is no further valid record
+    bool Next(LogRecord* record);
+    // End of the last valid record read
+    lsn_t GetLSN() const { return lsn_; }
+
+private:
+    // Make [offset, offset + size) available in window_, false past the end
+    bool Load(lsn_t offset, size_t size);
+
+    int fd_;
+    lsn_t lsn_;
+    std::vector<char> window_;
+    lsn_t window_start_;
+    size_t window_size_;
+};
+
+}  // namespace logicmaze
+
+#endif  // LOG_MANAGER_H
@@ -0,0 +1,77 @@
+#ifndef LRU_K_REPLACER_H
+#define LRU_K_REPLACER_H
+
+#include "config.h"
+#include "replacer.h"
+#include <vector>
+#include <mutex>
+#include <set>
+#include <utility>
+
+namespace logicmaze {
+
+// LRU-K replacement (O'Neil et al.): evicts the frame whose K-th most recent
+// reference is oldest. Frames with fewer than K references have infinite
+// backward K-distance and go first (LRU among them), so pages touched once
+// by a sequential scan cannot push out pages with a history of reuse.
+//
+// Every Pin counts as a reference. References to a frame that arrive within
+// the correlated reference period of its previous one are folded into that
+// reference, and frames referenced within that period are not chosen as
+// victims unless nothing else is evictable.
+//
+// Evictable frames are kept ordered by the reference Victim compares, so
+// picking one only skips the few frames in an open burst.
+class LRUKReplacer : public Replacer {
+public:
+    LRUKReplacer(size_t num_frames, size_t k = LRUK_K,
+                 uint64_t correlated_period = LRUK_CORRELATED_PERIOD);
+    ~LRUKReplacer() override = default;
+
+    LRUKReplacer(const LRUKReplacer&) = delete;
+    LRUKReplacer& operator=(const LRUKReplacer&) = delete;
+
+    bool Victim(frame_id_t* frame_id) override;
+    void Pin(frame_id_t frame_id) override;
+    void Unpin(frame_id_t frame_id) override;
+    void Remove(frame_id_t frame_id) override;
+    size_t Size() const override;
+    void ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const override;
+
+private:
+    struct FrameHistory {
+        uint64_t last_access;  // Latest reference, correlated or not
+        size_t num_refs;       // Uncorrelated references recorded, at most K
+        bool evictable;
+    };
+
+    // Evictable frames by the time Victim compares, then frame id
+    using EvictionSet = std::set<std::pair<uint64_t, frame_id_t>>;
+
+    void RecordAccess(frame_id_t frame_id);
+    void ResetFrame(frame_id_t frame_id);
+    // Add an evictable frame to, or take it out of, its eviction set
+    void AddEvictable(frame_id_t frame_id);
+    void RemoveEvictable(frame_id_t frame_id);
+    // First frame of the set whose burst is closed, INVALID_FRAME_ID if none
+    frame_id_t FirstClosed(const EvictionSet& frames) const;
+
+    // K reference times per frame, most recent first
+    uint64_t* History(frame_id_t frame_id) { return &history_[frame_id * k_]; }
+    const uint64_t* History(frame_id_t frame_id) const { return &history_[frame_id * k_]; }
+
+    size_t k_;
+    uint64_t correlated_period_;
+    uint64_t current_timestamp_;
+    std::vector<FrameHistory> frames_;
+    std::vector<uint64_t> history_;
+    // Infinite backward K-distance, by latest reference; and the others,
+    // by K-th most recent reference
+    EvictionSet infinite_;
+    EvictionSet finite_;
+    mutable std::mutex mutex_;
+};
+
+}  // namespace logicmaze
+
+#endif  // LRU_K_REPLACER_H
@@ -2,40 +2,43 @@
 #define LRU_REPLACER_H
 
 #include "config.h"
-#include <unordered_map>
+#include "replacer.h"
+#include <vector>
 #include <mutex>
 
 namespace logicmaze {
 
-class LRUReplacer {
+class LRUReplacer : public Replacer {
 private:
+    // Intrusive list links, one per frame. Links are frame ids and the
+    // sentinel lives at index num_frames, so the list never allocates.
     struct Node {
-        frame_id_t frame_id;
-        Node* prev;
-        Node* next;
-        
-        Node(frame_id_t id) : frame_id(id), prev(nullptr), next(nullptr) {}
+        frame_id_t prev;
+        frame_id_t next;
+        bool in_list;
     };
 
 public:
     explicit LRUReplacer(size_t num_frames);
-    ~LRUReplacer();
+    ~LRUReplacer() override;
 
     LRUReplacer(const LRUReplacer&) = delete;
     LRUReplacer& operator=(const LRUReplacer&) = delete;
 
-    bool Victim(frame_id_t* frame_id);
-    void Pin(frame_id_t frame_id);
-    void Unpin(frame_id_t frame_id);
-    size_t Size() const;
+    bool Victim(frame_id_t* frame_id) override;
+    void Pin(frame_id_t frame_id) override;
+    void Unpin(frame_id_t frame_id) override;
+    void Remove(frame_id_t frame_id) override { Pin(frame_id); }
+    size_t Size() const override;
+    void ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const override;
 
 private:
-    void RemoveNode(Node* node);
-    void AddToFront(Node* node);
+    void RemoveNode(frame_id_t frame_id);
+    void AddToFront(frame_id_t frame_id);
 
-    Node* head_;
-    Node* tail_;
-    std::unordered_map<frame_id_t, Node*> node_map_;
+    std::vector<Node> nodes_;
+    frame_id_t sentinel_;
+    size_t size_;
     mutable std::mutex mutex_;
 };
 
@@ -0,0 +1,55 @@
+#ifndef MMAP_DISK_MANAGER_H
+#define MMAP_DISK_MANAGER_H
+
+#include "config.h"
+#include "page.h"
+#include <string>
+
+namespace logicmaze {
+
+// Read-only access to a database file through a shared memory mapping.
+// GetPage hands out views straight into the mapping, with no copy into a
+// buffer pool frame and no checksum check (callers that care can call
+// Page::VerifyChecksum). Meant for reporting jobs that only read.
+//
+// The mapping covers the pages in use when the file was opened (per the
+// header, so a preallocated tail is left out); pages appended later are
+// not visible. Truncating the file while it is mapped makes accesses
+// to the lost pages fault (SIGBUS).
+class MmapDiskManager {
+public:
+    // Hints passed to madvise
+    enum class AccessPattern {
+        NORMAL,
+        SEQUENTIAL,  // Aggressive kernel read-ahead, pages dropped after use
+        RANDOM       // No read-ahead
+    };
+
+    explicit MmapDiskManager(const std::string& db_filename);
+    ~MmapDiskManager();
+
+    MmapDiskManager(const MmapDiskManager&) = delete;
+    MmapDiskManager& operator=(const MmapDiskManager&) = delete;
+
+    // View of a page, valid for the lifetime of the manager
+    const Page* GetPage(page_id_t page_id) const;
+    // Copy a page out, same contract as DiskManager::ReadPage
+    void ReadPage(page_id_t page_id, Page* page) const;
+    page_id_t GetNumPages() const { return num_pages_; }
+
+    void Advise(AccessPattern pattern);
+    // Ask the kernel to start reading [first, first + count) in the background
+    void WillNeed(page_id_t first, size_t count);
+
+private:
+    void Madvise(page_id_t first, size_t count, int advice);
+
+    std::string db_filename_;
+    int fd_;
+    const char* data_;
+    page_id_t num_pages_;
+};
+
+}  // namespace logicmaze
+
+#endif  // MMAP_DISK_MANAGER_H
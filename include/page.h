@@ -2,6 +2,8 @@
 #define PAGE_H
 
 #include "config.h"
+#include "crc32c.h"
+#include <cstddef>
 #include <cstring>
 #include <cstdint>
 
@@ -16,7 +18,8 @@ struct PageHeader {
     uint32_t free_space;         // 4 bytes
     uint32_t free_space_offset;  // 4 bytes - where free space starts
     uint32_t checksum;           // 4 bytes
-    uint8_t reserved[104];       // 104 bytes (for future use)
+    lsn_t lsn;                   // 8 bytes - end of the last log record for this page
+    uint8_t reserved[96];        // 96 bytes (for future use)
     
     PageHeader() 
         : page_id(INVALID_PAGE_ID),
@@ -24,7 +27,8 @@ struct PageHeader {
           num_records(0),
           free_space(PAGE_DATA_SIZE),
           free_space_offset(0),
-          checksum(0) {
+          checksum(0),
+          lsn(INVALID_LSN) {
         std::memset(padding1, 0, sizeof(padding1));
         std::memset(reserved, 0, sizeof(reserved));
     }
@@ -34,7 +38,7 @@ static_assert(sizeof(PageHeader) == PAGE_HEADER_SIZE,
               "PageHeader size must be exactly 128 bytes");
 
 // Page class representing an 8KB page
-class Page {
+class alignas(PAGE_ALIGNMENT) Page {
 public:
     Page() {
         std::memset(data_, 0, PAGE_SIZE);
@@ -67,6 +71,16 @@ public:
         return data_;
     }
 
+    // LSN of the last logged change; the write-ahead rule keeps the page
+    // from reaching disk before the log is durable up to here
+    lsn_t GetLSN() const {
+        return GetHeader()->lsn;
+    }
+
+    void SetLSN(lsn_t lsn) {
+        GetHeader()->lsn = lsn;
+    }
+
     // Reset page to empty state
     void Reset() {
         std::memset(data_, 0, PAGE_SIZE);
@@ -74,15 +88,15 @@ public:
         *header = PageHeader();
     }
 
-    // Calculate simple checksum
+    // CRC32C of the whole page (header and data), with the checksum
+    // field itself taken as zero
     uint32_t CalculateChecksum() const {
-        uint32_t sum = 0;
-        const uint32_t* data = reinterpret_cast<const uint32_t*>(data_ + PAGE_HEADER_SIZE);
-        size_t count = PAGE_DATA_SIZE / sizeof(uint32_t);
-        for (size_t i = 0; i < count; ++i) {
-            sum ^= data[i];
-        }
-        return sum;
+        constexpr size_t offset = offsetof(PageHeader, checksum);
+        constexpr size_t rest = offset + sizeof(uint32_t);
+        const uint32_t zero = 0;
+        uint32_t crc = Crc32c(data_, offset);
+        crc = Crc32c(&zero, sizeof(zero), crc);
+        return Crc32c(data_ + rest, PAGE_SIZE - rest, crc);
     }
 
     // Verify checksum
@@ -99,6 +113,8 @@ private:
     char data_[PAGE_SIZE];
 };
 
+static_assert(sizeof(Page) == PAGE_SIZE, "Page must be exactly one on-disk page");
+
 }  // namespace logicmaze
 
 #endif  // PAGE_H
@@ -0,0 +1,74 @@
+#ifndef PAGE_GUARD_H
+#define PAGE_GUARD_H
+
+#include "config.h"
+#include "page.h"
+#include <shared_mutex>
+
+namespace logicmaze {
+
+class BufferPoolManager;
+
+// Move-only handle to a pinned page holding the frame's latch in shared mode.
+// Destruction (or Release) drops the latch and unpins the page.
+class ReadPageGuard {
+public:
+    ReadPageGuard() = default;
+    ReadPageGuard(BufferPoolManager* bpm, Page* page, page_id_t page_id,
+                  std::shared_mutex* latch);
+    ~ReadPageGuard();
+
+    ReadPageGuard(const ReadPageGuard&) = delete;
+    ReadPageGuard& operator=(const ReadPageGuard&) = delete;
+    ReadPageGuard(ReadPageGuard&& other) noexcept;
+    ReadPageGuard& operator=(ReadPageGuard&& other) noexcept;
+
+    // Unlatch and unpin now instead of at destruction
+    void Release();
+
+    bool IsValid() const { return page_ != nullptr; }
+    page_id_t GetPageId() const { return page_id_; }
+    const Page* GetPage() const { return page_; }
+    const char* GetData() const { return page_->GetData(); }
+
+private:
+    BufferPoolManager* bpm_ = nullptr;
+    Page* page_ = nullptr;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    std::shared_mutex* latch_ = nullptr;
+};
+
+// Move-only handle to a pinned page holding the frame's latch exclusively.
+// Destruction (or Release) drops the latch and unpins the page as dirty.
+class WritePageGuard {
+public:
+    WritePageGuard() = default;
+    WritePageGuard(BufferPoolManager* bpm, Page* page, page_id_t page_id,
+                   std::shared_mutex* latch);
+    ~WritePageGuard();
+
+    WritePageGuard(const WritePageGuard&) = delete;
+    WritePageGuard& operator=(const WritePageGuard&) = delete;
+    WritePageGuard(WritePageGuard&& other) noexcept;
+    WritePageGuard& operator=(WritePageGuard&& other) noexcept;
+
+    // Unlatch and unpin (dirty) now instead of at destruction
+    void Release();
+
+    bool IsValid() const { return page_ != nullptr; }
+    page_id_t GetPageId() const { return page_id_; }
+    Page* GetPage() { return page_; }
+    const Page* GetPage() const { return page_; }
+    char* GetData() { return page_->GetData(); }
+    const char* GetData() const { return page_->GetData(); }
+
+private:
+    BufferPoolManager* bpm_ = nullptr;
+    Page* page_ = nullptr;
+    page_id_t page_id_ = INVALID_PAGE_ID;
+    std::shared_mutex* latch_ = nullptr;
+};
+
+}  // namespace logicmaze
+
+#endif  // PAGE_GUARD_H
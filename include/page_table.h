@@ -0,0 +1,44 @@
+#ifndef PAGE_TABLE_H
+#define PAGE_TABLE_H
+
+#include "config.h"
+#include <vector>
+
+namespace logicmaze {
+
+// Open-addressing page_id -> frame_id map with linear probing.
+// Capacity is fixed at construction (at least twice max_entries), so
+// lookups, inserts and erases never allocate.
+class PageTable {
+public:
+    explicit PageTable(size_t max_entries);
+
+    PageTable(const PageTable&) = delete;
+    PageTable& operator=(const PageTable&) = delete;
+
+    // Returns INVALID_FRAME_ID if page_id is not mapped
+    frame_id_t Find(page_id_t page_id) const;
+    void Insert(page_id_t page_id, frame_id_t frame_id);
+    bool Erase(page_id_t page_id);
+    size_t Size() const { return size_; }
+
+private:
+    struct Slot {
+        page_id_t page_id;
+        frame_id_t frame_id;
+    };
+
+    size_t Home(page_id_t page_id) const {
+        // Fibonacci hashing spreads sequential page ids across the table
+        return (static_cast<uint64_t>(page_id) * 0x9E3779B97F4A7C15ULL) >> shift_;
+    }
+
+    std::vector<Slot> slots_;
+    size_t mask_;
+    unsigned shift_;
+    size_t size_;
+};
+
+}  // namespace logicmaze
+
+#endif  // PAGE_TABLE_H
@@ -0,0 +1,90 @@
+#ifndef PARALLEL_BUFFER_POOL_MANAGER_H
+#define PARALLEL_BUFFER_POOL_MANAGER_H
+
+#include "config.h"
+#include "page.h"
+#include "disk_manager.h"
+#include "buffer_pool_manager.h"
+#include <vector>
+#include <atomic>
+#include <mutex>
+
+namespace logicmaze {
+
+// Buffer pool split into independently latched BufferPoolManager instances.
+// A page always lives in the instance selected by its page id, so accesses
+// to pages in different instances never contend on the same latch.
+//
+// Consecutive pages belong to different instances, so no instance can see
+// a sequential scan. Read-ahead is done here instead: sequential runs are
+// detected over all fetches, and the window ahead of them is prefetched by
+// the owning instances. The window is capped at a quarter of the frames
+// of all instances together.
+class ParallelBufferPoolManager {
+public:
+    // pool_size is the number of frames per instance
+    ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                              DiskManager* disk_manager,
+                              const BufferPoolOptions& options = BufferPoolOptions());
+    ~ParallelBufferPoolManager();
+
+    ParallelBufferPoolManager(const ParallelBufferPoolManager&) = delete;
+    ParallelBufferPoolManager& operator=(const ParallelBufferPoolManager&) = delete;
+
+    Page* FetchPage(page_id_t page_id);
+    bool UnpinPage(page_id_t page_id, bool is_dirty);
+    // Same rules as BufferPoolManager: no write guard held on flushed pages
+    bool FlushPage(page_id_t page_id);
+    void FlushAllPages();
+    Page* NewPage(page_id_t* page_id);
+    bool DeletePage(page_id_t page_id);
+
+    ReadPageGuard FetchPageRead(page_id_t page_id);
+    WritePageGuard FetchPageWrite(page_id_t page_id);
+
+    // Each page is prefetched by the instance that owns it
+    size_t Prefetch(page_id_t first, size_t count);
+
+    // Resize every instance to pool_size frames, see BufferPoolManager::Resize
+    void Resize(size_t pool_size);
+
+    // One checkpoint over all instances, see BufferPoolManager::Checkpoint;
+    // the log record holds every instance's dirty pages
+    size_t Checkpoint();
+
+    size_t GetNumInstances() const { return instances_.size(); }
+    size_t GetPoolSize() const;
+    size_t GetHitCount() const;
+    size_t GetMissCount() const;
+    size_t GetPrefetchCount() const;
+    size_t GetForegroundWriteCount() const;
+    size_t GetBackgroundWriteCount() const;
+    double GetHitRate() const {
+        size_t hits = GetHitCount();
+        size_t total = hits + GetMissCount();
+        return total == 0 ? 0.0 : static_cast<double>(hits) / total;
+    }
+
+private:
+    BufferPoolManager* GetInstance(page_id_t page_id) const {
+        return instances_[page_id % instances_.size()];
+    }
+    // Track sequential runs and top up the read-ahead window, before a
+    // fetch of page_id
+    void ReadAhead(page_id_t page_id);
+
+    DiskManager* disk_manager_;
+    std::vector<BufferPoolManager*> instances_;
+    // Read-ahead state, updated without a latch: a lost race only costs
+    // a missed or repeated hint
+    size_t read_ahead_limit_;  // From the options, before the pool-size cap
+    std::atomic<size_t> read_ahead_pages_;
+    std::atomic<page_id_t> last_fetch_page_id_;
+    std::atomic<size_t> sequential_run_;
+    std::atomic<page_id_t> read_ahead_end_;
+    std::mutex checkpoint_mutex_;
+};
+
+}  // namespace logicmaze
+
+#endif  // PARALLEL_BUFFER_POOL_MANAGER_H
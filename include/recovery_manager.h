@@ -0,0 +1,49 @@
+#ifndef RECOVERY_MANAGER_H
+#define RECOVERY_MANAGER_H
+
+#include "config.h"
+#include "disk_manager.h"
+#include "log_manager.h"
+#include <string>
+#include <vector>
+
+namespace logicmaze {
+
+struct RecoveryStats {
+    lsn_t checkpoint_lsn = INVALID_LSN;  // Checkpoint record recovery started from
+    lsn_t redo_lsn = INVALID_LSN;        // Where redo started
+    lsn_t end_lsn = INVALID_LSN;         // End of the last intact log record
+    size_t records_scanned = 0;
+    size_t records_applied = 0;          // Page records newer than their page
+    size_t pages_written = 0;
+    // Transactions with changes but no commit or abort record. Their
+    // changes are redone like all others; the log has no undo information.
+    std::vector<txn_id_t> uncommitted_txns;
+};
+
+// Crash recovery by redo. Starts at the redo LSN the last checkpoint left
+// in the header page (the start of the log if there was none) and applies
+// every page record newer than the page it targets, so its cost is bounded
+// by the log written since that checkpoint, not by the size of the log.
+//
+// A page whose checksum fails (a torn write) is rebuilt from scratch; the
+// first record for it must then be a full page image, which the log
+// manager guarantees for pages changed after the checkpoint started.
+//
+// Runs before a LogManager or buffer pool is opened on the files.
+class RecoveryManager {
+public:
+    RecoveryManager(DiskManager* disk_manager, const std::string& log_filename);
+
+    // Bring the data file up to date with the log and make it durable.
+    // A missing log file means there is nothing to recover.
+    RecoveryStats Recover();
+
+private:
+    DiskManager* disk_manager_;
+    std::string log_filename_;
+};
+
+}  // namespace logicmaze
+
+#endif  // RECOVERY_MANAGER_H
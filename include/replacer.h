@@ -0,0 +1,32 @@
+#ifndef REPLACER_H
+#define REPLACER_H
+
+#include "config.h"
+#include <vector>
+
+namespace logicmaze {
+
+// Page replacement policy used by BufferPoolManager.
+// Only unpinned frames are eviction candidates.
+class Replacer {
+public:
+    virtual ~Replacer() = default;
+
+    // Choose and remove a frame to evict, false if none is evictable
+    virtual bool Victim(frame_id_t* frame_id) = 0;
+    // Frame is in use and must not be evicted
+    virtual void Pin(frame_id_t frame_id) = 0;
+    // Frame's pin count dropped to zero, it may be evicted
+    virtual void Unpin(frame_id_t frame_id) = 0;
+    // Frame was freed without eviction, forget everything about it
+    virtual void Remove(frame_id_t frame_id) = 0;
+    // Number of evictable frames
+    virtual size_t Size() const = 0;
+    // Up to max evictable frames, coldest first (roughly the order Victim
+    // would pick them), without changing any replacement state
+    virtual void ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const = 0;
+};
+
+}  // namespace logicmaze
+
+#endif  // REPLACER_H
@@ -0,0 +1,101 @@
+#ifndef TABLE_HEAP_H
+#define TABLE_HEAP_H
+
+#include "config.h"
+#include "buffer_pool_manager.h"
+#include "page_guard.h"
+#include "table_page.h"
+#include <mutex>
+#include <set>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace logicmaze {
+
+class TableHeap;
+
+// Walks a table's records in page order, holding the current page's read
+// latch; records inserted behind it are not seen.
+class TableIterator {
+public:
+    bool IsEnd() const { return !guard_.IsValid(); }
+    void Next();
+
+    RID GetRID() const { return RID(guard_.GetPageId(), slot_num_); }
+    // Valid until the iterator moves
+    const char* GetData() const { return data_; }
+    uint16_t GetSize() const { return size_; }
+
+private:
+    friend class TableHeap;
+    TableIterator(BufferPoolManager* bpm, page_id_t page_id);
+    // Stop at the first live record at or after slot_num_, moving on
+    // through the page chain
+    void SeekLive();
+
+    BufferPoolManager* bpm_;
+    ReadPageGuard guard_;
+    uint16_t slot_num_ = 0;
+    const char* data_ = nullptr;
+    uint16_t size_ = 0;
+};
+
+// Unordered table storage: a doubly linked chain of TablePages in the
+// buffer pool, identified by its first page. The heap keeps the pages with
+// at least TABLE_PAGE_REUSE_SPACE free bytes in memory (found again when a
+// table is opened), so an insert goes to the one with the least room that
+// fits the record, space freed by deletes included, then to the last page,
+// and appends a new page only when that is full. Record operations latch
+// only the page they touch.
+class TableHeap {
+public:
+    // Create a table with one empty page
+    explicit TableHeap(BufferPoolManager* bpm);
+    // Open a table created earlier
+    TableHeap(BufferPoolManager* bpm, page_id_t first_page_id);
+
+    TableHeap(const TableHeap&) = delete;
+    TableHeap& operator=(const TableHeap&) = delete;
+
+    // Records larger than TablePage::MAX_RECORD_SIZE (or empty) are
+    // rejected with std::invalid_argument
+    RID InsertRecord(const char* data, uint16_t size);
+    // Copy a record out; false if there is none with this id
+    bool GetRecord(const RID& rid, std::vector<char>* record);
+    bool DeleteRecord(const RID& rid);
+    // False if there is no such record, or the new version no longer fits
+    // on the record's page (the caller may delete and reinsert it)
+    bool UpdateRecord(const RID& rid, const char* data, uint16_t size);
+
+    TableIterator Begin();
+    page_id_t GetFirstPageId() const { return first_page_id_; }
+    // Pages in the chain, walked from the first one
+    size_t GetPageCount();
+
+private:
+    ReadPageGuard FetchRead(page_id_t page_id);
+    WritePageGuard FetchWrite(page_id_t page_id);
+    // Append an empty page after last_page_id_
+    WritePageGuard AppendPage(WritePageGuard* last);
+    // Record a page's free space, with its latch held; pages with less than
+    // TABLE_PAGE_REUSE_SPACE are dropped
+    void NoteFreeSpace(page_id_t page_id, uint32_t free_space);
+    // A page whose last noted free space is at least size, or
+    // INVALID_PAGE_ID
+    page_id_t FindFreePage(uint32_t size);
+
+    BufferPoolManager* bpm_;
+    page_id_t first_page_id_;
+    std::mutex append_mutex_;  // Serializes inserts, which may grow the chain
+    page_id_t last_page_id_;
+    // Guards the free space below; taken with at most one page latch held
+    // and released before latching another page
+    std::mutex free_mutex_;
+    std::set<std::pair<uint32_t, page_id_t>> free_pages_;  // By free space, then page id
+    std::unordered_map<page_id_t, uint32_t> free_space_;
+};
+
+}  // namespace logicmaze
+
+#endif  // TABLE_HEAP_H
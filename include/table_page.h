@@ -0,0 +1,106 @@
+#ifndef TABLE_PAGE_H
+#define TABLE_PAGE_H
+
+#include "config.h"
+#include "page.h"
+
+namespace logicmaze {
+
+// Record id: the page a record lives on and its slot there. Stays valid
+// until the record is deleted, whatever happens to other records.
+struct RID {
+    page_id_t page_id = INVALID_PAGE_ID;
+    uint16_t slot_num = 0;
+
+    RID() = default;
+    RID(page_id_t page, uint16_t slot) : page_id(page), slot_num(slot) {}
+
+    bool operator==(const RID& other) const {
+        return page_id == other.page_id && slot_num == other.slot_num;
+    }
+    bool operator!=(const RID& other) const { return !(*this == other); }
+};
+
+// Start of the data area of a table page
+struct TablePageHeader {
+    page_id_t prev_page_id;
+    page_id_t next_page_id;
+    uint16_t slot_count;  // Including empty slots
+    uint16_t padding;
+};
+
+// Slot directory entry; an empty slot has offset 0
+struct TableSlot {
+    uint16_t offset;  // Of the record in the data area
+    uint16_t size;
+};
+
+// Slotted page layout for variable-length records, viewed over a Page of
+// type DATA. The slot directory follows the TablePageHeader and grows
+// towards the end of the page; records are packed from the end of the
+// page backwards. In the PageHeader, num_records counts live records,
+// free_space is every byte an insert could use (after compaction) and
+// free_space_offset is where the record area starts.
+//
+// Deleting a record leaves a hole that is reclaimed by compaction, which
+// moves records but not slots, so record ids stay stable. The caller
+// holds the page's latch.
+class TablePage {
+public:
+    // Largest record that fits on an empty page
+    static constexpr size_t MAX_RECORD_SIZE =
+        PAGE_DATA_SIZE - sizeof(TablePageHeader) - sizeof(TableSlot);
+
+    explicit TablePage(Page* page) : page_(page) {}
+    // Read-only view; only const members can be called on it
+    static TablePage View(const Page* page) { return TablePage(const_cast<Page*>(page)); }
+
+    // Format an empty table page
+    void Init(page_id_t page_id, page_id_t prev_page_id);
+
+    page_id_t GetPrevPageId() const { return GetTableHeader()->prev_page_id; }
+    page_id_t GetNextPageId() const { return GetTableHeader()->next_page_id; }
+    void SetNextPageId(page_id_t page_id) { GetTableHeader()->next_page_id = page_id; }
+    uint16_t GetSlotCount() const { return GetTableHeader()->slot_count; }
+    uint32_t GetRecordCount() const { return page_->GetHeader()->num_records; }
+    // Bytes an insert may use, including the slot it may need
+    uint32_t GetFreeSpace() const { return page_->GetHeader()->free_space; }
+
+    // Store a record, reusing an empty slot if there is one; compacts the
+    // page first if only the holes make it fit. False if it does not fit.
+    bool InsertRecord(const char* data, uint16_t size, uint16_t* slot_num);
+    // Point at a live record's bytes, which stay put until the page changes
+    bool GetRecord(uint16_t slot_num, const char** data, uint16_t* size) const;
+    bool DeleteRecord(uint16_t slot_num);
+    // Replace a live record; shrinking happens in place. False if the slot
+    // is empty or the new version does not fit, leaving the old one.
+    bool UpdateRecord(uint16_t slot_num, const char* data, uint16_t size);
+    // Move the records together at the end of the page, removing the holes
+    void Compact();
+
+private:
+    TablePageHeader* GetTableHeader() {
+        return reinterpret_cast<TablePageHeader*>(page_->GetData());
+    }
+    const TablePageHeader* GetTableHeader() const {
+        return reinterpret_cast<const TablePageHeader*>(page_->GetData());
+    }
+    TableSlot* GetSlots() {
+        return reinterpret_cast<TableSlot*>(page_->GetData() + sizeof(TablePageHeader));
+    }
+    const TableSlot* GetSlots() const {
+        return reinterpret_cast<const TableSlot*>(page_->GetData() + sizeof(TablePageHeader));
+    }
+    // End of the slot directory in the data area
+    size_t SlotsEnd() const {
+        return sizeof(TablePageHeader) + GetSlotCount() * sizeof(TableSlot);
+    }
+    // Copy a record into the free gap, compacting first if needed
+    uint16_t PlaceRecord(const char* data, uint16_t size);
+
+    Page* page_;
+};
+
+}  // namespace logicmaze
+
+#endif  // TABLE_PAGE_H
@@ -0,0 +1,441 @@
+#include "async_io.h"
+#include "config.h"
+#include "file_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <initializer_list>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#define LOGICMAZE_HAVE_IO_URING 1
+#endif
+
+namespace logicmaze {
+
+namespace {
+
+// Blocking I/O on a few worker threads, fed from a queue of at most
+// queue_depth requests
+class ThreadPoolEngine : public AsyncIOEngine {
+public:
+    ThreadPoolEngine(size_t queue_depth, size_t num_threads)
+        : queue_depth_(queue_depth), pending_(0), stopping_(false) {
+        for (size_t i = 0; i < num_threads; ++i) {
+            workers_.emplace_back([this]() { WorkerLoop(); });
+        }
+    }
+
+    ~ThreadPoolEngine() override {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        cv_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    void SubmitRead(int fd, char* buffer, size_t size, off_t offset,
+                    IOCallback callback) override {
+        Enqueue(Task{false, fd, buffer, size, offset, std::move(callback)});
+    }
+
+    void SubmitWrite(int fd, const char* buffer, size_t size, off_t offset,
+                     IOCallback callback) override {
+        Enqueue(Task{true, fd, const_cast<char*>(buffer), size, offset, std::move(callback)});
+    }
+
+    const char* Name() const override { return "thread-pool"; }
+
+private:
+    struct Task {
+        bool is_write;
+        int fd;
+        char* buffer;
+        size_t size;
+        off_t offset;
+        IOCallback callback;
+    };
+
+    void Enqueue(Task task) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            // Requests being worked on count against the queue too
+            slot_cv_.wait(lock, [this]() { return pending_ < queue_depth_; });
+            pending_++;
+            tasks_.push_back(std::move(task));
+        }
+        cv_.notify_one();
+    }
+
+    void WorkerLoop() {
+        while (true) {
+            Task task;
+            {
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return stopping_ || !tasks_.empty(); });
+                if (tasks_.empty()) {
+                    return;  // Stopping and drained
+                }
+                task = std::move(tasks_.front());
+                tasks_.pop_front();
+            }
+
+            ssize_t done = task.is_write
+                ? PwriteFull(task.fd, task.buffer, task.size, task.offset)
+                : PreadFull(task.fd, task.buffer, task.size, task.offset);
+            task.callback(done == static_cast<ssize_t>(task.size));
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                pending_--;
+            }
+            slot_cv_.notify_one();
+        }
+    }
+
+    std::vector<std::thread> workers_;
+    std::deque<Task> tasks_;
+    size_t queue_depth_;
+    size_t pending_;  // Queued or being worked on
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::condition_variable slot_cv_;
+    bool stopping_;
+};
+
+#ifdef LOGICMAZE_HAVE_IO_URING
+
+// io_uring driven through the raw syscalls: submitters fill SQEs under
+// submit_mutex_, one reaper thread waits for CQEs and runs the callbacks
+class IoUringEngine : public AsyncIOEngine {
+public:
+    static std::unique_ptr<IoUringEngine> TryCreate(unsigned entries) {
+        std::unique_ptr<IoUringEngine> engine(new IoUringEngine());
+        if (!engine->Setup(entries)) {
+            return nullptr;
+        }
+        engine->reaper_ = std::thread([raw = engine.get()]() { raw->ReapLoop(); });
+        return engine;
+    }
+
+    ~IoUringEngine() override {
+        if (ring_fd_ < 0) {
+            return;
+        }
+        if (reaper_.joinable()) {
+            {
+                std::unique_lock<std::mutex> lock(submit_mutex_);
+                slot_cv_.wait(lock, [this]() { return in_flight_ == 0; });
+                stopping_ = true;
+            }
+            // Wake the reaper with a no-op so it sees stopping_
+            Submit(IORING_OP_NOP, -1, nullptr, 0, 0, nullptr);
+            reaper_.join();
+        }
+        Teardown();
+    }
+
+    void SubmitRead(int fd, char* buffer, size_t size, off_t offset,
+                    IOCallback callback) override {
+        Submit(IORING_OP_READ, fd, buffer, size, offset,
+               new Request{std::move(callback), IORING_OP_READ, fd, buffer, size, offset, 0});
+    }
+
+    void SubmitWrite(int fd, const char* buffer, size_t size, off_t offset,
+                     IOCallback callback) override {
+        char* data = const_cast<char*>(buffer);
+        Submit(IORING_OP_WRITE, fd, data, size, offset,
+               new Request{std::move(callback), IORING_OP_WRITE, fd, data, size, offset, 0});
+    }
+
+    const char* Name() const override { return "io_uring"; }
+
+private:
+    struct Request {
+        IOCallback callback;
+        uint8_t opcode;
+        int fd;
+        char* buffer;
+        size_t size;
+        off_t offset;
+        size_t done;  // Bytes transferred by earlier, short completions
+    };
+
+    IoUringEngine() = default;
+
+    bool Setup(unsigned entries) {
+        struct io_uring_params params;
+        std::memset(&params, 0, sizeof(params));
+        ring_fd_ = static_cast<int>(syscall(__NR_io_uring_setup, entries, &params));
+        if (ring_fd_ < 0) {
+            return false;  // ENOSYS, or blocked by seccomp/sysctl
+        }
+
+        sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+        cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        bool single_mmap = params.features & IORING_FEAT_SINGLE_MMAP;
+        if (single_mmap) {
+            sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+        }
+
+        sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE,
+                        MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQ_RING);
+        if (sq_ring_ == MAP_FAILED) {
+            sq_ring_ = nullptr;
+            Teardown();
+            return false;
+        }
+        if (single_mmap) {
+            cq_ring_ = sq_ring_;
+        } else {
+            cq_ring_ = mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE,
+                            MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_CQ_RING);
+            if (cq_ring_ == MAP_FAILED) {
+                cq_ring_ = nullptr;
+                Teardown();
+                return false;
+            }
+        }
+        sqes_size_ = params.sq_entries * sizeof(struct io_uring_sqe);
+        sqes_ = static_cast<struct io_uring_sqe*>(
+            mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE,
+                 MAP_SHARED | MAP_POPULATE, ring_fd_, IORING_OFF_SQES));
+        if (sqes_ == MAP_FAILED) {
+            sqes_ = nullptr;
+            Teardown();
+            return false;
+        }
+
+        char* sq = static_cast<char*>(sq_ring_);
+        sq_head_ = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+        sq_tail_ = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+        sq_mask_ = *reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+        sq_array_ = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+        sq_entries_ = params.sq_entries;
+
+        char* cq = static_cast<char*>(cq_ring_);
+        cq_head_ = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+        cq_tail_ = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+        cq_mask_ = *reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+        cqes_ = reinterpret_cast<struct io_uring_cqe*>(cq + params.cq_off.cqes);
+
+        // IORING_OP_READ and IORING_OP_WRITE came after io_uring itself
+        // (Linux 5.6); without them the thread pool takes over
+        if (!Supports({IORING_OP_READ, IORING_OP_WRITE})) {
+            Teardown();
+            return false;
+        }
+        return true;
+    }
+
+    bool Supports(std::initializer_list<uint8_t> opcodes) {
+        // The probe arrived with the same kernel as the opcodes, so a
+        // kernel that rejects it lacks them too
+        const unsigned max_ops = 256;  // Opcodes are 8 bits wide
+        std::vector<uint64_t> storage(
+            (sizeof(struct io_uring_probe) + max_ops * sizeof(struct io_uring_probe_op) + 7) / 8, 0);
+        struct io_uring_probe* probe = reinterpret_cast<struct io_uring_probe*>(storage.data());
+        if (syscall(__NR_io_uring_register, ring_fd_, IORING_REGISTER_PROBE, probe, max_ops) < 0) {
+            return false;
+        }
+        for (uint8_t opcode : opcodes) {
+            if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Teardown() {
+        if (sqes_ != nullptr) {
+            munmap(sqes_, sqes_size_);
+        }
+        if (cq_ring_ != nullptr && cq_ring_ != sq_ring_) {
+            munmap(cq_ring_, cq_ring_size_);
+        }
+        if (sq_ring_ != nullptr) {
+            munmap(sq_ring_, sq_ring_size_);
+        }
+        if (ring_fd_ >= 0) {
+            close(ring_fd_);
+            ring_fd_ = -1;
+        }
+    }
+
+    void Submit(uint8_t opcode, int fd, char* buffer, size_t size, off_t offset,
+                Request* request) {
+        {
+            std::unique_lock<std::mutex> lock(submit_mutex_);
+            // The CQ ring is twice the SQ ring, so capping in-flight requests
+            // at the SQ size means completions can never overflow
+            slot_cv_.wait(lock, [this]() { return in_flight_ < sq_entries_; });
+            in_flight_++;
+            if (Enter(opcode, fd, buffer, size, offset, request)) {
+                return;
+            }
+            in_flight_--;
+        }
+        slot_cv_.notify_all();
+        Fail(request);
+    }
+
+    // Fill one SQE and submit it; submit_mutex_ must be held and the
+    // request must already count as in flight. False if the kernel
+    // refused it, in which case the SQE is taken back and no completion
+    // will come.
+    bool Enter(uint8_t opcode, int fd, char* buffer, size_t size, off_t offset,
+               Request* request) {
+        unsigned tail = *sq_tail_;  // Only submitters (under the mutex) write it
+        unsigned index = tail & sq_mask_;
+        struct io_uring_sqe* sqe = &sqes_[index];
+        std::memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = opcode;
+        sqe->fd = fd;
+        sqe->addr = reinterpret_cast<uint64_t>(buffer);
+        sqe->len = static_cast<uint32_t>(size);
+        sqe->off = static_cast<uint64_t>(offset);
+        sqe->user_data = reinterpret_cast<uint64_t>(request);
+        sq_array_[index] = index;
+        __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+
+        while (syscall(__NR_io_uring_enter, ring_fd_, 1, 0, 0, nullptr, 0) < 0) {
+            if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+                // Without SQPOLL the kernel only takes SQEs inside
+                // io_uring_enter; if it did not take this one, unpublish it
+                if (__atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) != tail + 1) {
+                    __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+                    return false;
+                }
+                break;  // Taken: its completion reports the outcome
+            }
+        }
+        return true;
+    }
+
+    // Complete a request that could not be submitted
+    static void Fail(Request* request) {
+        if (request != nullptr) {
+            request->callback(false);
+            delete request;
+        }
+    }
+
+    void ReapLoop() {
+        std::vector<Request*> resubmit;
+        while (true) {
+            unsigned head = *cq_head_;  // Only this thread writes it
+            unsigned tail = __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE);
+
+            if (head == tail) {
+                {
+                    std::lock_guard<std::mutex> lock(submit_mutex_);
+                    if (stopping_ && in_flight_ == 0) {
+                        return;
+                    }
+                }
+                syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+                continue;
+            }
+
+            size_t completed = 0;
+            for (; head != tail; ++head) {
+                const struct io_uring_cqe& cqe = cqes_[head & cq_mask_];
+                Request* request = reinterpret_cast<Request*>(cqe.user_data);
+                if (request == nullptr) {
+                    completed++;
+                    continue;
+                }
+                if (cqe.res > 0 && request->done + cqe.res < request->size) {
+                    // Short transfer, like pread/pwrite may return: the
+                    // rest goes out again and keeps the request's slot
+                    request->done += cqe.res;
+                    resubmit.push_back(request);
+                    continue;
+                }
+                request->callback(cqe.res >= 0 && request->done + cqe.res == request->size);
+                delete request;
+                completed++;
+            }
+            __atomic_store_n(cq_head_, head, __ATOMIC_RELEASE);
+
+            {
+                std::lock_guard<std::mutex> lock(submit_mutex_);
+                in_flight_ -= completed;
+                for (Request*& request : resubmit) {
+                    if (Enter(request->opcode, request->fd, request->buffer + request->done,
+                              request->size - request->done,
+                              request->offset + static_cast<off_t>(request->done), request)) {
+                        request = nullptr;
+                    } else {
+                        in_flight_--;
+                    }
+                }
+            }
+            slot_cv_.notify_all();
+            // Resubmits the kernel refused fail outside the lock
+            for (Request* request : resubmit) {
+                Fail(request);
+            }
+            resubmit.clear();
+        }
+    }
+
+    int ring_fd_ = -1;
+    void* sq_ring_ = nullptr;
+    void* cq_ring_ = nullptr;
+    size_t sq_ring_size_ = 0;
+    size_t cq_ring_size_ = 0;
+    struct io_uring_sqe* sqes_ = nullptr;
+    size_t sqes_size_ = 0;
+
+    unsigned* sq_head_ = nullptr;
+    unsigned* sq_tail_ = nullptr;
+    unsigned sq_mask_ = 0;
+    unsigned* sq_array_ = nullptr;
+    unsigned sq_entries_ = 0;
+    unsigned* cq_head_ = nullptr;
+    unsigned* cq_tail_ = nullptr;
+    unsigned cq_mask_ = 0;
+    struct io_uring_cqe* cqes_ = nullptr;
+
+    std::mutex submit_mutex_;
+    std::condition_variable slot_cv_;
+    size_t in_flight_ = 0;
+    bool stopping_ = false;
+    std::thread reaper_;
+};
+
+#endif  // LOGICMAZE_HAVE_IO_URING
+
+}  // namespace
+
+std::unique_ptr<AsyncIOEngine> AsyncIOEngine::Create(size_t queue_depth, bool allow_io_uring) {
+    queue_depth = std::max<size_t>(queue_depth, 1);
+
+#ifdef LOGICMAZE_HAVE_IO_URING
+    if (allow_io_uring) {
+        std::unique_ptr<IoUringEngine> engine =
+            IoUringEngine::TryCreate(static_cast<unsigned>(queue_depth));
+        if (engine != nullptr) {
+            return engine;
+        }
+    }
+#else
+    (void)allow_io_uring;
+#endif
+
+    return std::unique_ptr<AsyncIOEngine>(
+        new ThreadPoolEngine(queue_depth, std::min(queue_depth, ASYNC_IO_THREADS)));
+}
+
+}  // namespace logicmaze
@@ -0,0 +1,750 @@
+#include "b_plus_tree.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace logicmaze {
+
+template <typename KeyType, typename KeyComparator>
+BPlusTreeIndexIterator<KeyType, KeyComparator>::BPlusTreeIndexIterator(BufferPoolManager* bpm, ReadPageGuard guard,
+                                                               uint32_t index)
+    : bpm_(bpm), guard_(std::move(guard)), index_(index) {
+    SkipExhausted();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndexIterator<KeyType, KeyComparator>::Next() {
+    index_++;
+    SkipExhausted();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndexIterator<KeyType, KeyComparator>::SkipExhausted() {
+    while (guard_.IsValid()) {
+        const LeafPage leaf = LeafPage::View(guard_.GetPage());
+        if (index_ < leaf.GetSize()) {
+            return;
+        }
+        page_id_t next_page_id = leaf.GetNextPageId();
+        if (next_page_id == INVALID_PAGE_ID) {
+            guard_.Release();
+            return;
+        }
+        ReadPageGuard next = bpm_->FetchPageRead(next_page_id);
+        if (!next.IsValid()) {
+            throw std::runtime_error("No free frame to scan leaf " + std::to_string(next_page_id));
+        }
+        guard_ = std::move(next);
+        index_ = 0;
+    }
+}
+
+template <typename KeyType, typename KeyComparator>
+BPlusTreeIndex<KeyType, KeyComparator>::BPlusTreeIndex(BufferPoolManager* bpm)
+    : BPlusTreeIndex(bpm, LeafPage::CAPACITY - 1, InternalPage::CAPACITY - 1) {}
+
+template <typename KeyType, typename KeyComparator>
+BPlusTreeIndex<KeyType, KeyComparator>::BPlusTreeIndex(BufferPoolManager* bpm, uint32_t leaf_max_size,
+                                               uint32_t internal_max_size)
+    : bpm_(bpm),
+      leaf_max_size_(leaf_max_size),
+      internal_max_size_(internal_max_size),
+      pessimistic_count_(0) {
+    // Leaves keep at least one entry and internal nodes two children
+    if (leaf_max_size_ < 2 || leaf_max_size_ >= LeafPage::CAPACITY ||
+        internal_max_size_ < 3 || internal_max_size_ >= InternalPage::CAPACITY) {
+        throw std::invalid_argument("B+ tree node sizes do not fit a page");
+    }
+
+    Page* header_page = NewNode(&header_page_id_);
+    page_id_t root_page_id;
+    Page* root_page;
+    try {
+        root_page = NewNode(&root_page_id);
+    } catch (...) {
+        bpm_->UnpinPage(header_page_id_, false);
+        bpm_->DeletePage(header_page_id_);
+        throw;
+    }
+    LeafPage(root_page).Init(root_page_id, leaf_max_size_);
+    bpm_->UnpinPage(root_page_id, true);
+
+    header_page->GetHeader()->page_type = PageType::INDEX;
+    BPlusTreeHeader* header = reinterpret_cast<BPlusTreeHeader*>(header_page->GetData());
+    header->root_page_id = root_page_id;
+    header->root_level = 0;
+    header->leaf_max_size = leaf_max_size_;
+    header->internal_max_size = internal_max_size_;
+    bpm_->UnpinPage(header_page_id_, true);
+}
+
+template <typename KeyType, typename KeyComparator>
+BPlusTreeIndex<KeyType, KeyComparator>::BPlusTreeIndex(BufferPoolManager* bpm, page_id_t header_page_id)
+    : bpm_(bpm), header_page_id_(header_page_id), pessimistic_count_(0) {
+    ReadPageGuard guard = FetchRead(header_page_id_);
+    const BPlusTreeHeader* header = reinterpret_cast<const BPlusTreeHeader*>(guard.GetData());
+    if (guard.GetPage()->GetHeader()->page_type != PageType::INDEX) {
+        throw std::runtime_error("Page " + std::to_string(header_page_id) + " is not a B+ tree");
+    }
+    leaf_max_size_ = header->leaf_max_size;
+    internal_max_size_ = header->internal_max_size;
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeIndex<KeyType, KeyComparator>::GetValue(const KeyType& key, RID* rid) {
+    ReadPageGuard leaf = FindLeafRead(key, false);
+    return LeafPage::View(leaf.GetPage()).Lookup(key, rid);
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeIndex<KeyType, KeyComparator>::Insert(const KeyType& key, const RID& rid) {
+    {
+        WritePageGuard leaf = FindLeafOptimistic(key, Operation::INSERT);
+        if (leaf.IsValid()) {
+            return LeafPage(leaf.GetPage()).Insert(key, rid);
+        }
+    }
+
+    WriteContext ctx;
+    FindLeafPessimistic(key, Operation::INSERT, &ctx);
+    LeafPage leaf(ctx.path.back().GetPage());
+    RID existing;
+    if (leaf.Lookup(key, &existing)) {
+        return false;
+    }
+
+    // Every full node on the path splits, and a full root also needs a new
+    // root above it. Get all the pages first, so running out of frames
+    // cannot leave a node overfull.
+    size_t needed = ctx.header.IsValid() ? 1 : 0;
+    for (const WritePageGuard& guard : ctx.path) {
+        needed += IsSafe(guard.GetPage(), key, Operation::INSERT, false) ? 0 : 1;
+    }
+    try {
+        while (ctx.new_pages.size() < needed) {
+            page_id_t page_id;
+            Page* page = NewNode(&page_id);
+            ctx.new_pages.emplace_back(page_id, page);
+        }
+    } catch (...) {
+        ReleaseNewPages(&ctx);
+        throw;
+    }
+
+    // A key without the leaf's shared prefix may not fit it until it splits
+    bool split_first = leaf.GetSize() > leaf.MaxSizeWith(key);
+    if (!split_first) {
+        leaf.Insert(key, rid);
+    }
+    if (split_first || leaf.GetSize() > leaf.GetMaxSize()) {
+        page_id_t right_page_id = ctx.new_pages.back().first;
+        LeafPage right(ctx.new_pages.back().second);
+        ctx.new_pages.pop_back();
+        right.Init(right_page_id, leaf_max_size_);
+        leaf.MoveHalfTo(&right);
+        right.SetNextPageId(leaf.GetNextPageId());
+        leaf.SetNextPageId(right_page_id);
+        if (split_first) {
+            (KeyComparator()(key, right.KeyAt(0)) ? leaf : right).Insert(key, rid);
+        }
+        KeyType separator = right.KeyAt(0);
+        bpm_->UnpinPage(right_page_id, true);
+        InsertIntoParent(&ctx, ctx.path.size() - 1, separator, right_page_id);
+    }
+    ReleaseNewPages(&ctx);
+    return true;
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeIndex<KeyType, KeyComparator>::Remove(const KeyType& key) {
+    {
+        WritePageGuard leaf = FindLeafOptimistic(key, Operation::REMOVE);
+        if (leaf.IsValid()) {
+            return LeafPage(leaf.GetPage()).Remove(key);
+        }
+    }
+
+    WriteContext ctx;
+    FindLeafPessimistic(key, Operation::REMOVE, &ctx);
+    LeafPage leaf(ctx.path.back().GetPage());
+    if (!leaf.Remove(key)) {
+        return false;
+    }
+    // The top of the path is the root if the header is still held, and
+    // is safe otherwise
+    size_t index = ctx.path.size() - 1;
+    if (index > 0 && leaf.GetSize() < leaf.GetMinSize()) {
+        HandleUnderflow(&ctx, index);
+    }
+    return true;
+}
+
+namespace {
+
+// Builds a tree bottom-up for BulkLoad. Every level keeps its last two
+// nodes pinned: a node is added to its parent only once the one after it
+// starts, so the last node of a level can still take entries from or be
+// merged into its left sibling when the input ends. The smallest key
+// under each pinned node is kept on the side, as internal nodes have no
+// key for their first child. Pages built so far are given back if the
+// load does not finish.
+template <typename KeyType, typename KeyComparator>
+class BulkLoader {
+    using LeafPage = BPlusTreeLeafPage<KeyType, KeyComparator>;
+    using InternalPage = BPlusTreeInternalPage<KeyType, KeyComparator>;
+
+public:
+    BulkLoader(BufferPoolManager* bpm, uint32_t leaf_max_size, uint32_t internal_max_size,
+               double fill_factor)
+        : bpm_(bpm), leaf_max_size_(leaf_max_size), internal_max_size_(internal_max_size),
+          fill_factor_(fill_factor), run_next_(INVALID_PAGE_ID), run_end_(INVALID_PAGE_ID), count_(0),
+          finished_(false) {}
+
+    ~BulkLoader() {
+        for (Level& level : levels_) {
+            if (level.prev != nullptr) {
+                bpm_->UnpinPage(level.prev_id, false);
+            }
+            if (level.cur != nullptr) {
+                bpm_->UnpinPage(level.cur_id, false);
+            }
+        }
+        if (!finished_) {
+            for (page_id_t page_id : pages_) {
+                bpm_->DeletePage(page_id);
+            }
+        }
+        for (page_id_t page_id = run_next_; page_id != run_end_; ++page_id) {
+            bpm_->DeletePage(page_id);
+        }
+    }
+
+    void Add(const KeyType& key, const RID& rid) {
+        if (count_ > 0 && !KeyComparator()(last_key_, key)) {
+            throw std::invalid_argument("Bulk load entry " + std::to_string(count_) +
+                                        " is not above the previous one");
+        }
+        if (levels_.empty() || IsFilled(levels_[0].cur, key)) {
+            StartNode(0, key);
+        }
+        LeafPage(levels_[0].cur).Append(key, rid);
+        last_key_ = key;
+        count_++;
+    }
+
+    // Close every level from the leaves up; returns the root, or
+    // INVALID_PAGE_ID if nothing was added
+    page_id_t Finish(uint32_t* root_level) {
+        for (size_t level = 0; level < levels_.size(); ++level) {
+            Balance(level);
+            if (level + 1 == levels_.size() && levels_[level].prev == nullptr) {
+                // A level with a single node is the root
+                Level& root = levels_[level];
+                bpm_->UnpinPage(root.cur_id, true);
+                root.cur = nullptr;
+                *root_level = static_cast<uint32_t>(level);
+                finished_ = true;
+                return root.cur_id;
+            }
+            if (levels_[level].prev != nullptr) {
+                PushUp(level, &levels_[level].prev, levels_[level].prev_id, levels_[level].prev_key);
+            }
+            if (levels_[level].cur != nullptr) {
+                PushUp(level, &levels_[level].cur, levels_[level].cur_id, levels_[level].cur_key);
+            }
+        }
+        finished_ = true;
+        return INVALID_PAGE_ID;
+    }
+
+    size_t GetCount() const { return count_; }
+
+private:
+    struct Level {
+        page_id_t prev_id = INVALID_PAGE_ID;
+        Page* prev = nullptr;
+        KeyType prev_key;
+        page_id_t cur_id = INVALID_PAGE_ID;
+        Page* cur = nullptr;
+        KeyType cur_key;
+    };
+
+    // Whether a node is filled to the fill factor of the max size it has
+    // once key is added
+    bool IsFilled(Page* page, const KeyType& key) const {
+        BPlusTreeNode node(page);
+        uint32_t max_size =
+            node.IsLeaf() ? LeafPage(page).MaxSizeWith(key) : InternalPage(page).MaxSizeWith(key);
+        uint32_t fill = static_cast<uint32_t>(max_size * fill_factor_);
+        return node.GetSize() >= std::max(fill, std::max(node.GetMinSize(), 2u));
+    }
+
+    // Open a new last node on a level, whose smallest key is key, adding
+    // the one before the current last node to the parent
+    void StartNode(size_t level, const KeyType& key) {
+        if (level == levels_.size()) {
+            levels_.emplace_back();
+        }
+        page_id_t page_id;
+        Page* page;
+        if (level == 0) {
+            page = NewLeafPage(&page_id);
+            LeafPage(page).Init(page_id, leaf_max_size_);
+        } else {
+            page = bpm_->NewPage(&page_id);
+            if (page == nullptr) {
+                throw std::runtime_error("No free frame for a new index page");
+            }
+            pages_.push_back(page_id);
+            InternalPage(page).Init(page_id, static_cast<uint16_t>(level), internal_max_size_);
+        }
+
+        if (levels_[level].prev != nullptr) {
+            PushUp(level, &levels_[level].prev, levels_[level].prev_id, levels_[level].prev_key);
+        }
+        if (level == 0 && levels_[0].cur != nullptr) {
+            LeafPage(levels_[0].cur).SetNextPageId(page_id);
+        }
+        levels_[level].prev = levels_[level].cur;
+        levels_[level].prev_id = levels_[level].cur_id;
+        levels_[level].prev_key = levels_[level].cur_key;
+        levels_[level].cur = page;
+        levels_[level].cur_id = page_id;
+        levels_[level].cur_key = key;
+    }
+
+    // Leaves are taken in order from runs of consecutive pages
+    Page* NewLeafPage(page_id_t* page_id) {
+        if (run_next_ == run_end_) {
+            run_next_ = bpm_->AllocatePages(BPLUS_TREE_BULK_LOAD_RUN_PAGES);
+            run_end_ = run_next_ + static_cast<page_id_t>(BPLUS_TREE_BULK_LOAD_RUN_PAGES);
+        }
+        Page* page = bpm_->NewPageWithId(run_next_);
+        if (page == nullptr) {
+            throw std::runtime_error("No free frame for a new index page");
+        }
+        *page_id = run_next_++;
+        pages_.push_back(*page_id);
+        return page;
+    }
+
+    // Add a finished node on level, whose smallest key is key, to the
+    // parent level and unpin it
+    void PushUp(size_t level, Page** page, page_id_t page_id, KeyType key) {
+        bpm_->UnpinPage(page_id, true);
+        *page = nullptr;
+        if (level + 1 == levels_.size() || IsFilled(levels_[level + 1].cur, key)) {
+            StartNode(level + 1, key);
+        }
+        InternalPage(levels_[level + 1].cur).Append(key, page_id);
+    }
+
+    // Bring the last node of a level up to its min size from its left
+    // sibling, or merge the two if there is not enough for both, in which
+    // case the left one becomes the last
+    void Balance(size_t level) {
+        Level& nodes = levels_[level];
+        if (nodes.prev == nullptr) {
+            return;
+        }
+        BPlusTreeNode cur(nodes.cur);
+        uint32_t min_size = cur.GetMinSize();
+        if (cur.GetSize() >= min_size) {
+            return;
+        }
+        uint32_t total = BPlusTreeNode(nodes.prev).GetSize() + cur.GetSize();
+
+        if (level == 0) {
+            LeafPage prev(nodes.prev);
+            LeafPage last(nodes.cur);
+            if (total < 2 * min_size) {
+                last.MoveAllTo(&prev);
+                DropLast(&nodes);
+                return;
+            }
+            while (last.GetSize() < min_size) {
+                prev.MoveLastToFrontOf(&last);
+            }
+            nodes.cur_key = last.KeyAt(0);
+        } else {
+            InternalPage prev(nodes.prev);
+            InternalPage last(nodes.cur);
+            if (total < 2 * min_size) {
+                last.MoveAllTo(&prev, nodes.cur_key);
+                DropLast(&nodes);
+                return;
+            }
+            while (last.GetSize() < min_size) {
+                KeyType smallest;
+                prev.MoveLastToFrontOf(&last, nodes.cur_key, &smallest);
+                nodes.cur_key = smallest;
+            }
+        }
+    }
+
+    void DropLast(Level* nodes) {
+        bpm_->UnpinPage(nodes->cur_id, false);
+        bpm_->DeletePage(nodes->cur_id);
+        pages_.erase(std::find(pages_.begin(), pages_.end(), nodes->cur_id));
+        nodes->cur = nodes->prev;
+        nodes->cur_id = nodes->prev_id;
+        nodes->cur_key = nodes->prev_key;
+        nodes->prev = nullptr;
+    }
+
+    BufferPoolManager* bpm_;
+    uint32_t leaf_max_size_;
+    uint32_t internal_max_size_;
+    double fill_factor_;
+    std::vector<Level> levels_;  // Leaves first
+    std::vector<page_id_t> pages_;
+    // Unused rest of the current leaf run
+    page_id_t run_next_;
+    page_id_t run_end_;
+    KeyType last_key_;
+    size_t count_;
+    bool finished_;
+};
+
+}  // namespace
+
+template <typename KeyType, typename KeyComparator>
+size_t BPlusTreeIndex<KeyType, KeyComparator>::BulkLoad(const EntrySource& source, double fill_factor) {
+    if (!(fill_factor > 0.0 && fill_factor <= 1.0)) {
+        throw std::invalid_argument("Bulk load fill factor must be in (0, 1]");
+    }
+
+    // Holding the header page keeps every other operation out
+    WritePageGuard header_guard = FetchWrite(header_page_id_);
+    BPlusTreeHeader* header = reinterpret_cast<BPlusTreeHeader*>(header_guard.GetData());
+    page_id_t root_page_id = header->root_page_id;
+    WritePageGuard root_guard = FetchWrite(root_page_id);
+    if (header->root_level != 0 || LeafPage::View(root_guard.GetPage()).GetSize() != 0) {
+        throw std::logic_error("Bulk load needs an empty B+ tree");
+    }
+
+    BulkLoader<KeyType, KeyComparator> loader(bpm_, leaf_max_size_, internal_max_size_, fill_factor);
+    KeyType key;
+    RID rid;
+    while (source(&key, &rid)) {
+        loader.Add(key, rid);
+    }
+    uint32_t root_level;
+    page_id_t built_root_page_id = loader.Finish(&root_level);
+    if (built_root_page_id == INVALID_PAGE_ID) {
+        return 0;
+    }
+
+    // The built root moves into the empty root's page, which the tree keeps,
+    // instead of deleting a page another thread may still have pinned
+    {
+        ReadPageGuard built_root = FetchRead(built_root_page_id);
+        std::memcpy(root_guard.GetPage()->GetRawData(), built_root.GetPage()->GetRawData(), PAGE_SIZE);
+    }
+    root_guard.GetPage()->GetHeader()->page_id = root_page_id;
+    header->root_level = root_level;
+    bpm_->DeletePage(built_root_page_id);
+    return loader.GetCount();
+}
+
+template <typename KeyType, typename KeyComparator>
+typename BPlusTreeIndex<KeyType, KeyComparator>::Iterator BPlusTreeIndex<KeyType, KeyComparator>::Begin() {
+    return Iterator(bpm_, FindLeafRead(KeyType(), true), 0);
+}
+
+template <typename KeyType, typename KeyComparator>
+typename BPlusTreeIndex<KeyType, KeyComparator>::Iterator BPlusTreeIndex<KeyType, KeyComparator>::Begin(
+    const KeyType& key) {
+    ReadPageGuard leaf = FindLeafRead(key, false);
+    uint32_t index = LeafPage::View(leaf.GetPage()).LowerBound(key);
+    return Iterator(bpm_, std::move(leaf), index);
+}
+
+template <typename KeyType, typename KeyComparator>
+uint32_t BPlusTreeIndex<KeyType, KeyComparator>::GetHeight() {
+    ReadPageGuard guard = FetchRead(header_page_id_);
+    return reinterpret_cast<const BPlusTreeHeader*>(guard.GetData())->root_level + 1;
+}
+
+template <typename KeyType, typename KeyComparator>
+ReadPageGuard BPlusTreeIndex<KeyType, KeyComparator>::FetchRead(page_id_t page_id) {
+    ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for index page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+template <typename KeyType, typename KeyComparator>
+WritePageGuard BPlusTreeIndex<KeyType, KeyComparator>::FetchWrite(page_id_t page_id) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for index page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+template <typename KeyType, typename KeyComparator>
+Page* BPlusTreeIndex<KeyType, KeyComparator>::NewNode(page_id_t* page_id) {
+    Page* page = bpm_->NewPage(page_id);
+    if (page == nullptr) {
+        throw std::runtime_error("No free frame for a new index page");
+    }
+    return page;
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndex<KeyType, KeyComparator>::ReleaseNewPages(WriteContext* ctx) {
+    for (const auto& new_page : ctx->new_pages) {
+        bpm_->UnpinPage(new_page.first, false);
+        bpm_->DeletePage(new_page.first);
+    }
+    ctx->new_pages.clear();
+}
+
+template <typename KeyType, typename KeyComparator>
+ReadPageGuard BPlusTreeIndex<KeyType, KeyComparator>::FindLeafRead(const KeyType& key, bool leftmost) {
+    ReadPageGuard guard = FetchRead(header_page_id_);
+    page_id_t page_id = reinterpret_cast<const BPlusTreeHeader*>(guard.GetData())->root_page_id;
+    while (true) {
+        // Assigning the child's guard releases the parent's latch
+        guard = FetchRead(page_id);
+        const InternalPage node = InternalPage::View(guard.GetPage());
+        if (node.IsLeaf()) {
+            return guard;
+        }
+        page_id = node.ChildAt(leftmost ? 0 : node.ChildIndex(key));
+    }
+}
+
+template <typename KeyType, typename KeyComparator>
+WritePageGuard BPlusTreeIndex<KeyType, KeyComparator>::FindLeafOptimistic(const KeyType& key, Operation op) {
+    ReadPageGuard header_guard = FetchRead(header_page_id_);
+    const BPlusTreeHeader* header = reinterpret_cast<const BPlusTreeHeader*>(header_guard.GetData());
+    page_id_t root_page_id = header->root_page_id;
+
+    if (header->root_level == 0) {
+        WritePageGuard leaf = FetchWrite(root_page_id);
+        header_guard.Release();
+        if (!IsSafe(leaf.GetPage(), key, op, true)) {
+            return WritePageGuard();
+        }
+        return leaf;
+    }
+
+    ReadPageGuard guard = FetchRead(root_page_id);
+    header_guard.Release();
+    while (true) {
+        const InternalPage node = InternalPage::View(guard.GetPage());
+        page_id_t child = node.ChildAt(node.ChildIndex(key));
+        if (node.GetLevel() == 1) {
+            WritePageGuard leaf = FetchWrite(child);
+            guard.Release();
+            if (!IsSafe(leaf.GetPage(), key, op, false)) {
+                return WritePageGuard();
+            }
+            return leaf;
+        }
+        guard = FetchRead(child);
+    }
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndex<KeyType, KeyComparator>::FindLeafPessimistic(const KeyType& key, Operation op,
+                                                                 WriteContext* ctx) {
+    pessimistic_count_++;
+    ctx->header = FetchWrite(header_page_id_);
+    page_id_t root_page_id = reinterpret_cast<const BPlusTreeHeader*>(ctx->header.GetData())->root_page_id;
+    WritePageGuard root = FetchWrite(root_page_id);
+    if (IsSafe(root.GetPage(), key, op, true)) {
+        ctx->header.Release();
+    }
+    ctx->path.push_back(std::move(root));
+
+    while (true) {
+        InternalPage node(ctx->path.back().GetPage());
+        if (node.IsLeaf()) {
+            return;
+        }
+        WritePageGuard child = FetchWrite(node.ChildAt(node.ChildIndex(key)));
+        if (IsSafe(child.GetPage(), key, op, false)) {
+            // Nothing above a safe node changes
+            ctx->header.Release();
+            ctx->path.clear();
+        }
+        ctx->path.push_back(std::move(child));
+    }
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeIndex<KeyType, KeyComparator>::IsSafe(const Page* page, const KeyType& key, Operation op,
+                                                    bool is_root) const {
+    const InternalPage node = InternalPage::View(page);
+    if (op == Operation::INSERT) {
+        // A node that stores a shared prefix holds fewer keys without it
+        if (node.IsLeaf()) {
+            return node.GetSize() < LeafPage::View(page).MaxSizeWith(key);
+        }
+        return node.GetSize() < node.MaxSizeAfterSplitOf(node.ChildIndex(key));
+    }
+    if (is_root) {
+        return node.IsLeaf() || node.GetSize() > 2;
+    }
+    return node.GetSize() > node.GetMinSize();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndex<KeyType, KeyComparator>::InsertIntoParent(WriteContext* ctx, size_t index,
+                                                              const KeyType& key, page_id_t right_page_id) {
+    WritePageGuard& left = ctx->path[index];
+    if (index == 0) {
+        // Only a root is split without its parent on the path
+        uint16_t level = BPlusTreeNode(left.GetPage()).GetLevel() + 1;
+        page_id_t root_page_id = ctx->new_pages.back().first;
+        InternalPage root(ctx->new_pages.back().second);
+        ctx->new_pages.pop_back();
+        root.Init(root_page_id, level, internal_max_size_);
+        root.PopulateNewRoot(left.GetPageId(), key, right_page_id);
+        bpm_->UnpinPage(root_page_id, true);
+
+        BPlusTreeHeader* header = reinterpret_cast<BPlusTreeHeader*>(ctx->header.GetData());
+        header->root_page_id = root_page_id;
+        header->root_level = level;
+        return;
+    }
+
+    InternalPage parent(ctx->path[index - 1].GetPage());
+    page_id_t left_page_id = left.GetPageId();
+    bool split_first = parent.GetSize() > parent.MaxSizeWith(key);
+    if (!split_first) {
+        parent.InsertAfter(parent.IndexOf(left_page_id), key, right_page_id);
+        if (parent.GetSize() <= parent.GetMaxSize()) {
+            return;
+        }
+    }
+
+    page_id_t sibling_page_id = ctx->new_pages.back().first;
+    InternalPage sibling(ctx->new_pages.back().second);
+    ctx->new_pages.pop_back();
+    sibling.Init(sibling_page_id, parent.GetLevel(), internal_max_size_);
+    KeyType middle_key;
+    parent.MoveHalfTo(&sibling, &middle_key);
+    if (split_first) {
+        InternalPage& half = parent.IndexOf(left_page_id) < parent.GetSize() ? parent : sibling;
+        half.InsertAfter(half.IndexOf(left_page_id), key, right_page_id);
+    }
+    bpm_->UnpinPage(sibling_page_id, true);
+    InsertIntoParent(ctx, index - 1, middle_key, sibling_page_id);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndex<KeyType, KeyComparator>::HandleUnderflow(WriteContext* ctx, size_t index) {
+    InternalPage parent(ctx->path[index - 1].GetPage());
+    page_id_t page_id = ctx->path[index].GetPageId();
+    uint32_t node_index = parent.IndexOf(page_id);
+
+    // Latch the pair left to right, like scans do
+    bool node_is_left = node_index == 0;
+    uint32_t right_index = node_is_left ? 1 : node_index;
+    WritePageGuard left;
+    WritePageGuard right;
+    if (node_is_left) {
+        left = std::move(ctx->path[index]);
+        right = FetchWrite(parent.ChildAt(right_index));
+    } else {
+        ctx->path[index].Release();
+        left = FetchWrite(parent.ChildAt(right_index - 1));
+        right = FetchWrite(page_id);
+    }
+
+    BPlusTreeNode sibling(node_is_left ? right.GetPage() : left.GetPage());
+    bool is_leaf = sibling.IsLeaf();
+    if (!node_is_left && sibling.GetSize() > sibling.GetMinSize() && node_index + 1 < parent.GetSize()) {
+        // Borrowing from the left makes its last key the separator, which
+        // may lack the parent's shared prefix and not fit; borrow from the
+        // right then, whose separator lies between two of the parent's keys
+        uint32_t last = sibling.GetSize() - 1;
+        KeyType separator = is_leaf ? LeafPage::View(left.GetPage()).KeyAt(last)
+                                    : InternalPage::View(left.GetPage()).KeyAt(last);
+        if (!parent.CanSetKeyAt(right_index, separator)) {
+            left.Release();
+            left = std::move(right);
+            node_is_left = true;
+            right_index = node_index + 1;
+            right = FetchWrite(parent.ChildAt(right_index));
+            sibling = BPlusTreeNode(right.GetPage());
+        }
+    }
+    if (sibling.GetSize() > sibling.GetMinSize()) {
+        // Borrow one entry and move the separator in the parent
+        if (is_leaf) {
+            LeafPage left_leaf(left.GetPage());
+            LeafPage right_leaf(right.GetPage());
+            if (node_is_left) {
+                right_leaf.MoveFirstToEndOf(&left_leaf);
+            } else {
+                left_leaf.MoveLastToFrontOf(&right_leaf);
+            }
+            parent.SetKeyAt(right_index, right_leaf.KeyAt(0));
+        } else {
+            InternalPage left_node(left.GetPage());
+            InternalPage right_node(right.GetPage());
+            KeyType middle_key;
+            if (node_is_left) {
+                right_node.MoveFirstToEndOf(&left_node, parent.KeyAt(right_index), &middle_key);
+            } else {
+                left_node.MoveLastToFrontOf(&right_node, parent.KeyAt(right_index), &middle_key);
+            }
+            parent.SetKeyAt(right_index, middle_key);
+        }
+        return;
+    }
+
+    // Merge the right node into the left one
+    if (is_leaf) {
+        LeafPage right_leaf(right.GetPage());
+        LeafPage left_leaf(left.GetPage());
+        right_leaf.MoveAllTo(&left_leaf);
+    } else {
+        InternalPage right_node(right.GetPage());
+        InternalPage left_node(left.GetPage());
+        right_node.MoveAllTo(&left_node, parent.KeyAt(right_index));
+    }
+    parent.RemoveAt(right_index);
+    DeleteNode(&right);
+    left.Release();
+
+    if (index - 1 == 0) {
+        if (ctx->header.IsValid() && parent.GetSize() == 1) {
+            // The root is down to one child, which takes its place
+            BPlusTreeHeader* header = reinterpret_cast<BPlusTreeHeader*>(ctx->header.GetData());
+            header->root_page_id = parent.ChildAt(0);
+            header->root_level = parent.GetLevel() - 1;
+            DeleteNode(&ctx->path[0]);
+        }
+        return;
+    }
+    if (parent.GetSize() < parent.GetMinSize()) {
+        HandleUnderflow(ctx, index - 1);
+    }
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeIndex<KeyType, KeyComparator>::DeleteNode(WritePageGuard* guard) {
+    // Nobody else can reach the page any more: its parent (or the header)
+    // and its left sibling are write-latched by us
+    page_id_t page_id = guard->GetPageId();
+    guard->Release();
+    bpm_->DeletePage(page_id);
+}
+
+// Key types the tree is compiled for
+template class BPlusTreeIndexIterator<int32_t>;
+template class BPlusTreeIndexIterator<int64_t>;
+template class BPlusTreeIndexIterator<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>;
+template class BPlusTreeIndex<int32_t>;
+template class BPlusTreeIndex<int64_t>;
+template class BPlusTreeIndex<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>;
+
+}  // namespace logicmaze
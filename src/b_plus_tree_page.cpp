@@ -0,0 +1,391 @@
+#include "b_plus_tree_page.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+namespace logicmaze {
+
+void BPlusTreeNode::InitNode(page_id_t page_id, uint16_t level, uint32_t max_size) {
+    page_->Reset();
+    PageHeader* header = page_->GetHeader();
+    header->page_id = page_id;
+    header->page_type = PageType::INDEX;
+
+    BPlusTreeNodeHeader* node_header = GetNodeHeader();
+    node_header->level = level;
+    node_header->prefix_max_size = 0;
+    node_header->size = 0;
+    node_header->max_size = max_size;
+    node_header->next_page_id = INVALID_PAGE_ID;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+uint32_t BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::Search(const KeyType& key,
+                                                                                  uint32_t begin,
+                                                                                  uint32_t end,
+                                                                                  bool upper) const {
+    if constexpr (KeyPrefix::ENABLED) {
+        if (HasPrefix()) {
+            // Every key in range has the node's prefix
+            Prefix prefix = KeyPrefix::PrefixOf(key);
+            if (prefix < GetPrefix()) {
+                return begin;
+            }
+            if (GetPrefix() < prefix) {
+                return end;
+            }
+            const Suffix* suffixes = GetSuffixes();
+            Suffix suffix = KeyPrefix::SuffixOf(key);
+            const Suffix* it = upper ? std::upper_bound(suffixes + begin, suffixes + end, suffix)
+                                     : std::lower_bound(suffixes + begin, suffixes + end, suffix);
+            return static_cast<uint32_t>(it - suffixes);
+        }
+    }
+    const KeyType* keys = GetFullKeys();
+    const KeyType* it = upper ? std::upper_bound(keys + begin, keys + end, key, KeyComparator())
+                              : std::lower_bound(keys + begin, keys + end, key, KeyComparator());
+    return static_cast<uint32_t>(it - keys);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::SetKey(uint32_t index,
+                                                                              const KeyType& key) {
+    if (HasPrefix()) {
+        if (index < FIRST_KEY || SharesPrefix(key)) {
+            GetSuffixes()[index] = KeyPrefix::SuffixOf(key);
+            return;
+        }
+        Expand();
+    }
+    GetFullKeys()[index] = key;
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::InsertEntry(uint32_t index,
+                                                                                   const KeyType& key,
+                                                                                   const ValueType& value) {
+    ShiftRight(index);
+    SetKey(index, key);
+    SetValue(index, value);
+    if (GetSize() == FIRST_KEY + 1) {
+        Compact();
+    }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::CopyEntries(
+    const BPlusTreeEntryNode& source, uint32_t from, uint32_t to, uint32_t count) {
+    if (to == 0 && count == GetSize()) {
+        if (source.HasPrefix()) {
+            Prefix prefix = source.GetPrefix();
+            std::memcpy(page_->GetData() + PrefixLayout::PREFIX_OFFSET, &prefix, sizeof(prefix));
+            GetNodeHeader()->prefix_max_size = static_cast<uint16_t>(PrefixMaxSize());
+        } else {
+            GetNodeHeader()->prefix_max_size = 0;
+        }
+    }
+    if (HasPrefix() == source.HasPrefix() && (!HasPrefix() || GetPrefix() == source.GetPrefix())) {
+        if (HasPrefix()) {
+            std::memcpy(GetSuffixes() + to, source.GetSuffixes() + from, count * sizeof(Suffix));
+        } else {
+            std::memcpy(GetFullKeys() + to, source.GetFullKeys() + from, count * sizeof(KeyType));
+        }
+        std::memcpy(GetValues() + to, source.GetValues() + from, count * sizeof(ValueType));
+        return;
+    }
+    for (uint32_t i = 0; i < count; ++i) {
+        SetKey(to + i, source.KeyAt(from + i));
+        SetValue(to + i, source.ValueAt(from + i));
+    }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::ShiftRight(uint32_t index) {
+    uint32_t size = GetSize();
+    if (HasPrefix()) {
+        std::memmove(GetSuffixes() + index + 1, GetSuffixes() + index, (size - index) * sizeof(Suffix));
+    } else {
+        std::memmove(GetFullKeys() + index + 1, GetFullKeys() + index, (size - index) * sizeof(KeyType));
+    }
+    std::memmove(GetValues() + index + 1, GetValues() + index, (size - index) * sizeof(ValueType));
+    SetSize(size + 1);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::ShiftLeft(uint32_t index) {
+    uint32_t size = GetSize();
+    if (HasPrefix()) {
+        std::memmove(GetSuffixes() + index, GetSuffixes() + index + 1,
+                     (size - index - 1) * sizeof(Suffix));
+    } else {
+        std::memmove(GetFullKeys() + index, GetFullKeys() + index + 1,
+                     (size - index - 1) * sizeof(KeyType));
+    }
+    std::memmove(GetValues() + index, GetValues() + index + 1, (size - index - 1) * sizeof(ValueType));
+    SetSize(size - 1);
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::Compact() {
+    if constexpr (KeyPrefix::ENABLED) {
+        uint32_t size = GetSize();
+        if (HasPrefix() || size <= FIRST_KEY) {
+            return;
+        }
+        const KeyType* keys = GetFullKeys();
+        Prefix prefix = KeyPrefix::PrefixOf(keys[FIRST_KEY]);
+        for (uint32_t i = FIRST_KEY + 1; i < size; ++i) {
+            if (KeyPrefix::PrefixOf(keys[i]) != prefix) {
+                return;
+            }
+        }
+
+        // Rewrite the entries from a copy, the two layouts overlap
+        alignas(KeyType) alignas(ValueType) char copy[PAGE_DATA_SIZE];
+        std::memcpy(copy, page_->GetData(), PAGE_DATA_SIZE);
+        const KeyType* old_keys = reinterpret_cast<const KeyType*>(copy + FullLayout::KEYS_OFFSET);
+        const ValueType* old_values = reinterpret_cast<const ValueType*>(copy + FullLayout::VALUES_OFFSET);
+        std::memcpy(page_->GetData() + PrefixLayout::PREFIX_OFFSET, &prefix, sizeof(prefix));
+        GetNodeHeader()->prefix_max_size = static_cast<uint16_t>(PrefixMaxSize());
+        Suffix* suffixes = GetSuffixes();
+        for (uint32_t i = 0; i < size; ++i) {
+            suffixes[i] = KeyPrefix::SuffixOf(old_keys[i]);
+        }
+        std::memcpy(GetValues(), old_values, size * sizeof(ValueType));
+    }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+void BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::Expand() {
+    if constexpr (KeyPrefix::ENABLED) {
+        uint32_t size = GetSize();
+        if (size > CAPACITY) {
+            throw std::logic_error("B+ tree node entries do not fit with full keys");
+        }
+        alignas(Suffix) alignas(ValueType) char copy[PAGE_DATA_SIZE];
+        std::memcpy(copy, page_->GetData(), PAGE_DATA_SIZE);
+        const Suffix* old_suffixes = reinterpret_cast<const Suffix*>(copy + PrefixLayout::KEYS_OFFSET);
+        const ValueType* old_values = reinterpret_cast<const ValueType*>(copy + PrefixLayout::VALUES_OFFSET);
+        Prefix prefix = GetPrefix();
+        GetNodeHeader()->prefix_max_size = 0;
+        KeyType* keys = GetFullKeys();
+        for (uint32_t i = 0; i < size; ++i) {
+            keys[i] = KeyPrefix::Join(prefix, old_suffixes[i]);
+        }
+        std::memcpy(GetValues(), old_values, size * sizeof(ValueType));
+    }
+}
+
+template <typename KeyType, typename ValueType, typename KeyComparator, uint32_t FIRST_KEY>
+uint32_t BPlusTreeEntryNode<KeyType, ValueType, KeyComparator, FIRST_KEY>::PrefixMaxSize() const {
+    uint32_t max_size = GetFullMaxSize();
+    uint32_t prefix_max_size = std::min({(max_size + 1) * PREFIX_CAPACITY / CAPACITY - 1,
+                                         PREFIX_CAPACITY - 1, 2 * max_size - 3});
+    return std::max(max_size, prefix_max_size);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::Init(page_id_t page_id, uint32_t max_size) {
+    this->InitNode(page_id, 0, max_size);
+}
+
+template <typename KeyType, typename KeyComparator>
+uint32_t BPlusTreeLeafPage<KeyType, KeyComparator>::LowerBound(const KeyType& key) const {
+    return this->Search(key, 0, this->GetSize(), false);
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeLeafPage<KeyType, KeyComparator>::Lookup(const KeyType& key, RID* rid) const {
+    uint32_t index = LowerBound(key);
+    if (index == this->GetSize() || KeyComparator()(key, this->KeyAt(index))) {
+        return false;
+    }
+    *rid = this->ValueAt(index);
+    return true;
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeLeafPage<KeyType, KeyComparator>::Insert(const KeyType& key, const RID& rid) {
+    uint32_t index = LowerBound(key);
+    if (index < this->GetSize() && !KeyComparator()(key, this->KeyAt(index))) {
+        return false;
+    }
+    this->InsertEntry(index, key, rid);
+    return true;
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeLeafPage<KeyType, KeyComparator>::Remove(const KeyType& key) {
+    uint32_t index = LowerBound(key);
+    if (index == this->GetSize() || KeyComparator()(key, this->KeyAt(index))) {
+        return false;
+    }
+    this->ShiftLeft(index);
+    return true;
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::Append(const KeyType& key, const RID& rid) {
+    this->InsertEntry(this->GetSize(), key, rid);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::MoveHalfTo(BPlusTreeLeafPage* recipient) {
+    uint32_t keep = this->GetSize() / 2;
+    uint32_t moved = this->GetSize() - keep;
+    recipient->SetSize(moved);
+    recipient->CopyEntries(*this, keep, 0, moved);
+    this->SetSize(keep);
+    this->Compact();
+    recipient->Compact();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::MoveAllTo(BPlusTreeLeafPage* recipient) {
+    uint32_t end = recipient->GetSize();
+    recipient->SetSize(end + this->GetSize());
+    recipient->CopyEntries(*this, 0, end, this->GetSize());
+    recipient->SetNextPageId(GetNextPageId());
+    recipient->Compact();
+    this->SetSize(0);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::MoveFirstToEndOf(BPlusTreeLeafPage* recipient) {
+    recipient->Append(this->KeyAt(0), this->ValueAt(0));
+    this->ShiftLeft(0);
+    this->Compact();
+    recipient->Compact();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeLeafPage<KeyType, KeyComparator>::MoveLastToFrontOf(BPlusTreeLeafPage* recipient) {
+    uint32_t last = this->GetSize() - 1;
+    recipient->InsertEntry(0, this->KeyAt(last), this->ValueAt(last));
+    this->SetSize(last);
+    this->Compact();
+    recipient->Compact();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::Init(page_id_t page_id, uint16_t level,
+                                                         uint32_t max_size) {
+    this->InitNode(page_id, level, max_size);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::SetKeyAt(uint32_t index, const KeyType& key) {
+    this->SetKey(index, key);
+}
+
+template <typename KeyType, typename KeyComparator>
+bool BPlusTreeInternalPage<KeyType, KeyComparator>::CanSetKeyAt(uint32_t index, const KeyType& key) const {
+    return !this->HasPrefix() || index < 1 || this->SharesPrefix(key) ||
+           this->GetSize() <= this->GetFullMaxSize();
+}
+
+template <typename KeyType, typename KeyComparator>
+uint32_t BPlusTreeInternalPage<KeyType, KeyComparator>::ChildIndex(const KeyType& key) const {
+    // Last child whose smallest key is not above key
+    return this->Search(key, 1, this->GetSize(), true) - 1;
+}
+
+template <typename KeyType, typename KeyComparator>
+uint32_t BPlusTreeInternalPage<KeyType, KeyComparator>::IndexOf(page_id_t child) const {
+    uint32_t index = 0;
+    while (index < this->GetSize() && ChildAt(index) != child) {
+        index++;
+    }
+    return index;
+}
+
+template <typename KeyType, typename KeyComparator>
+uint32_t BPlusTreeInternalPage<KeyType, KeyComparator>::MaxSizeAfterSplitOf(uint32_t child_index) const {
+    if (this->HasPrefix() && child_index >= 1 && child_index + 1 < this->GetSize()) {
+        return this->GetMaxSize();
+    }
+    return this->GetFullMaxSize();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::PopulateNewRoot(page_id_t left, const KeyType& key,
+                                                                    page_id_t right) {
+    this->InsertEntry(0, KeyType(), left);
+    this->InsertEntry(1, key, right);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::InsertAfter(uint32_t index, const KeyType& key,
+                                                                page_id_t child) {
+    this->InsertEntry(index + 1, key, child);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::RemoveAt(uint32_t index) {
+    this->ShiftLeft(index);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::Append(const KeyType& key, page_id_t child) {
+    this->InsertEntry(this->GetSize(), key, child);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::MoveHalfTo(BPlusTreeInternalPage* recipient,
+                                                               KeyType* middle_key) {
+    uint32_t keep = (this->GetSize() + 1) / 2;
+    uint32_t moved = this->GetSize() - keep;
+    *middle_key = this->KeyAt(keep);
+    recipient->SetSize(moved);
+    recipient->CopyEntries(*this, keep, 0, moved);
+    this->SetSize(keep);
+    this->Compact();
+    recipient->Compact();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::MoveAllTo(BPlusTreeInternalPage* recipient,
+                                                              const KeyType& middle_key) {
+    uint32_t end = recipient->GetSize();
+    recipient->SetSize(end + this->GetSize());
+    recipient->CopyEntries(*this, 0, end, this->GetSize());
+    recipient->SetKeyAt(end, middle_key);
+    recipient->Compact();
+    this->SetSize(0);
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::MoveFirstToEndOf(BPlusTreeInternalPage* recipient,
+                                                                     const KeyType& middle_key,
+                                                                     KeyType* new_middle_key) {
+    recipient->Append(middle_key, ChildAt(0));
+    *new_middle_key = this->KeyAt(1);
+    RemoveAt(0);
+    this->Compact();
+    recipient->Compact();
+}
+
+template <typename KeyType, typename KeyComparator>
+void BPlusTreeInternalPage<KeyType, KeyComparator>::MoveLastToFrontOf(BPlusTreeInternalPage* recipient,
+                                                                      const KeyType& middle_key,
+                                                                      KeyType* new_middle_key) {
+    uint32_t last = this->GetSize() - 1;
+    recipient->ShiftRight(0);
+    recipient->SetKeyAt(1, middle_key);
+    recipient->SetKeyAt(0, KeyType());
+    recipient->SetValue(0, ChildAt(last));
+    *new_middle_key = this->KeyAt(last);
+    this->SetSize(last);
+    this->Compact();
+    recipient->Compact();
+}
+
+// Key types the tree is compiled for
+template class BPlusTreeLeafPage<int32_t>;
+template class BPlusTreeLeafPage<int64_t>;
+template class BPlusTreeLeafPage<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>;
+template class BPlusTreeInternalPage<int32_t>;
+template class BPlusTreeInternalPage<int64_t>;
+template class BPlusTreeInternalPage<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>;
+
+}  // namespace logicmaze
@@ -1,84 +1,169 @@
 #include "buffer_pool_manager.h"
+#include "lru_replacer.h"
+#include "clock_replacer.h"
+#include "lru_k_replacer.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <exception>
+#include <fstream>
 #include <iostream>
+#include <stdexcept>
 
 namespace logicmaze {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager)
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager* disk_manager,
+                                     const BufferPoolOptions& options)
     : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, options.max_pool_size)),
+      arena_(max_pool_size_, options.huge_pages),
+      pages_(arena_.GetFrames()),
       disk_manager_(disk_manager),
+      log_manager_(options.log_manager),
+      frames_(max_pool_size_),
+      page_table_(2 * max_pool_size_),  // A frame under write-back maps two pages
+      read_ahead_limit_(options.read_ahead_pages),
+      read_ahead_pages_(std::min(options.read_ahead_pages, pool_size / 4)),
+      last_fetch_page_id_(INVALID_PAGE_ID),
+      sequential_run_(0),
+      read_ahead_end_(0),
+      prefetch_in_flight_(0),
+      cleaner_lru_depth_(options.cleaner_lru_depth),
+      cleaner_dirty_ratio_high_(options.cleaner_dirty_ratio_high),
+      cleaner_dirty_ratio_low_(options.cleaner_dirty_ratio_low),
+      cleaner_flushing_(false),
+      cleaner_stop_(false),
+      frames_cleaning_(0),
       hit_count_(0),
-      miss_count_(0) {
+      miss_count_(0),
+      prefetch_count_(0),
+      warm_up_file_(options.warm_up_file),
+      foreground_write_count_(0),
+      background_write_count_(0) {
     
-    // Allocate page array
-    pages_ = new Page[pool_size_];
+    if (options.cleaner_dirty_ratio_low > options.cleaner_dirty_ratio_high) {
+        throw std::invalid_argument("Cleaner low dirty ratio is above the high one");
+    }
     
-    // Create LRU replacer
-    replacer_ = new LRUReplacer(pool_size_);
+    // Create replacer
+    switch (options.replacer_type) {
+        case ReplacerType::CLOCK:
+            replacer_ = new ClockReplacer(max_pool_size_);
+            break;
+        case ReplacerType::LRU_K:
+            replacer_ = new LRUKReplacer(max_pool_size_, options.lru_k,
+                                         options.correlated_reference_period);
+            break;
+        case ReplacerType::LRU:
+        default:
+            replacer_ = new LRUReplacer(max_pool_size_);
+            break;
+    }
     
     // Initialize free list with all frames
-    free_list_.reserve(pool_size_);
-    for (size_t i = 0; i < pool_size_; ++i) {
+    free_list_.reserve(max_pool_size_);
+    for (size_t i = 0; i < pool_size; ++i) {
         free_list_.push_back(static_cast<frame_id_t>(i));
     }
+
+    if (options.enable_page_cleaner) {
+        cleaner_ = std::thread([this]() { CleanerLoop(); });
+    }
+
+    if (!warm_up_file_.empty()) {
+        RestoreResidentPages(warm_up_file_);
+    }
 }
 
 BufferPoolManager::~BufferPoolManager() {
+    if (cleaner_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(latch_);
+            cleaner_stop_ = true;
+        }
+        cleaner_cv_.notify_all();
+        cleaner_.join();
+    }
+
+
+    // Prefetch completions still reference the frames
+    {
+        std::unique_lock<std::mutex> lock(latch_);
+        io_cv_.wait(lock, [this]() { return prefetch_in_flight_ == 0; });
+    }
+
+    if (!warm_up_file_.empty()) {
+        try {
+            DumpResidentPages(warm_up_file_);
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+    }
     FlushAllPages();
-    delete[] pages_;
     delete replacer_;
 }
 
 Page* BufferPoolManager::FetchPage(page_id_t page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock<std::mutex> lock(latch_);
+
+    sequential_run_ = (page_id == last_fetch_page_id_ + 1) ? sequential_run_ + 1 : 1;
+    last_fetch_page_id_ = page_id;
+    if (sequential_run_ == 1) {
+        // The window of an earlier run does not cover a new one, which may
+        // start anywhere, including below it
+        read_ahead_end_ = 0;
+    }
 
     // Check if page is already in buffer pool
-    auto it = page_table_.find(page_id);
-    if (it != page_table_.end()) {
+    frame_id_t frame_id = FindResidentFrame(page_id, lock);
+    if (frame_id != INVALID_FRAME_ID) {
         // Cache hit
-        frame_id_t frame_id = it->second;
-        pin_count_[frame_id]++;
+        FrameDescriptor& frame = frames_[frame_id];
+        if (frame.prefetched) {
+            // The first real reference replaces the one the prefetch
+            // recorded when it reserved the frame, or a scan read ahead
+            // would look like reuse to LRU-K
+            frame.prefetched = false;
+            replacer_->Remove(frame_id);
+        }
+        frame.pin_count++;
         replacer_->Pin(frame_id);
         hit_count_++;
+        ReadAhead(page_id, lock);
         return &pages_[frame_id];
     }
 
     // Cache miss - need to fetch from disk
     miss_count_++;
 
-    // Get a free frame
-    frame_id_t frame_id = GetVictimFrame();
+    // Reserve a frame for the page (writing back its old page if needed)
+    frame_id = AcquireFrame(page_id, lock);
     if (frame_id == INVALID_FRAME_ID) {
         return nullptr;  // No available frames
     }
 
-    // If frame was occupied, flush if dirty
-    auto frame_it = frame_table_.find(frame_id);
-    if (frame_it != frame_table_.end()) {
-        page_id_t old_page_id = frame_it->second;
-        
-        // Flush if dirty
-        if (dirty_[frame_id]) {
-            // Update checksum before writing
-            pages_[frame_id].UpdateChecksum();
-            disk_manager_->WritePage(old_page_id, &pages_[frame_id]);
-        }
-        
-        // Remove old page from page table
-        page_table_.erase(old_page_id);
+    // Start read-ahead first so it overlaps with our own read
+    ReadAhead(page_id, lock);
+
+    // Read page from disk without holding the pool latch; concurrent
+    // fetches of this page wait on io_pending instead of reading it again
+    lock.unlock();
+    try {
+        disk_manager_->ReadPage(page_id, &pages_[frame_id]);
+    } catch (...) {
+        lock.lock();
+        page_table_.Erase(page_id);
+        frames_[frame_id].Reset();
+        replacer_->Remove(frame_id);
+        ReleaseFrame(frame_id);  // Don't leak the frame
+        io_cv_.notify_all();
+        throw;
     }
 
-    // Read page from disk
-    disk_manager_->ReadPage(page_id, &pages_[frame_id]);
-    
-    // Update checksum after reading
-    pages_[frame_id].UpdateChecksum();
-
-    // Update tables
-    page_table_[page_id] = frame_id;
-    frame_table_[frame_id] = page_id;
-    pin_count_[frame_id] = 1;
-    dirty_[frame_id] = false;
-    replacer_->Pin(frame_id);
+    lock.lock();
+    frames_[frame_id].io_pending = false;
+    io_cv_.notify_all();
 
     return &pages_[frame_id];
 }
@@ -86,136 +171,240 @@ Page* BufferPoolManager::FetchPage(page_id_t page_id) {
 bool BufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
     std::lock_guard<std::mutex> lock(latch_);
 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    frame_id_t frame_id = page_table_.Find(page_id);
+    if (frame_id == INVALID_FRAME_ID || frames_[frame_id].page_id != page_id) {
         return false;  // Page not in buffer pool
     }
 
-    frame_id_t frame_id = it->second;
+    FrameDescriptor& frame = frames_[frame_id];
 
-    if (pin_count_[frame_id] <= 0) {
+    if (frame.pin_count <= 0) {
         return false;  // Already unpinned
     }
 
-    pin_count_[frame_id]--;
+    frame.pin_count--;
 
     // Update dirty flag
     if (is_dirty) {
-        dirty_[frame_id] = true;
+        frame.is_dirty = true;
     }
 
     // If pin count reaches 0, make it evictable
-    if (pin_count_[frame_id] == 0) {
-        replacer_->Unpin(frame_id);
+    if (frame.pin_count == 0) {
+        MakeEvictable(frame_id);
     }
 
     return true;
 }
 
 bool BufferPoolManager::FlushPage(page_id_t page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock<std::mutex> lock(latch_);
 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    frame_id_t frame_id = FindIdleFrame(page_id, lock);
+    if (frame_id == INVALID_FRAME_ID) {
         return false;  // Page not in buffer pool
     }
 
-    frame_id_t frame_id = it->second;
-    
-    // Update checksum before writing
-    pages_[frame_id].UpdateChecksum();
-    
-    disk_manager_->WritePage(page_id, &pages_[frame_id]);
-    dirty_[frame_id] = false;
+    // An unpinned clean page already matches its disk copy; a pinned one
+    // may have changes its user has not reported through UnpinPage yet
+    FrameDescriptor& frame = frames_[frame_id];
+    if (frame.pin_count > 0) {
+        // A page guard may be changing the page: write a copy taken under
+        // the frame latch instead of bytes that may be torn
+        std::vector<frame_id_t> frame_ids{frame_id};
+        std::vector<Page> copies(1);
+        CopyPinnedPages(frame_ids, &copies, lock);
+        try {
+            FlushLogUntil(copies[0].GetLSN());
+            copies[0].UpdateChecksum();
+            disk_manager_->WritePage(page_id, &copies[0]);
+        } catch (...) {
+            UnpinCopiedFrames(frame_ids);
+            throw;
+        }
+        // The frame stays dirty with its old recovery LSN: a change logged
+        // before the copy may still be on its way into the page
+        UnpinCopiedFrames(frame_ids);
+    } else if (frame.is_dirty) {
+        // Nobody can change an unpinned page while latch_ is held
+        lsn_t rec_lsn = CurrentLSN();
+        // Checksums are computed on write-back only
+        FlushLogUntil(pages_[frame_id].GetLSN());
+        pages_[frame_id].UpdateChecksum();
+        disk_manager_->WritePage(page_id, &pages_[frame_id]);
+        frame.is_dirty = false;
+        frame.rec_lsn = rec_lsn;
+    }
+    disk_manager_->Flush();
 
     return true;
 }
 
 void BufferPoolManager::FlushAllPages() {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock<std::mutex> lock(latch_);
 
-    for (auto& entry : page_table_) {
-        page_id_t page_id = entry.first;
-        frame_id_t frame_id = entry.second;
-        
-        if (dirty_[frame_id]) {
-            // Update checksum before writing
-            pages_[frame_id].UpdateChecksum();
-            
-            disk_manager_->WritePage(page_id, &pages_[frame_id]);
-            dirty_[frame_id] = false;
+    // Pinned pages may be in the middle of a change, which need not be
+    // reported as dirty yet (the same rule as FlushPage): copy them all
+    // under their frame latches first (which drops latch_ for a while)
+    std::vector<frame_id_t> pinned_frames;
+    lsn_t rec_lsn = CurrentLSN();
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+        const FrameDescriptor& frame = frames_[i];
+        if (frame.page_id != INVALID_PAGE_ID && !frame.io_pending && frame.pin_count > 0) {
+            pinned_frames.push_back(static_cast<frame_id_t>(i));
+        }
+    }
+    std::vector<Page> copies(pinned_frames.size());
+    CopyPinnedPages(pinned_frames, &copies, lock);
+
+    std::vector<std::pair<page_id_t, const Page*>> dirty_pages;
+    std::vector<frame_id_t> dirty_frames;
+    lsn_t max_lsn = INVALID_LSN;
+    try {
+        // An older copy still being written by the cleaner must not land
+        // after ours
+        io_cv_.wait(lock, [this]() { return frames_cleaning_ == 0; });
+
+        // Pinned frames are written but stay dirty with their old recovery
+        // LSNs, like in FlushPage
+        for (size_t i = 0; i < pinned_frames.size(); ++i) {
+            copies[i].UpdateChecksum();
+            dirty_pages.emplace_back(frames_[pinned_frames[i]].page_id, &copies[i]);
+            max_lsn = std::max(max_lsn, copies[i].GetLSN());
+        }
+        // All frames: ones a shrinking Resize is retiring may still be dirty
+        for (size_t i = 0; i < max_pool_size_; ++i) {
+            FrameDescriptor& frame = frames_[i];
+
+            // Frames with I/O in flight are owned by the thread doing it;
+            // nobody can change an unpinned one while latch_ is held
+            if (frame.page_id != INVALID_PAGE_ID && frame.is_dirty && !frame.io_pending &&
+                frame.pin_count == 0) {
+                // Update checksum before writing
+                pages_[i].UpdateChecksum();
+                dirty_pages.emplace_back(frame.page_id, &pages_[i]);
+                dirty_frames.push_back(static_cast<frame_id_t>(i));
+                max_lsn = std::max(max_lsn, pages_[i].GetLSN());
+            }
+        }
+
+        if (!dirty_pages.empty()) {
+            // One log flush, one coalesced batch and a single sync for the whole group
+            FlushLogUntil(max_lsn);
+            disk_manager_->WritePages(dirty_pages);
+            disk_manager_->Flush();
+        }
+    } catch (...) {
+        UnpinCopiedFrames(pinned_frames);
+        throw;
+    }
+    UnpinCopiedFrames(pinned_frames);
+
+    for (frame_id_t frame_id : dirty_frames) {
+        frames_[frame_id].is_dirty = false;
+        frames_[frame_id].rec_lsn = rec_lsn;
+    }
+}
+
+void BufferPoolManager::CopyPinnedPages(const std::vector<frame_id_t>& frame_ids,
+                                        std::vector<Page>* copies,
+                                        std::unique_lock<std::mutex>& lock) {
+    if (frame_ids.empty()) {
+        return;
+    }
+    // Our own pins keep the pages in their frames. The frame latch is
+    // taken without latch_, which page guard holders may be waiting for.
+    for (frame_id_t frame_id : frame_ids) {
+        frames_[frame_id].pin_count++;
+    }
+    lock.unlock();
+    for (size_t i = 0; i < frame_ids.size(); ++i) {
+        std::shared_lock<std::shared_mutex> frame_latch(frames_[frame_ids[i]].latch);
+        std::memcpy((*copies)[i].GetRawData(), pages_[frame_ids[i]].GetRawData(), PAGE_SIZE);
+    }
+    lock.lock();
+}
+
+void BufferPoolManager::UnpinCopiedFrames(const std::vector<frame_id_t>& frame_ids) {
+    for (frame_id_t frame_id : frame_ids) {
+        if (--frames_[frame_id].pin_count == 0) {
+            MakeEvictable(frame_id);
         }
     }
 }
 
 Page* BufferPoolManager::NewPage(page_id_t* page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock<std::mutex> lock(latch_);
 
-    // Get a free frame
-    frame_id_t frame_id = GetVictimFrame();
-    if (frame_id == INVALID_FRAME_ID) {
+    // Allocate new page on disk
+    page_id_t new_page_id = disk_manager_->AllocatePage();
+
+    Page* page = InstallNewPage(new_page_id, lock);
+    if (page == nullptr) {
+        disk_manager_->DeallocatePage(new_page_id);
         return nullptr;  // No available frames
     }
 
-    // If frame was occupied, flush if dirty
-    auto frame_it = frame_table_.find(frame_id);
-    if (frame_it != frame_table_.end()) {
-        page_id_t old_page_id = frame_it->second;
-        
-        if (dirty_[frame_id]) {
-            disk_manager_->WritePage(old_page_id, &pages_[frame_id]);
+    *page_id = new_page_id;
+    return page;
+}
+
+page_id_t BufferPoolManager::AllocatePages(size_t count) {
+    std::lock_guard<std::mutex> lock(latch_);
+    return disk_manager_->AllocatePages(count);
+}
+
+Page* BufferPoolManager::NewPageWithId(page_id_t page_id) {
+    std::unique_lock<std::mutex> lock(latch_);
+    return InstallNewPage(page_id, lock);
+}
+
+Page* BufferPoolManager::InstallNewPage(page_id_t page_id, std::unique_lock<std::mutex>& lock) {
+    // The id was free on disk, but read-ahead past the end of a run of
+    // pages can have left a copy of it in a frame; drop that copy, or the
+    // page would be mapped to two frames
+    frame_id_t stale_frame_id = FindIdleFrame(page_id, lock);
+    if (stale_frame_id != INVALID_FRAME_ID) {
+        if (frames_[stale_frame_id].pin_count > 0) {
+            throw std::logic_error("Free page " + std::to_string(page_id) + " is pinned");
         }
-        
-        page_table_.erase(old_page_id);
+        DiscardFrame(stale_frame_id);
     }
 
-    // Allocate new page on disk
-    *page_id = disk_manager_->AllocatePage();
+    frame_id_t frame_id = AcquireFrame(page_id, lock);
+    if (frame_id == INVALID_FRAME_ID) {
+        return nullptr;
+    }
 
     // Reset page
     pages_[frame_id].Reset();
     PageHeader* header = pages_[frame_id].GetHeader();
-    header->page_id = *page_id;
+    header->page_id = page_id;
     header->page_type = PageType::DATA;
-    
-    // Update checksum for new page
-    pages_[frame_id].UpdateChecksum();
-
-    // Update tables
-    page_table_[*page_id] = frame_id;
-    frame_table_[frame_id] = *page_id;
-    pin_count_[frame_id] = 1;
-    dirty_[frame_id] = true;  // New page is dirty
-    replacer_->Pin(frame_id);
+
+    frames_[frame_id].is_dirty = true;  // New page is dirty
+    frames_[frame_id].io_pending = false;
+    io_cv_.notify_all();
 
     return &pages_[frame_id];
 }
 
 bool BufferPoolManager::DeletePage(page_id_t page_id) {
-    std::lock_guard<std::mutex> lock(latch_);
+    std::unique_lock<std::mutex> lock(latch_);
 
-    auto it = page_table_.find(page_id);
-    if (it == page_table_.end()) {
+    frame_id_t frame_id = FindIdleFrame(page_id, lock);
+    if (frame_id == INVALID_FRAME_ID) {
         // Page not in buffer pool, just deallocate on disk
         disk_manager_->DeallocatePage(page_id);
         return true;
     }
 
-    frame_id_t frame_id = it->second;
-
     // Cannot delete pinned page
-    if (pin_count_[frame_id] > 0) {
+    if (frames_[frame_id].pin_count > 0) {
         return false;
     }
 
-    // Remove from tables
-    page_table_.erase(page_id);
-    frame_table_.erase(frame_id);
-    dirty_.erase(frame_id);
-    pin_count_.erase(frame_id);
-
-    // Add frame back to free list
-    free_list_.push_back(frame_id);
+    DiscardFrame(frame_id);
 
     // Deallocate on disk
     disk_manager_->DeallocatePage(page_id);
@@ -223,6 +412,487 @@ bool BufferPoolManager::DeletePage(page_id_t page_id) {
     return true;
 }
 
+size_t BufferPoolManager::Prefetch(page_id_t first, size_t count) {
+    std::unique_lock<std::mutex> lock(latch_);
+    return StartPrefetch(first, count, lock);
+}
+
+size_t BufferPoolManager::StartPrefetch(page_id_t first, size_t count,
+                                        std::unique_lock<std::mutex>& lock) {
+    page_id_t num_pages = disk_manager_->GetNumPages();
+    if (first >= num_pages) {
+        return 0;
+    }
+    count = std::min<size_t>(count, num_pages - first);
+
+    // Reserve frames under the latch; each stays pinned and io_pending, so
+    // fetches of the page wait for the read instead of issuing their own
+    std::vector<std::pair<page_id_t, frame_id_t>> reads;
+    for (page_id_t page_id = first; page_id < first + count; ++page_id) {
+        if (page_table_.Find(page_id) != INVALID_FRAME_ID) {
+            continue;  // Resident or already on its way in
+        }
+
+        frame_id_t frame_id;
+        try {
+            frame_id = AcquireFrame(page_id, lock);
+        } catch (...) {
+            break;  // Write-back of the victim failed, it is only a hint
+        }
+        if (frame_id == INVALID_FRAME_ID) {
+            break;  // Everything else is pinned
+        }
+        reads.emplace_back(page_id, frame_id);
+        prefetch_in_flight_++;
+    }
+
+    if (reads.empty()) {
+        return 0;
+    }
+
+    // Submit without latch_: completions take it, and submission may
+    // block while the I/O queue is full
+    lock.unlock();
+    for (const auto& read : reads) {
+        page_id_t page_id = read.first;
+        frame_id_t frame_id = read.second;
+        try {
+            disk_manager_->ReadPageAsync(page_id, &pages_[frame_id], [this, page_id, frame_id](bool ok) {
+                CompletePrefetch(page_id, frame_id, ok);
+            });
+        } catch (...) {
+            CompletePrefetch(page_id, frame_id, false);
+        }
+    }
+    lock.lock();
+
+    return reads.size();
+}
+
+void BufferPoolManager::CompletePrefetch(page_id_t page_id, frame_id_t frame_id, bool ok) {
+    std::lock_guard<std::mutex> lock(latch_);
+    FrameDescriptor& frame = frames_[frame_id];
+    if (ok) {
+        // Nobody else can pin a frame while io_pending is set, so dropping
+        // the reservation pin leaves the page unpinned and evictable
+        frame.io_pending = false;
+        frame.pin_count = 0;
+        frame.prefetched = true;
+        MakeEvictable(frame_id);
+        prefetch_count_++;
+    } else {
+        page_table_.Erase(page_id);
+        frame.Reset();
+        replacer_->Remove(frame_id);
+        ReleaseFrame(frame_id);
+    }
+    prefetch_in_flight_--;
+    io_cv_.notify_all();
+}
+
+void BufferPoolManager::ReadAhead(page_id_t page_id, std::unique_lock<std::mutex>& lock) {
+    if (read_ahead_pages_ == 0 || sequential_run_ < READ_AHEAD_TRIGGER) {
+        return;
+    }
+
+    // Top the window up once the scan has used half of it, so reads of the
+    // next batch are in flight while the current one is consumed
+    if (read_ahead_end_ > page_id && read_ahead_end_ - page_id > read_ahead_pages_ / 2) {
+        return;
+    }
+    // The window stops at the end of the file; computed wide, so it cannot
+    // wrap around near INVALID_PAGE_ID
+    page_id_t window_end = static_cast<page_id_t>(std::min<uint64_t>(
+        static_cast<uint64_t>(page_id) + 1 + read_ahead_pages_, disk_manager_->GetNumPages()));
+    if (window_end <= page_id) {
+        return;
+    }
+    page_id_t start = std::max(page_id + 1, read_ahead_end_);
+    read_ahead_end_ = window_end;
+    if (start < window_end) {
+        StartPrefetch(start, window_end - start, lock);
+    }
+}
+
+void BufferPoolManager::CleanerLoop() {
+    std::vector<frame_id_t> candidates;
+    std::vector<Page> copies(CLEANER_BATCH_PAGES);
+
+    std::unique_lock<std::mutex> lock(latch_);
+    while (!cleaner_stop_) {
+        // The dirty ratio decides how far from the cold end to look
+        size_t dirty = 0;
+        for (const FrameDescriptor& frame : frames_) {
+            dirty += frame.is_dirty ? 1 : 0;
+        }
+        double dirty_ratio = static_cast<double>(dirty) / pool_size_;
+        if (dirty_ratio > cleaner_dirty_ratio_high_) {
+            cleaner_flushing_ = true;
+        } else if (dirty_ratio <= cleaner_dirty_ratio_low_) {
+            cleaner_flushing_ = false;
+        }
+        replacer_->ColdestFrames(cleaner_flushing_ ? pool_size_.load() : cleaner_lru_depth_, &candidates);
+
+        size_t position = 0;
+        size_t written;
+        try {
+            written = WriteBackCopies(candidates, &position, &copies, lock);
+        } catch (...) {
+            written = 0;  // Try again next round
+        }
+
+        if (written == 0) {
+            cleaner_cv_.wait_for(lock, std::chrono::milliseconds(CLEANER_INTERVAL_MS));
+            continue;
+        }
+        background_write_count_ += written;
+    }
+}
+
+size_t BufferPoolManager::WriteBackCopies(const std::vector<frame_id_t>& candidates,
+                                          size_t* position, std::vector<Page>* copies,
+                                          std::unique_lock<std::mutex>& lock) {
+    std::vector<std::pair<page_id_t, const Page*>> batch;
+    std::vector<frame_id_t> batch_frames;
+    lsn_t max_lsn = INVALID_LSN;
+    // Changes logged before this are in the copies
+    lsn_t rec_lsn = CurrentLSN();
+
+    for (; *position < candidates.size() && batch.size() < copies->size(); ++*position) {
+        frame_id_t frame_id = candidates[*position];
+        FrameDescriptor& frame = frames_[frame_id];
+        if (!frame.is_dirty || frame.pin_count > 0 || frame.io_pending || frame.cleaning) {
+            continue;
+        }
+
+        // Write a copy, so the page can be pinned and changed again
+        // while the write is in flight
+        Page& copy = (*copies)[batch.size()];
+        std::memcpy(copy.GetRawData(), pages_[frame_id].GetRawData(), PAGE_SIZE);
+        copy.UpdateChecksum();
+        max_lsn = std::max(max_lsn, copy.GetLSN());
+        frame.is_dirty = false;
+        frame.cleaning = true;
+        batch.emplace_back(frame.page_id, &copy);
+        batch_frames.push_back(frame_id);
+    }
+
+    if (batch.empty()) {
+        return 0;
+    }
+
+    frames_cleaning_ += batch.size();
+    lock.unlock();
+    std::exception_ptr error;
+    try {
+        FlushLogUntil(max_lsn);
+        disk_manager_->WritePages(batch);
+    } catch (...) {
+        error = std::current_exception();
+    }
+    lock.lock();
+
+    for (frame_id_t frame_id : batch_frames) {
+        FrameDescriptor& frame = frames_[frame_id];
+        frame.cleaning = false;
+        if (error) {
+            frame.is_dirty = true;  // Still needs writing
+        } else {
+            frame.rec_lsn = rec_lsn;
+        }
+    }
+    frames_cleaning_ -= batch.size();
+    io_cv_.notify_all();
+
+    if (error) {
+        std::rethrow_exception(error);
+    }
+    return batch.size();
+}
+
+size_t BufferPoolManager::Checkpoint() {
+    if (log_manager_ == nullptr) {
+        throw std::logic_error("Checkpoint needs a buffer pool with a log manager");
+    }
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+
+    // From here on the first change to a page logs all of it, so redo from
+    // this checkpoint can repair pages torn by a later write
+    lsn_t start_lsn = log_manager_->GetNextLSN();
+    log_manager_->SetFullPageImageLSN(start_lsn);
+
+    size_t written = CheckpointWriteBack();
+    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+    lsn_t redo_lsn = std::min(start_lsn, SnapshotDirtyPages(&dirty_pages));
+
+    // The pages written so far must be durable before the log says so
+    disk_manager_->Flush();
+    lsn_t checkpoint_lsn = log_manager_->LogCheckpoint(redo_lsn, dirty_pages);
+    disk_manager_->SetCheckpoint(checkpoint_lsn, redo_lsn);
+    disk_manager_->Flush();
+    return written;
+}
+
+size_t BufferPoolManager::CheckpointWriteBack() {
+    std::vector<frame_id_t> candidates;
+    std::vector<Page> copies(CLEANER_BATCH_PAGES);
+
+    std::unique_lock<std::mutex> lock(latch_);
+    // All frames: ones a shrinking Resize is retiring may still be dirty
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+        if (frames_[i].page_id != INVALID_PAGE_ID && frames_[i].is_dirty) {
+            candidates.push_back(static_cast<frame_id_t>(i));
+        }
+    }
+
+    // Pinned or busy frames are skipped; the snapshot keeps them in the
+    // dirty page table instead
+    size_t written = 0;
+    size_t position = 0;
+    while (position < candidates.size()) {
+        written += WriteBackCopies(candidates, &position, &copies, lock);
+    }
+    return written;
+}
+
+lsn_t BufferPoolManager::SnapshotDirtyPages(std::vector<std::pair<page_id_t, lsn_t>>* dirty_pages) const {
+    std::lock_guard<std::mutex> lock(latch_);
+
+    lsn_t redo_lsn = CurrentLSN();
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+        const FrameDescriptor& frame = frames_[i];
+        if (frame.page_id == INVALID_PAGE_ID) {
+            continue;
+        }
+        // A pinned page may have logged changes not reported as dirty yet,
+        // and a frame with I/O in flight may still hold an unwritten page
+        if (frame.is_dirty || frame.pin_count > 0 || frame.io_pending || frame.cleaning) {
+            dirty_pages->emplace_back(frame.page_id, frame.rec_lsn);
+            redo_lsn = std::min(redo_lsn, frame.rec_lsn);
+        }
+    }
+    return redo_lsn;
+}
+
+void BufferPoolManager::FlushLogUntil(lsn_t lsn) {
+    if (log_manager_ != nullptr && lsn != INVALID_LSN) {
+        log_manager_->FlushUntil(lsn);
+    }
+}
+
+ReadPageGuard BufferPoolManager::FetchPageRead(page_id_t page_id) {
+    Page* page = FetchPage(page_id);
+    if (page == nullptr) {
+        return ReadPageGuard();
+    }
+
+    // Latch outside latch_ so waiting on a busy page never blocks the pool
+    std::shared_mutex* latch = &frames_[page - pages_].latch;
+    latch->lock_shared();
+    return ReadPageGuard(this, page, page_id, latch);
+}
+
+WritePageGuard BufferPoolManager::FetchPageWrite(page_id_t page_id) {
+    Page* page = FetchPage(page_id);
+    if (page == nullptr) {
+        return WritePageGuard();
+    }
+
+    std::shared_mutex* latch = &frames_[page - pages_].latch;
+    latch->lock();
+    return WritePageGuard(this, page, page_id, latch);
+}
+
+namespace {
+
+constexpr uint32_t WARM_UP_MAGIC = 0x4C4D5755;  // "LMWU"
+constexpr uint32_t WARM_UP_VERSION = 1;
+
+}  // namespace
+
+void BufferPoolManager::DumpResidentPages(const std::string& path) const {
+    std::vector<page_id_t> page_ids;
+    {
+        std::lock_guard<std::mutex> lock(latch_);
+
+        // Pinned pages are in use right now, the hottest of all
+        for (size_t i = 0; i < pool_size_; ++i) {
+            const FrameDescriptor& frame = frames_[i];
+            if (frame.page_id != INVALID_PAGE_ID && frame.pin_count > 0 && !frame.io_pending) {
+                page_ids.push_back(frame.page_id);
+            }
+        }
+
+        std::vector<frame_id_t> coldest;
+        replacer_->ColdestFrames(pool_size_, &coldest);
+        for (auto it = coldest.rbegin(); it != coldest.rend(); ++it) {
+            const FrameDescriptor& frame = frames_[*it];
+            if (frame.page_id != INVALID_PAGE_ID && !frame.io_pending) {
+                page_ids.push_back(frame.page_id);
+            }
+        }
+    }
+
+    // Write a temporary file and rename it, so a crash mid-dump leaves the
+    // previous list intact
+    std::string temp_path = path + ".tmp";
+    {
+        std::ofstream out(temp_path, std::ios::binary | std::ios::trunc);
+        uint32_t header[3] = {WARM_UP_MAGIC, WARM_UP_VERSION, static_cast<uint32_t>(page_ids.size())};
+        out.write(reinterpret_cast<const char*>(header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(page_ids.data()), page_ids.size() * sizeof(page_id_t));
+        if (!out) {
+            throw std::runtime_error("Failed to write warm-up file: " + temp_path);
+        }
+    }
+    if (std::rename(temp_path.c_str(), path.c_str()) != 0) {
+        throw std::runtime_error("Failed to replace warm-up file: " + path);
+    }
+}
+
+size_t BufferPoolManager::RestoreResidentPages(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return 0;  // Nothing dumped yet
+    }
+
+    uint32_t header[3];
+    in.read(reinterpret_cast<char*>(header), sizeof(header));
+    if (!in || header[0] != WARM_UP_MAGIC || header[1] != WARM_UP_VERSION) {
+        std::cerr << "Warning: Ignoring invalid warm-up file " << path << std::endl;
+        return 0;
+    }
+    std::vector<page_id_t> hottest(header[2]);
+    in.read(reinterpret_cast<char*>(hottest.data()), hottest.size() * sizeof(page_id_t));
+    hottest.resize(in.gcount() / sizeof(page_id_t));  // Tolerate a truncated tail
+
+    std::unique_lock<std::mutex> lock(latch_);
+
+    // Only fill free frames, never evict what is already here
+    if (hottest.size() > free_list_.size()) {
+        hottest.resize(free_list_.size());
+    }
+
+    // Read in page-id order, runs of consecutive ids as one batch each
+    std::vector<page_id_t> sorted = hottest;
+    std::sort(sorted.begin(), sorted.end());
+    sorted.erase(std::unique(sorted.begin(), sorted.end()), sorted.end());
+    size_t run_start = 0;
+    while (run_start < sorted.size()) {
+        size_t run_end = run_start + 1;
+        while (run_end < sorted.size() && sorted[run_end] == sorted[run_end - 1] + 1) {
+            run_end++;
+        }
+        StartPrefetch(sorted[run_start], run_end - run_start, lock);
+        run_start = run_end;
+    }
+    io_cv_.wait(lock, [this]() { return prefetch_in_flight_ == 0; });
+
+    // Touch the pages coldest first, so the hottest end up most recent
+    size_t loaded = 0;
+    for (auto it = hottest.rbegin(); it != hottest.rend(); ++it) {
+        frame_id_t frame_id = page_table_.Find(*it);
+        if (frame_id == INVALID_FRAME_ID) {
+            continue;  // Past the end of the file, or the read failed
+        }
+        FrameDescriptor& frame = frames_[frame_id];
+        if (frame.page_id == *it && frame.pin_count == 0 && !frame.io_pending) {
+            // The recorded recency is a real reference
+            frame.prefetched = false;
+            replacer_->Pin(frame_id);
+            MakeEvictable(frame_id);
+            loaded++;
+        }
+    }
+    return loaded;
+}
+
+void BufferPoolManager::Resize(size_t new_size) {
+    if (new_size == 0 || new_size > max_pool_size_) {
+        throw std::invalid_argument("Buffer pool size must be between 1 and " +
+                                    std::to_string(max_pool_size_));
+    }
+
+    std::lock_guard<std::mutex> resize_lock(resize_mutex_);
+    std::unique_lock<std::mutex> lock(latch_);
+
+    size_t old_size = pool_size_;
+    pool_size_ = new_size;
+    read_ahead_pages_ = std::min(read_ahead_limit_, new_size / 4);
+
+    if (new_size >= old_size) {
+        // Spare frames are empty, they only need to become allocatable
+        for (size_t i = old_size; i < new_size; ++i) {
+            free_list_.push_back(static_cast<frame_id_t>(i));
+        }
+        return;
+    }
+
+    // Stop handing out the removed frames: they leave the free list and the
+    // replacer, and from now on MakeEvictable/ReleaseFrame skip them
+    free_list_.erase(std::remove_if(free_list_.begin(), free_list_.end(),
+                                    [new_size](frame_id_t frame_id) {
+                                        return static_cast<size_t>(frame_id) >= new_size;
+                                    }),
+                     free_list_.end());
+    for (size_t i = new_size; i < old_size; ++i) {
+        replacer_->Remove(static_cast<frame_id_t>(i));
+    }
+
+    // Empty the removed frames one by one. Hits may still pin their pages
+    // until they are evicted, so wait for a moment when nothing holds them.
+    for (size_t i = new_size; i < old_size; ++i) {
+        frame_id_t frame_id = static_cast<frame_id_t>(i);
+        FrameDescriptor& frame = frames_[frame_id];
+        io_cv_.wait(lock, [&frame]() {
+            return frame.pin_count == 0 && !frame.io_pending && !frame.cleaning;
+        });
+
+        page_id_t page_id = frame.page_id;
+        if (page_id == INVALID_PAGE_ID) {
+            continue;
+        }
+
+        if (frame.is_dirty) {
+            // Write back with the page still mapped; io_pending makes
+            // fetches of it wait rather than read the stale disk copy
+            frame.io_pending = true;
+            lock.unlock();
+            try {
+                FlushLogUntil(pages_[frame_id].GetLSN());
+                pages_[frame_id].UpdateChecksum();
+                disk_manager_->WritePage(page_id, &pages_[frame_id]);
+            } catch (...) {
+                // Undo the shrink: every frame not yet emptied is usable again
+                lock.lock();
+                frame.io_pending = false;
+                pool_size_ = old_size;
+                read_ahead_pages_ = std::min(read_ahead_limit_, old_size / 4);
+                for (size_t j = new_size; j < old_size; ++j) {
+                    FrameDescriptor& other = frames_[j];
+                    if (other.pin_count > 0 || other.io_pending) {
+                        continue;  // Whoever holds it releases it normally
+                    }
+                    if (other.page_id == INVALID_PAGE_ID) {
+                        free_list_.push_back(static_cast<frame_id_t>(j));
+                    } else {
+                        replacer_->Unpin(static_cast<frame_id_t>(j));
+                    }
+                }
+                io_cv_.notify_all();
+                throw;
+            }
+            lock.lock();
+        }
+
+        page_table_.Erase(page_id);
+        frame.Reset();
+        io_cv_.notify_all();
+    }
+
+    arena_.Release(new_size, old_size - new_size);
+}
+
 frame_id_t BufferPoolManager::GetVictimFrame() {
     // First try to get from free list
     if (!free_list_.empty()) {
@@ -231,7 +901,7 @@ frame_id_t BufferPoolManager::GetVictimFrame() {
         return frame_id;
     }
 
-    // No free frames, evict using LRU
+    // No free frames, ask the replacer for a victim
     frame_id_t victim_frame;
     if (replacer_->Victim(&victim_frame)) {
         return victim_frame;
@@ -241,4 +911,139 @@ frame_id_t BufferPoolManager::GetVictimFrame() {
     return INVALID_FRAME_ID;
 }
 
+void BufferPoolManager::MakeEvictable(frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) < pool_size_) {
+        replacer_->Unpin(frame_id);
+    } else {
+        io_cv_.notify_all();  // A shrinking Resize is waiting for this frame
+    }
+}
+
+void BufferPoolManager::DiscardFrame(frame_id_t frame_id) {
+    // Remove from tables; the frame must also leave the replacer or it
+    // could be handed out twice (once as a victim, once from the free list)
+    page_table_.Erase(frames_[frame_id].page_id);
+    frames_[frame_id].Reset();
+    replacer_->Remove(frame_id);
+
+    // Add frame back to free list
+    ReleaseFrame(frame_id);
+}
+
+void BufferPoolManager::ReleaseFrame(frame_id_t frame_id) {
+    if (static_cast<size_t>(frame_id) < pool_size_) {
+        free_list_.push_back(frame_id);
+    } else {
+        io_cv_.notify_all();
+    }
+}
+
+frame_id_t BufferPoolManager::FindResidentFrame(page_id_t page_id,
+                                                std::unique_lock<std::mutex>& lock) {
+    while (true) {
+        frame_id_t frame_id = page_table_.Find(page_id);
+        if (frame_id == INVALID_FRAME_ID) {
+            return INVALID_FRAME_ID;
+        }
+
+        // Still being read in, or being written back out of a frame that
+        // already belongs to another page: wait and look again
+        const FrameDescriptor& frame = frames_[frame_id];
+        if (frame.page_id == page_id && !frame.io_pending) {
+            return frame_id;
+        }
+        io_cv_.wait(lock);
+    }
+}
+
+frame_id_t BufferPoolManager::FindIdleFrame(page_id_t page_id,
+                                            std::unique_lock<std::mutex>& lock) {
+    // Like FindResidentFrame, but also waits out a cleaner write of the page
+    while (true) {
+        frame_id_t frame_id = FindResidentFrame(page_id, lock);
+        if (frame_id == INVALID_FRAME_ID || !frames_[frame_id].cleaning) {
+            return frame_id;
+        }
+        io_cv_.wait(lock);
+    }
+}
+
+frame_id_t BufferPoolManager::AcquireFrame(page_id_t page_id,
+                                           std::unique_lock<std::mutex>& lock) {
+    frame_id_t frame_id = GetVictimFrame();
+    if (frame_id == INVALID_FRAME_ID) {
+        return INVALID_FRAME_ID;
+    }
+
+    FrameDescriptor& frame = frames_[frame_id];
+    page_id_t old_page_id = frame.page_id;
+    bool write_back = old_page_id != INVALID_PAGE_ID && frame.is_dirty;
+    // The cleaner is writing a copy of the old page: like a write-back, the
+    // old page stays mapped until that write has landed
+    bool cleaning = frame.cleaning;
+
+    // A clean old page can simply be forgotten
+    if (old_page_id != INVALID_PAGE_ID && !write_back && !cleaning) {
+        page_table_.Erase(old_page_id);
+    }
+
+    // Hand the frame to the new page; it stays pinned and io_pending until
+    // the caller has filled it
+    frame.Reset();
+    frame.page_id = page_id;
+    frame.pin_count = 1;
+    frame.io_pending = true;
+    page_table_.Insert(page_id, frame_id);
+    replacer_->Pin(frame_id);
+
+    if (cleaning) {
+        io_cv_.wait(lock, [&frame]() { return !frame.cleaning; });
+        // A failed cleaner write sets is_dirty; the frame still holds the
+        // old page, so write it back here instead
+        write_back = write_back || frame.is_dirty;
+        frame.is_dirty = false;
+    }
+
+    if (!write_back) {
+        if (cleaning) {
+            page_table_.Erase(old_page_id);
+            io_cv_.notify_all();
+        }
+        frame.rec_lsn = CurrentLSN();
+        return frame_id;
+    }
+
+    // Foreground write-back: this miss pays for a write, so wake the
+    // cleaner to get ahead of the next ones
+    foreground_write_count_++;
+    cleaner_cv_.notify_one();
+
+    // Write the dirty old page back without holding the pool latch
+    lock.unlock();
+    try {
+        // Update checksum before writing
+        FlushLogUntil(pages_[frame_id].GetLSN());
+        pages_[frame_id].UpdateChecksum();
+        disk_manager_->WritePage(old_page_id, &pages_[frame_id]);
+    } catch (...) {
+        // Give the frame back to the old page, still dirty
+        lock.lock();
+        page_table_.Erase(page_id);
+        frame.Reset();
+        frame.page_id = old_page_id;
+        frame.is_dirty = true;
+        MakeEvictable(frame_id);
+        io_cv_.notify_all();
+        throw;
+    }
+    lock.lock();
+
+    // Old page is on disk now, later fetches of it may read it back
+    page_table_.Erase(old_page_id);
+    frame.rec_lsn = CurrentLSN();
+    io_cv_.notify_all();
+
+    return frame_id;
+}
+
 }  // namespace logicmaze
\ No newline at end of file
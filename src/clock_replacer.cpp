@@ -0,0 +1,85 @@
+#include "../include/clock_replacer.h"
+
+namespace logicmaze {
+
+ClockReplacer::ClockReplacer(size_t num_frames)
+    : num_frames_(num_frames),
+      state_(num_frames),
+      hand_(0),
+      size_(0) {
+    for (auto& state : state_) {
+        state.store(0, std::memory_order_relaxed);
+    }
+}
+
+bool ClockReplacer::Victim(frame_id_t* frame_id) {
+    // Two full sweeps are enough: the first clears reference bits, the
+    // second finds a frame whose bit is still clear
+    for (size_t step = 0; step < 2 * num_frames_ + 1; ++step) {
+        if (size_.load(std::memory_order_acquire) == 0) {
+            return false;  // No unpinned frames
+        }
+
+        size_t index = hand_.fetch_add(1, std::memory_order_relaxed) % num_frames_;
+        std::atomic<uint8_t>& state = state_[index];
+        uint8_t current = state.load(std::memory_order_acquire);
+
+        if (!(current & EVICTABLE)) {
+            continue;  // Pinned or not resident
+        }
+
+        if (current & REFERENCED) {
+            // Second chance: clear the bit and move on
+            state.compare_exchange_strong(current, current & ~REFERENCED,
+                                          std::memory_order_acq_rel);
+            continue;
+        }
+
+        // Claim the frame; fails if it was pinned or referenced meanwhile
+        if (state.compare_exchange_strong(current, 0, std::memory_order_acq_rel)) {
+            size_.fetch_sub(1, std::memory_order_acq_rel);
+            *frame_id = static_cast<frame_id_t>(index);
+            return true;
+        }
+    }
+
+    return false;
+}
+
+void ClockReplacer::Pin(frame_id_t frame_id) {
+    uint8_t previous = state_[frame_id].fetch_and(static_cast<uint8_t>(~EVICTABLE),
+                                                  std::memory_order_acq_rel);
+    if (previous & EVICTABLE) {
+        size_.fetch_sub(1, std::memory_order_acq_rel);
+    }
+}
+
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+    uint8_t previous = state_[frame_id].fetch_or(EVICTABLE | REFERENCED,
+                                                 std::memory_order_acq_rel);
+    if (!(previous & EVICTABLE)) {
+        size_.fetch_add(1, std::memory_order_acq_rel);
+    }
+}
+
+size_t ClockReplacer::Size() const {
+    return size_.load(std::memory_order_acquire);
+}
+
+void ClockReplacer::ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const {
+    frames->clear();
+
+    // Unreferenced frames in hand order go first, then the ones that would
+    // only be taken after their second chance
+    size_t start = hand_.load(std::memory_order_relaxed);
+    for (uint8_t wanted : {EVICTABLE, static_cast<uint8_t>(EVICTABLE | REFERENCED)}) {
+        for (size_t step = 0; step < num_frames_ && frames->size() < max; ++step) {
+            size_t index = (start + step) % num_frames_;
+            if (state_[index].load(std::memory_order_acquire) == wanted) {
+                frames->push_back(static_cast<frame_id_t>(index));
+            }
+        }
+    }
+}
+
+}  // namespace logicmaze
@@ -0,0 +1,106 @@
+#include "crc32c.h"
+#include <cstring>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h>
+#define LOGICMAZE_HAVE_SSE42_CRC 1
+#endif
+
+namespace logicmaze {
+
+namespace {
+
+constexpr uint32_t CRC32C_POLY = 0x82F63B78;  // Reflected Castagnoli polynomial
+
+struct Crc32cTables {
+    uint32_t table[8][256];
+
+    Crc32cTables() {
+        for (uint32_t i = 0; i < 256; ++i) {
+            uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc >> 1) ^ ((crc & 1) ? CRC32C_POLY : 0);
+            }
+            table[0][i] = crc;
+        }
+        // table[k][i] is the CRC of byte i followed by k zero bytes
+        for (uint32_t i = 0; i < 256; ++i) {
+            for (int k = 1; k < 8; ++k) {
+                table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xFF];
+            }
+        }
+    }
+};
+
+const Crc32cTables& Tables() {
+    static const Crc32cTables tables;
+    return tables;
+}
+
+#ifdef LOGICMAZE_HAVE_SSE42_CRC
+__attribute__((target("sse4.2")))
+uint32_t Crc32cSse42(const void* data, size_t size, uint32_t crc) {
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    uint64_t value = ~crc;
+
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint64_t word;
+        std::memcpy(&word, bytes, sizeof(word));
+        value = _mm_crc32_u64(value, word);
+    }
+    uint32_t value32 = static_cast<uint32_t>(value);
+    for (; size > 0; ++bytes, --size) {
+        value32 = _mm_crc32_u8(value32, *bytes);
+    }
+    return ~value32;
+}
+#endif
+
+using Crc32cFunction = uint32_t (*)(const void*, size_t, uint32_t);
+
+Crc32cFunction SelectCrc32c() {
+#ifdef LOGICMAZE_HAVE_SSE42_CRC
+    if (__builtin_cpu_supports("sse4.2")) {
+        return Crc32cSse42;
+    }
+#endif
+    return Crc32cPortable;
+}
+
+const Crc32cFunction g_crc32c = SelectCrc32c();
+
+}  // namespace
+
+uint32_t Crc32cPortable(const void* data, size_t size, uint32_t crc) {
+    const auto& table = Tables().table;
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    crc = ~crc;
+
+    // Eight bytes per step; assumes a little-endian host like the rest of
+    // the on-disk format
+    for (; size >= 8; bytes += 8, size -= 8) {
+        uint32_t low;
+        uint32_t high;
+        std::memcpy(&low, bytes, sizeof(low));
+        std::memcpy(&high, bytes + 4, sizeof(high));
+        low ^= crc;
+        crc = table[7][low & 0xFF] ^ table[6][(low >> 8) & 0xFF] ^
+              table[5][(low >> 16) & 0xFF] ^ table[4][low >> 24] ^
+              table[3][high & 0xFF] ^ table[2][(high >> 8) & 0xFF] ^
+              table[1][(high >> 16) & 0xFF] ^ table[0][high >> 24];
+    }
+    for (; size > 0; ++bytes, --size) {
+        crc = (crc >> 8) ^ table[0][(crc ^ *bytes) & 0xFF];
+    }
+    return ~crc;
+}
+
+uint32_t Crc32c(const void* data, size_t size, uint32_t crc) {
+    return g_crc32c(data, size, crc);
+}
+
+const char* Crc32cImplementation() {
+    return g_crc32c == Crc32cPortable ? "table" : "sse4.2";
+}
+
+}  // namespace logicmaze
@@ -1,61 +1,120 @@
 #include "disk_manager.h"
+#include "file_io.h"
 #include <iostream>
 #include <stdexcept>
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
 
 namespace logicmaze {
 
-DiskManager::DiskManager(const std::string& db_filename) 
-    : db_filename_(db_filename), num_pages_(0) {
+namespace {
+
+off_t PageOffset(page_id_t page_id) {
+    return static_cast<off_t>(page_id) * PAGE_SIZE;
+}
+
+constexpr size_t FSM_WORDS = FSM_PAGE_BITS / 64;
+
+size_t FsmGroup(page_id_t page_id) {
+    return (page_id - FIRST_FSM_PAGE_ID) / FSM_PAGE_BITS;
+}
+
+page_id_t FsmPageId(size_t group) {
+    return static_cast<page_id_t>(FIRST_FSM_PAGE_ID + group * FSM_PAGE_BITS);
+}
+
+bool IsFsmPage(page_id_t page_id) {
+    return page_id >= FIRST_FSM_PAGE_ID && (page_id - FIRST_FSM_PAGE_ID) % FSM_PAGE_BITS == 0;
+}
+
+}  // namespace
+
+DiskManager::DiskManager(const std::string& db_filename, bool direct_io, bool allow_io_uring,
+                         size_t extent_pages)
+    : db_filename_(db_filename), fd_(-1), direct_io_(direct_io), num_pages_(0),
+      allocated_pages_(0), extent_pages_(extent_pages),
+      free_count_(0), first_free_group_(0), persisted_num_pages_(0),
+      checkpoint_lsn_(INVALID_LSN), redo_lsn_(INVALID_LSN), header_dirty_(false),
+      allow_io_uring_(allow_io_uring) {
     
     // Check if database file exists
     struct stat buffer;
     bool file_exists = (stat(db_filename_.c_str(), &buffer) == 0);
 
-    if (file_exists) {
-        // Open existing database
-        db_file_.open(db_filename_, std::ios::in | std::ios::out | std::ios::binary);
-        if (!db_file_.is_open()) {
-            throw std::runtime_error("Failed to open database file: " + db_filename_);
+    int flags = O_RDWR | O_CREAT;
+    if (direct_io_) {
+        fd_ = open(db_filename_.c_str(), flags | O_DIRECT, 0644);
+        if (fd_ < 0 && errno == EINVAL) {
+            // e.g. tmpfs has no O_DIRECT support
+            std::cerr << "Warning: O_DIRECT not supported for " << db_filename_
+                      << ", using buffered I/O" << std::endl;
+            direct_io_ = false;
         }
+    }
+    if (!direct_io_) {
+        fd_ = open(db_filename_.c_str(), flags, 0644);
+    }
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open database file: " + db_filename_ +
+                                 " (" + std::strerror(errno) + ")");
+    }
 
+    if (file_exists) {
         // Get file size and calculate number of pages
-        db_file_.seekg(0, std::ios::end);
-        size_t file_size = db_file_.tellg();
-        num_pages_ = file_size / PAGE_SIZE;
-        
-        std::cout << "Opened existing database: " << db_filename_ 
-                  << " (" << num_pages_ << " pages)" << std::endl;
-
-        LoadFreePageList();
-    } else {
-        // Create new database
-        db_file_.open(db_filename_, std::ios::out | std::ios::binary);
-        if (!db_file_.is_open()) {
-            throw std::runtime_error("Failed to create database file: " + db_filename_);
+        struct stat file_stat;
+        if (fstat(fd_, &file_stat) != 0) {
+            close(fd_);
+            throw std::runtime_error("Failed to stat database file: " + db_filename_);
         }
-        db_file_.close();
+        num_pages_ = file_stat.st_size / PAGE_SIZE;
+    }
 
-        // Reopen in read/write mode
-        db_file_.open(db_filename_, std::ios::in | std::ios::out | std::ios::binary);
-        if (!db_file_.is_open()) {
-            throw std::runtime_error("Failed to reopen database file: " + db_filename_);
+    if (num_pages_ > 0) {
+        try {
+            LoadFreeSpaceMap();
+        } catch (...) {
+            close(fd_);
+            throw;
         }
 
+        std::cout << "Opened existing database: " << db_filename_ 
+                  << " (" << num_pages_ << " pages, " << free_count_ << " free)" << std::endl;
+    } else {
         std::cout << "Created new database: " << db_filename_ << std::endl;
         InitializeDatabase();
     }
 }
 
 DiskManager::~DiskManager() {
-    if (db_file_.is_open()) {
-        SaveFreePageList();
-        db_file_.close();
+    // Drains in-flight async I/O before the file is closed
+    async_engine_.reset();
+
+    if (fd_ >= 0) {
+        try {
+            std::lock_guard<std::mutex> lock(mutex_);
+            WriteFreeSpaceMap();
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << std::endl;
+        }
+        close(fd_);
     }
 }
 
 void DiskManager::InitializeDatabase() {
-    // Create header page (page 0)
+    // Header page (page 0) and the first free space map page (page 1)
+    num_pages_ = FIRST_FSM_PAGE_ID + 1;
+    EnsureFsmGroups(1);
+    ReserveExtent(num_pages_);
+    WriteFreeSpaceMap();
+}
+
+void DiskManager::WriteHeaderPage() {
     Page header_page;
     PageHeader* header = header_page.GetHeader();
     header->page_id = HEADER_PAGE_ID;
@@ -64,41 +123,44 @@ void DiskManager::InitializeDatabase() {
     
     // Write database metadata to header page data area
     char* data = header_page.GetData();
-    uint32_t version = 1;
+    uint32_t version = DB_VERSION;
     uint32_t page_size = PAGE_SIZE;
-    std::memcpy(data, &version, sizeof(version));
-    std::memcpy(data + 4, &page_size, sizeof(page_size));
-    std::memcpy(data + 8, &num_pages_, sizeof(num_pages_));
+    page_id_t num_pages = num_pages_;
+    page_id_t allocated_pages = std::max(allocated_pages_, num_pages);
+    std::memcpy(data + HEADER_VERSION_OFFSET, &version, sizeof(version));
+    std::memcpy(data + HEADER_PAGE_SIZE_OFFSET, &page_size, sizeof(page_size));
+    std::memcpy(data + HEADER_NUM_PAGES_OFFSET, &num_pages, sizeof(num_pages));
+    std::memcpy(data + HEADER_ALLOCATED_PAGES_OFFSET, &allocated_pages, sizeof(allocated_pages));
+    std::memcpy(data + HEADER_CHECKPOINT_LSN_OFFSET, &checkpoint_lsn_, sizeof(checkpoint_lsn_));
+    std::memcpy(data + HEADER_REDO_LSN_OFFSET, &redo_lsn_, sizeof(redo_lsn_));
     
     header_page.UpdateChecksum();
     
-    WritePage(HEADER_PAGE_ID, &header_page);
-    num_pages_ = 1;
-    
-    SaveFreePageList();
+    if (PwriteFull(fd_, header_page.GetRawData(), PAGE_SIZE, PageOffset(HEADER_PAGE_ID)) !=
+        static_cast<ssize_t>(PAGE_SIZE)) {
+        throw std::runtime_error("Failed to write header page of " + db_filename_);
+    }
+    persisted_num_pages_ = num_pages;
+    header_dirty_ = false;
 }
 
 void DiskManager::ReadPage(page_id_t page_id, Page* page) {
-    std::lock_guard<std::mutex> lock(mutex_);
-    
     if (page_id >= num_pages_) {
         throw std::out_of_range("Page ID out of range: " + std::to_string(page_id));
     }
 
-    // Seek to page position
-    db_file_.seekg(page_id * PAGE_SIZE, std::ios::beg);
-    if (db_file_.fail()) {
-        throw std::runtime_error("Failed to seek to page " + std::to_string(page_id));
-    }
-
     // Read page data
-    db_file_.read(page->GetRawData(), PAGE_SIZE);
-    if (db_file_.fail()) {
+    if (PreadFull(fd_, page->GetRawData(), PAGE_SIZE, PageOffset(page_id)) !=
+        static_cast<ssize_t>(PAGE_SIZE)) {
         throw std::runtime_error("Failed to read page " + std::to_string(page_id));
     }
 
-    // Verify checksum (skip for header and free list pages)
-    PageHeader* header = page->GetHeader();
+    VerifyPage(page_id, page);
+}
+
+void DiskManager::VerifyPage(page_id_t page_id, const Page* page) const {
+    // Verify checksum (skip for header and version 1 free list pages)
+    const PageHeader* header = page->GetHeader();
     if (header->page_type != PageType::HEADER && 
         header->page_type != PageType::FREE_LIST &&
         header->checksum != 0) {  // Only verify if checksum was set
@@ -109,127 +171,558 @@ void DiskManager::ReadPage(page_id_t page_id, Page* page) {
 }
 
 void DiskManager::WritePage(page_id_t page_id, const Page* page) {
-    std::lock_guard<std::mutex> lock(mutex_);
+    // Write page data
+    if (PwriteFull(fd_, page->GetRawData(), PAGE_SIZE, PageOffset(page_id)) !=
+        static_cast<ssize_t>(PAGE_SIZE)) {
+        throw std::runtime_error("Failed to write page " + std::to_string(page_id));
+    }
 
     // Extend file if necessary
-    if (page_id >= num_pages_) {
-        num_pages_ = page_id + 1;
-    }
+    ExtendNumPages(page_id + 1);
+}
 
-    // Seek to page position
-    db_file_.seekp(page_id * PAGE_SIZE, std::ios::beg);
-    if (db_file_.fail()) {
-        throw std::runtime_error("Failed to seek to page " + std::to_string(page_id));
+void DiskManager::WritePages(std::vector<std::pair<page_id_t, const Page*>> pages) {
+    std::sort(pages.begin(), pages.end(),
+              [](const std::pair<page_id_t, const Page*>& a,
+                 const std::pair<page_id_t, const Page*>& b) { return a.first < b.first; });
+
+    std::vector<struct iovec> iov;
+    iov.reserve(std::min<size_t>(pages.size(), IOV_MAX));
+
+    size_t run_start = 0;
+    while (run_start < pages.size()) {
+        // Extend the run while page ids stay consecutive
+        size_t run_end = run_start + 1;
+        while (run_end < pages.size() && run_end - run_start < IOV_MAX &&
+               pages[run_end].first == pages[run_end - 1].first + 1) {
+            run_end++;
+        }
+
+        iov.clear();
+        for (size_t i = run_start; i < run_end; ++i) {
+            iov.push_back({const_cast<char*>(pages[i].second->GetRawData()), PAGE_SIZE});
+        }
+
+        page_id_t first_page_id = pages[run_start].first;
+        ssize_t expected = static_cast<ssize_t>((run_end - run_start) * PAGE_SIZE);
+        ssize_t written;
+        do {
+            written = pwritev(fd_, iov.data(), iov.size(), PageOffset(first_page_id));
+        } while (written < 0 && errno == EINTR);
+
+        if (written != expected) {
+            // Short or failed vectored write: redo the run page by page
+            for (size_t i = run_start; i < run_end; ++i) {
+                if (PwriteFull(fd_, pages[i].second->GetRawData(), PAGE_SIZE,
+                               PageOffset(pages[i].first)) != static_cast<ssize_t>(PAGE_SIZE)) {
+                    throw std::runtime_error("Failed to write page " +
+                                             std::to_string(pages[i].first));
+                }
+            }
+        }
+
+        ExtendNumPages(pages[run_end - 1].first + 1);
+        run_start = run_end;
     }
+}
 
-    // Write page data
-    db_file_.write(page->GetRawData(), PAGE_SIZE);
-    if (db_file_.fail()) {
-        throw std::runtime_error("Failed to write page " + std::to_string(page_id));
+AsyncIOEngine* DiskManager::GetAsyncEngine() {
+    std::call_once(async_init_, [this]() {
+        async_engine_ = AsyncIOEngine::Create(ASYNC_IO_QUEUE_DEPTH, allow_io_uring_);
+    });
+    return async_engine_.get();
+}
+
+const char* DiskManager::GetAsyncBackendName() {
+    return GetAsyncEngine()->Name();
+}
+
+void DiskManager::ReadPageAsync(page_id_t page_id, Page* page, IOCallback callback) {
+    if (page_id >= num_pages_) {
+        throw std::out_of_range("Page ID out of range: " + std::to_string(page_id));
     }
 
-    db_file_.flush();
+    GetAsyncEngine()->SubmitRead(
+        fd_, page->GetRawData(), PAGE_SIZE, PageOffset(page_id),
+        [this, page_id, page, callback = std::move(callback)](bool ok) {
+            if (ok) {
+                VerifyPage(page_id, page);
+            }
+            callback(ok);
+        });
+}
+
+void DiskManager::WritePageAsync(page_id_t page_id, const Page* page, IOCallback callback) {
+    GetAsyncEngine()->SubmitWrite(
+        fd_, page->GetRawData(), PAGE_SIZE, PageOffset(page_id),
+        [this, page_id, callback = std::move(callback)](bool ok) {
+            if (ok) {
+                ExtendNumPages(page_id + 1);
+            }
+            callback(ok);
+        });
+}
+
+std::future<void> DiskManager::ReadPageAsync(page_id_t page_id, Page* page) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    ReadPageAsync(page_id, page, [promise, page_id](bool ok) {
+        if (ok) {
+            promise->set_value();
+        } else {
+            promise->set_exception(std::make_exception_ptr(
+                std::runtime_error("Failed to read page " + std::to_string(page_id))));
+        }
+    });
+    return result;
+}
+
+std::future<void> DiskManager::WritePageAsync(page_id_t page_id, const Page* page) {
+    auto promise = std::make_shared<std::promise<void>>();
+    std::future<void> result = promise->get_future();
+    WritePageAsync(page_id, page, [promise, page_id](bool ok) {
+        if (ok) {
+            promise->set_value();
+        } else {
+            promise->set_exception(std::make_exception_ptr(
+                std::runtime_error("Failed to write page " + std::to_string(page_id))));
+        }
+    });
+    return result;
+}
+
+void DiskManager::ExtendNumPages(page_id_t num_pages) {
+    page_id_t current = num_pages_.load();
+    while (current < num_pages && !num_pages_.compare_exchange_weak(current, num_pages)) {
+    }
 }
 
 page_id_t DiskManager::AllocatePage() {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    page_id_t new_page_id;
-
-    // Reuse free page if available
-    if (!free_pages_.empty()) {
-        new_page_id = free_pages_.back();
-        free_pages_.pop_back();
-    } else {
+    if (free_count_ == 0) {
         // Allocate new page at end of file
-        new_page_id = num_pages_;
-        num_pages_++;
+        return ExtendFile(1);
     }
 
+    // Reuse the lowest free page; the hints skip groups and words already
+    // known to be empty, so this stays O(1) amortized
+    while (fsm_free_count_[first_free_group_] == 0) {
+        first_free_group_++;
+    }
+    size_t group = first_free_group_;
+    const uint64_t* words = &fsm_bits_[group * FSM_WORDS];
+    size_t word = fsm_hint_[group];
+    while (words[word] == 0) {
+        word++;
+    }
+    fsm_hint_[group] = static_cast<uint32_t>(word);
+
+    page_id_t new_page_id = FsmPageId(group) + static_cast<page_id_t>(
+        word * 64 + __builtin_ctzll(words[word]));
+    MarkUsed(new_page_id);
     return new_page_id;
 }
 
+page_id_t DiskManager::AllocatePages(size_t count) {
+    // A run can never cover a free space map page
+    if (count == 0 || count >= FSM_PAGE_BITS) {
+        throw std::invalid_argument("Cannot allocate a run of " + std::to_string(count) +
+                                    " pages");
+    }
+    if (count == 1) {
+        return AllocatePage();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (free_count_ >= count) {
+        page_id_t first = FindFreeRun(count);
+        if (first != INVALID_PAGE_ID) {
+            for (size_t i = 0; i < count; ++i) {
+                MarkUsed(first + static_cast<page_id_t>(i));
+            }
+            return first;
+        }
+    }
+    return ExtendFile(count);
+}
+
+page_id_t DiskManager::FindFreeRun(size_t count) {
+    for (size_t group = first_free_group_; group < fsm_free_count_.size(); ++group) {
+        if (fsm_free_count_[group] < count) {
+            continue;
+        }
+
+        // Bit 0 of a group is its map page, so runs never cross groups
+        const uint64_t* words = &fsm_bits_[group * FSM_WORDS];
+        size_t run = 0;
+        for (size_t w = fsm_hint_[group]; w < FSM_WORDS; ++w) {
+            uint64_t word = words[w];
+            if (word == 0) {
+                run = 0;
+            } else if (word == ~0ULL) {
+                if (run + 64 >= count) {
+                    return FsmPageId(group) + static_cast<page_id_t>(w * 64 - run);
+                }
+                run += 64;
+            } else {
+                for (size_t b = 0; b < 64; ++b) {
+                    if ((word >> b) & 1) {
+                        if (++run == count) {
+                            return FsmPageId(group) +
+                                   static_cast<page_id_t>(w * 64 + b + 1 - count);
+                        }
+                    } else {
+                        run = 0;
+                    }
+                }
+            }
+        }
+    }
+    return INVALID_PAGE_ID;
+}
+
+page_id_t DiskManager::ExtendFile(size_t count) {
+    page_id_t first = num_pages_.load();
+
+    // The map page of the next group is claimed first when the run reaches it;
+    // pages skipped in front of it stay free for single allocations
+    page_id_t next_fsm_page = FsmPageId(
+        (first - FIRST_FSM_PAGE_ID + FSM_PAGE_BITS - 1) / FSM_PAGE_BITS);
+    if (next_fsm_page < first + count) {
+        EnsureFsmGroups(FsmGroup(next_fsm_page) + 1);
+        ExtendNumPages(next_fsm_page + 1);
+        for (page_id_t page_id = first; page_id < next_fsm_page; ++page_id) {
+            MarkFree(page_id);
+        }
+        first = next_fsm_page + 1;
+    }
+
+    EnsureFsmGroups(FsmGroup(first + static_cast<page_id_t>(count) - 1) + 1);
+    ExtendNumPages(first + static_cast<page_id_t>(count));
+    ReserveExtent(first + static_cast<page_id_t>(count));
+    return first;
+}
+
+void DiskManager::ReserveExtent(page_id_t num_pages) {
+    if (extent_pages_ == 0 || num_pages <= allocated_pages_) {
+        return;
+    }
+
+    // Round up to whole extents so the file grows (and its block map and
+    // size change) once per extent instead of once per page
+    page_id_t target = static_cast<page_id_t>(
+        (num_pages + extent_pages_ - 1) / extent_pages_ * extent_pages_);
+
+    // Never touch pages already written past the last extent
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0) {
+        throw std::runtime_error("Failed to stat database file: " + db_filename_);
+    }
+    page_id_t first = std::max(allocated_pages_,
+                               static_cast<page_id_t>(file_stat.st_size / PAGE_SIZE));
+    if (first >= target) {
+        allocated_pages_ = first;
+        return;
+    }
+    off_t offset = PageOffset(first);
+    off_t length = PageOffset(target) - offset;
+
+    int result;
+    do {
+        result = fallocate(fd_, 0, offset, length);
+    } while (result != 0 && errno == EINTR);
+
+    if (result != 0) {
+        if (errno != EOPNOTSUPP) {
+            throw std::runtime_error("Failed to preallocate " + db_filename_ + " (" +
+                                     std::strerror(errno) + ")");
+        }
+        // No block reservation on this filesystem; at least set the size
+        // once per extent
+        if (ftruncate(fd_, PageOffset(target)) != 0) {
+            throw std::runtime_error("Failed to extend " + db_filename_ + " (" +
+                                     std::strerror(errno) + ")");
+        }
+    }
+
+    if (direct_io_) {
+        // O_DIRECT writes into preallocated (unwritten) blocks pay for an
+        // extent conversion each time; zeroing the extent once up front turns
+        // them into plain overwrites
+        std::vector<Page> zeros(std::min<size_t>(extent_pages_, 128));
+        for (page_id_t page_id = first; page_id < target; page_id += zeros.size()) {
+            size_t count = std::min<size_t>(zeros.size(), target - page_id);
+            if (PwriteFull(fd_, zeros[0].GetRawData(), count * PAGE_SIZE, PageOffset(page_id)) !=
+                static_cast<ssize_t>(count * PAGE_SIZE)) {
+                throw std::runtime_error("Failed to preallocate " + db_filename_ + " (" +
+                                         std::strerror(errno) + ")");
+            }
+        }
+    }
+
+    allocated_pages_ = target;
+    WriteHeaderPage();
+}
+
 void DiskManager::DeallocatePage(page_id_t page_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     if (page_id == HEADER_PAGE_ID) {
         throw std::invalid_argument("Cannot deallocate header page");
     }
+    if (IsFsmPage(page_id)) {
+        throw std::invalid_argument("Cannot deallocate free space map page " +
+                                    std::to_string(page_id));
+    }
 
     if (page_id >= num_pages_) {
         throw std::out_of_range("Page ID out of range: " + std::to_string(page_id));
     }
 
-    free_pages_.push_back(page_id);
+    // Freeing a page that is already free is a no-op
+    EnsureFsmGroups(FsmGroup(page_id) + 1);
+    MarkFree(page_id);
 }
 
-void DiskManager::Flush() {
+void DiskManager::MarkAllocated(page_id_t page_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (page_id == HEADER_PAGE_ID || IsFsmPage(page_id)) {
+        throw std::invalid_argument("Cannot allocate reserved page " + std::to_string(page_id));
+    }
+    if (page_id >= num_pages_) {
+        throw std::out_of_range("Page ID out of range: " + std::to_string(page_id));
+    }
+
+    EnsureFsmGroups(FsmGroup(page_id) + 1);
+    MarkUsed(page_id);
+}
+
+page_id_t DiskManager::GetAllocatedPages() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return std::max(allocated_pages_, num_pages_.load());
+}
+
+void DiskManager::SetCheckpoint(lsn_t checkpoint_lsn, lsn_t redo_lsn) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    checkpoint_lsn_ = checkpoint_lsn;
+    redo_lsn_ = redo_lsn;
+    header_dirty_ = true;
+}
+
+lsn_t DiskManager::GetCheckpointLSN() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return checkpoint_lsn_;
+}
+
+lsn_t DiskManager::GetRedoLSN() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return redo_lsn_;
+}
+
+size_t DiskManager::GetFreePageCount() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    db_file_.flush();
+    return free_count_;
 }
 
-void DiskManager::LoadFreePageList() {
-    if (num_pages_ < 2) {
-        return;  // No free list page yet
+void DiskManager::EnsureFsmGroups(size_t num_groups) {
+    if (num_groups <= fsm_free_count_.size()) {
+        return;
     }
+    // New groups start with no free pages and a map page still to be written
+    fsm_bits_.resize(num_groups * FSM_WORDS, 0);
+    fsm_free_count_.resize(num_groups, 0);
+    fsm_hint_.resize(num_groups, 0);
+    fsm_dirty_.resize(num_groups, true);
+}
 
-    // Free list is stored in page 1
-    Page free_list_page;
-    try {
-        db_file_.seekg(1 * PAGE_SIZE, std::ios::beg);
-        db_file_.read(free_list_page.GetRawData(), PAGE_SIZE);
-        
-        if (db_file_.fail()) {
-            return;  // No free list yet
+void DiskManager::MarkFree(page_id_t page_id) {
+    size_t bit = page_id - FIRST_FSM_PAGE_ID;
+    uint64_t mask = 1ULL << (bit % 64);
+    if (fsm_bits_[bit / 64] & mask) {
+        return;
+    }
+    fsm_bits_[bit / 64] |= mask;
+
+    size_t group = bit / FSM_PAGE_BITS;
+    fsm_free_count_[group]++;
+    fsm_dirty_[group] = true;
+    free_count_++;
+    fsm_hint_[group] = std::min(fsm_hint_[group],
+                                static_cast<uint32_t>((bit % FSM_PAGE_BITS) / 64));
+    first_free_group_ = std::min(first_free_group_, group);
+}
+
+void DiskManager::MarkUsed(page_id_t page_id) {
+    size_t bit = page_id - FIRST_FSM_PAGE_ID;
+    uint64_t mask = 1ULL << (bit % 64);
+    if (!(fsm_bits_[bit / 64] & mask)) {
+        return;
+    }
+    fsm_bits_[bit / 64] &= ~mask;
+
+    size_t group = bit / FSM_PAGE_BITS;
+    fsm_free_count_[group]--;
+    fsm_dirty_[group] = true;
+    free_count_--;
+}
+
+void DiskManager::Flush() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        WriteFreeSpaceMap();
+    }
+
+    // Pages are never buffered in user space; make them durable
+    if (fdatasync(fd_) != 0) {
+        throw std::runtime_error("Failed to sync database file: " + db_filename_);
+    }
+}
+
+void DiskManager::LoadFreeSpaceMap() {
+    Page header_page;
+    if (PreadFull(fd_, header_page.GetRawData(), PAGE_SIZE, PageOffset(HEADER_PAGE_ID)) !=
+            static_cast<ssize_t>(PAGE_SIZE) ||
+        header_page.GetHeader()->page_type != PageType::HEADER) {
+        throw std::runtime_error("Invalid database header: " + db_filename_);
+    }
+
+    // Until told otherwise the file has room for exactly the pages in it
+    allocated_pages_ = num_pages_.load();
+
+    uint32_t version;
+    std::memcpy(&version, header_page.GetData() + HEADER_VERSION_OFFSET, sizeof(version));
+    if (version < DB_VERSION) {
+        MigrateFreePageList();
+        return;
+    }
+
+    page_id_t recorded_pages;
+    page_id_t recorded_allocated;
+    std::memcpy(&recorded_pages, header_page.GetData() + HEADER_NUM_PAGES_OFFSET,
+                sizeof(recorded_pages));
+    std::memcpy(&recorded_allocated, header_page.GetData() + HEADER_ALLOCATED_PAGES_OFFSET,
+                sizeof(recorded_allocated));
+    std::memcpy(&checkpoint_lsn_, header_page.GetData() + HEADER_CHECKPOINT_LSN_OFFSET,
+                sizeof(checkpoint_lsn_));
+    std::memcpy(&redo_lsn_, header_page.GetData() + HEADER_REDO_LSN_OFFSET, sizeof(redo_lsn_));
+    recorded_pages = std::max<page_id_t>(recorded_pages, FIRST_FSM_PAGE_ID + 1);
+    if (recorded_allocated != 0) {
+        // The file is preallocated past the pages in use, so its size says
+        // nothing about them; the recorded count is authoritative
+        num_pages_ = recorded_pages;
+    } else {
+        // Header from before allocated counts were kept: pages written past
+        // the recorded count are kept but treated as in use
+        ExtendNumPages(recorded_pages);
+    }
+    persisted_num_pages_ = recorded_pages;
+
+    page_id_t num_pages = num_pages_.load();
+    size_t num_groups = FsmGroup(num_pages - 1) + 1;
+    EnsureFsmGroups(num_groups);
+
+    Page fsm_page;
+    for (size_t group = 0; group < num_groups; ++group) {
+        page_id_t fsm_page_id = FsmPageId(group);
+        if (PreadFull(fd_, fsm_page.GetRawData(), PAGE_SIZE, PageOffset(fsm_page_id)) !=
+                static_cast<ssize_t>(PAGE_SIZE) ||
+            fsm_page.GetHeader()->page_type != PageType::FREE_SPACE_MAP ||
+            !fsm_page.VerifyChecksum()) {
+            // Lose the group's free pages rather than hand out live ones
+            std::cerr << "Warning: Free space map page " << fsm_page_id
+                      << " is unreadable, its free pages are not reused" << std::endl;
+            continue;
         }
+        std::memcpy(&fsm_bits_[group * FSM_WORDS], fsm_page.GetData(), PAGE_DATA_SIZE);
+        fsm_dirty_[group] = false;
+    }
 
-        PageHeader* header = free_list_page.GetHeader();
-        if (header->page_type != PageType::FREE_LIST) {
-            return;  // Not a free list page
+    // Never hand out map pages or pages past the end of the file
+    for (size_t group = 0; group < num_groups; ++group) {
+        fsm_bits_[group * FSM_WORDS] &= ~1ULL;
+    }
+    size_t end_bit = num_pages - FIRST_FSM_PAGE_ID;
+    if (end_bit % 64 != 0) {
+        fsm_bits_[end_bit / 64] &= (1ULL << (end_bit % 64)) - 1;
+    }
+    std::fill(fsm_bits_.begin() + (end_bit + 63) / 64, fsm_bits_.end(), 0);
+
+    for (size_t group = 0; group < num_groups; ++group) {
+        uint32_t count = 0;
+        for (size_t w = 0; w < FSM_WORDS; ++w) {
+            count += __builtin_popcountll(fsm_bits_[group * FSM_WORDS + w]);
         }
+        fsm_free_count_[group] = count;
+        free_count_ += count;
+    }
+}
 
-        // Read free page IDs
-        const char* data = free_list_page.GetData();
-        uint32_t count = header->num_records;
-        free_pages_.clear();
-        free_pages_.reserve(count);
+void DiskManager::MigrateFreePageList() {
+    // The second map page lands where a version 1 file keeps user data
+    page_id_t num_pages = num_pages_.load();
+    if (num_pages > FsmPageId(1)) {
+        throw std::runtime_error("Cannot migrate version 1 database with " +
+                                 std::to_string(num_pages) + " pages: " + db_filename_);
+    }
 
+    ExtendNumPages(FIRST_FSM_PAGE_ID + 1);
+    EnsureFsmGroups(1);
+
+    // Version 1 kept the free page ids as a list in page 1
+    Page free_list_page;
+    if (PreadFull(fd_, free_list_page.GetRawData(), PAGE_SIZE, PageOffset(FIRST_FSM_PAGE_ID)) ==
+            static_cast<ssize_t>(PAGE_SIZE) &&
+        free_list_page.GetHeader()->page_type == PageType::FREE_LIST) {
+        const char* data = free_list_page.GetData();
+        uint32_t count = std::min<uint32_t>(free_list_page.GetHeader()->num_records,
+                                            PAGE_DATA_SIZE / sizeof(page_id_t));
         for (uint32_t i = 0; i < count; ++i) {
             page_id_t page_id;
             std::memcpy(&page_id, data + i * sizeof(page_id_t), sizeof(page_id_t));
-            free_pages_.push_back(page_id);
+            if (page_id > FIRST_FSM_PAGE_ID && page_id < num_pages) {
+                MarkFree(page_id);
+            }
         }
-
-        std::cout << "Loaded " << count << " free pages" << std::endl;
-    } catch (...) {
-        // Ignore errors, start with empty free list
     }
+
+    // Rewrite page 1 and the header in the new format right away
+    persisted_num_pages_ = 0;
+    WriteFreeSpaceMap();
+    std::cout << "Migrated " << free_count_ << " free pages to the free space map" << std::endl;
 }
 
-void DiskManager::SaveFreePageList() {
-    // Create free list page
-    Page free_list_page;
-    PageHeader* header = free_list_page.GetHeader();
-    header->page_id = 1;
-    header->page_type = PageType::FREE_LIST;
-    header->num_records = free_pages_.size();
+void DiskManager::WriteFreeSpaceMap() {
+    // Only the map pages that changed since the last write go to disk
+    Page fsm_page;
+    for (size_t group = 0; group < fsm_dirty_.size(); ++group) {
+        if (!fsm_dirty_[group]) {
+            continue;
+        }
 
-    // Write free page IDs
-    char* data = free_list_page.GetData();
-    for (size_t i = 0; i < free_pages_.size(); ++i) {
-        std::memcpy(data + i * sizeof(page_id_t), &free_pages_[i], sizeof(page_id_t));
+        page_id_t fsm_page_id = FsmPageId(group);
+        fsm_page.Reset();
+        PageHeader* header = fsm_page.GetHeader();
+        header->page_id = fsm_page_id;
+        header->page_type = PageType::FREE_SPACE_MAP;
+        header->num_records = fsm_free_count_[group];
+        header->free_space = 0;
+        std::memcpy(fsm_page.GetData(), &fsm_bits_[group * FSM_WORDS], PAGE_DATA_SIZE);
+        fsm_page.UpdateChecksum();
+
+        if (PwriteFull(fd_, fsm_page.GetRawData(), PAGE_SIZE, PageOffset(fsm_page_id)) !=
+            static_cast<ssize_t>(PAGE_SIZE)) {
+            throw std::runtime_error("Failed to write free space map page " +
+                                     std::to_string(fsm_page_id));
+        }
+        fsm_dirty_[group] = false;
     }
 
-    free_list_page.UpdateChecksum();
-
-    db_file_.seekp(1 * PAGE_SIZE, std::ios::beg);
-    db_file_.write(free_list_page.GetRawData(), PAGE_SIZE);
-    db_file_.flush();
-
-    // Ensure num_pages_ accounts for free list page
-    if (num_pages_ < 2) {
-        num_pages_ = 2;
+    if (num_pages_.load() != persisted_num_pages_ || header_dirty_) {
+        WriteHeaderPage();
     }
 }
 
-}  // namespace logicmaze
\ No newline at end of file
+}  // namespace logicmaze
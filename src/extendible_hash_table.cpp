@@ -0,0 +1,213 @@
+#include "extendible_hash_table.h"
+#include <cstring>
+#include <stdexcept>
+
+namespace logicmaze {
+
+namespace {
+
+inline uint8_t Fingerprint(uint64_t hash) {
+    return static_cast<uint8_t>(hash >> HASH_TABLE_FINGERPRINT_SHIFT);
+}
+
+}  // namespace
+
+std::string HashTablePositionKey(int32_t session_id, int32_t row_index, int32_t col_index) {
+    char key[12];
+    std::memcpy(key, &session_id, 4);
+    std::memcpy(key + 4, &row_index, 4);
+    std::memcpy(key + 8, &col_index, 4);
+    return std::string(key, sizeof(key));
+}
+
+ExtendibleHashTable::ExtendibleHashTable(BufferPoolManager* bpm)
+    : bpm_(bpm), header_depth_(HASH_TABLE_HEADER_MAX_DEPTH),
+      directory_page_ids_(new std::atomic<page_id_t>[1u << HASH_TABLE_HEADER_MAX_DEPTH]) {
+    // Directories and their buckets come with their first key
+    Page* page = NewIndexPage(&header_page_id_);
+    HashTableHeaderPage(page).Init(header_page_id_, header_depth_);
+    bpm_->UnpinPage(header_page_id_, true);
+    for (uint32_t i = 0; i < (1u << header_depth_); ++i) {
+        directory_page_ids_[i] = INVALID_PAGE_ID;
+    }
+}
+
+ExtendibleHashTable::ExtendibleHashTable(BufferPoolManager* bpm, page_id_t header_page_id)
+    : bpm_(bpm), header_page_id_(header_page_id) {
+    ReadPageGuard guard = FetchRead(header_page_id_);
+    if (guard.GetPage()->GetHeader()->page_type != PageType::INDEX) {
+        throw std::runtime_error("Page " + std::to_string(header_page_id) + " is not a hash table");
+    }
+    const HashTableHeaderPage header = HashTableHeaderPage::View(guard.GetPage());
+    header_depth_ = header.GetDepth();
+    directory_page_ids_.reset(new std::atomic<page_id_t>[header.GetSize()]);
+    for (uint32_t i = 0; i < header.GetSize(); ++i) {
+        directory_page_ids_[i] = header.GetDirectoryPageId(i);
+    }
+}
+
+bool ExtendibleHashTable::GetValue(const std::string& key, RID* rid) {
+    if (key.size() > HASH_TABLE_MAX_KEY_SIZE) {
+        return false;
+    }
+    uint64_t hash = HashTableHash(key.data(), key.size());
+    page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+    if (directory_page_id == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    ReadPageGuard directory_guard = FetchRead(directory_page_id);
+    const HashTableDirectoryPage directory = HashTableDirectoryPage::View(directory_guard.GetPage());
+    ReadPageGuard bucket_guard = FetchRead(directory.GetBucketPageId(directory.BucketIndex(hash)));
+    directory_guard.Release();
+    return HashTableBucketPage::View(bucket_guard.GetPage())
+        .Lookup(key.data(), static_cast<uint16_t>(key.size()), Fingerprint(hash), rid);
+}
+
+bool ExtendibleHashTable::Insert(const std::string& key, const RID& rid) {
+    if (key.empty() || key.size() > HASH_TABLE_MAX_KEY_SIZE) {
+        throw std::invalid_argument("Hash table keys must be 1 to " +
+                                    std::to_string(HASH_TABLE_MAX_KEY_SIZE) + " bytes");
+    }
+    uint64_t hash = HashTableHash(key.data(), key.size());
+    uint16_t key_size = static_cast<uint16_t>(key.size());
+    uint8_t fingerprint = Fingerprint(hash);
+    page_id_t directory_page_id = GetDirectoryPageId(hash, true);
+
+    {
+        ReadPageGuard directory_guard = FetchRead(directory_page_id);
+        const HashTableDirectoryPage directory = HashTableDirectoryPage::View(directory_guard.GetPage());
+        WritePageGuard bucket_guard = FetchWrite(directory.GetBucketPageId(directory.BucketIndex(hash)));
+        directory_guard.Release();
+        HashTableBucketPage bucket(bucket_guard.GetPage());
+        if (!bucket.IsFull()) {
+            return bucket.Insert(key.data(), key_size, fingerprint, rid);
+        }
+        // A full bucket is only split for a new key
+        RID existing;
+        if (bucket.Lookup(key.data(), key_size, fingerprint, &existing)) {
+            return false;
+        }
+    }
+
+    // Split with the directory write-latched, until the key's bucket has room
+    WritePageGuard directory_guard = FetchWrite(directory_page_id);
+    HashTableDirectoryPage directory(directory_guard.GetPage());
+    while (true) {
+        uint32_t index = directory.BucketIndex(hash);
+        WritePageGuard bucket_guard = FetchWrite(directory.GetBucketPageId(index));
+        HashTableBucketPage bucket(bucket_guard.GetPage());
+        if (!bucket.IsFull()) {
+            return bucket.Insert(key.data(), key_size, fingerprint, rid);
+        }
+
+        uint32_t local_depth = directory.GetLocalDepth(index);
+        if (local_depth == directory.GetGlobalDepth()) {
+            if (local_depth == HASH_TABLE_DIRECTORY_MAX_DEPTH) {
+                throw std::runtime_error("Hash table directory " + std::to_string(directory_page_id) +
+                                         " is full");
+            }
+            directory.Grow();
+        }
+        page_id_t new_bucket_page_id;
+        Page* new_page = NewIndexPage(&new_bucket_page_id);
+        HashTableBucketPage new_bucket(new_page);
+        new_bucket.Init(new_bucket_page_id);
+        bucket.MoveSplitTo(&new_bucket, local_depth);
+        directory.SplitBucket(index, new_bucket_page_id);
+        bpm_->UnpinPage(new_bucket_page_id, true);
+    }
+}
+
+bool ExtendibleHashTable::Remove(const std::string& key) {
+    if (key.size() > HASH_TABLE_MAX_KEY_SIZE) {
+        return false;
+    }
+    uint64_t hash = HashTableHash(key.data(), key.size());
+    page_id_t directory_page_id = GetDirectoryPageId(hash, false);
+    if (directory_page_id == INVALID_PAGE_ID) {
+        return false;
+    }
+
+    ReadPageGuard directory_guard = FetchRead(directory_page_id);
+    const HashTableDirectoryPage directory = HashTableDirectoryPage::View(directory_guard.GetPage());
+    WritePageGuard bucket_guard = FetchWrite(directory.GetBucketPageId(directory.BucketIndex(hash)));
+    directory_guard.Release();
+    return HashTableBucketPage(bucket_guard.GetPage())
+        .Remove(key.data(), static_cast<uint16_t>(key.size()), Fingerprint(hash));
+}
+
+size_t ExtendibleHashTable::GetBucketCount() {
+    size_t count = 0;
+    for (uint32_t i = 0; i < (1u << header_depth_); ++i) {
+        page_id_t directory_page_id = directory_page_ids_[i];
+        if (directory_page_id == INVALID_PAGE_ID) {
+            continue;
+        }
+        ReadPageGuard guard = FetchRead(directory_page_id);
+        const HashTableDirectoryPage directory = HashTableDirectoryPage::View(guard.GetPage());
+        // Count each bucket at its lowest slot
+        for (uint32_t slot = 0; slot < directory.GetSize(); ++slot) {
+            if (slot < (1u << directory.GetLocalDepth(slot))) {
+                count++;
+            }
+        }
+    }
+    return count;
+}
+
+ReadPageGuard ExtendibleHashTable::FetchRead(page_id_t page_id) {
+    ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for index page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+WritePageGuard ExtendibleHashTable::FetchWrite(page_id_t page_id) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for index page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+Page* ExtendibleHashTable::NewIndexPage(page_id_t* page_id) {
+    Page* page = bpm_->NewPage(page_id);
+    if (page == nullptr) {
+        throw std::runtime_error("No free frame for a new index page");
+    }
+    return page;
+}
+
+page_id_t ExtendibleHashTable::GetDirectoryPageId(uint64_t hash, bool create) {
+    uint32_t index = header_depth_ == 0 ? 0 : static_cast<uint32_t>(hash >> (64 - header_depth_));
+    page_id_t directory_page_id = directory_page_ids_[index].load(std::memory_order_acquire);
+    if (directory_page_id != INVALID_PAGE_ID || !create) {
+        return directory_page_id;
+    }
+
+    // Another insert may have made it since
+    WritePageGuard header_guard = FetchWrite(header_page_id_);
+    HashTableHeaderPage header(header_guard.GetPage());
+    directory_page_id = header.GetDirectoryPageId(index);
+    if (directory_page_id == INVALID_PAGE_ID) {
+        page_id_t bucket_page_id;
+        Page* bucket_page = NewIndexPage(&bucket_page_id);
+        HashTableBucketPage(bucket_page).Init(bucket_page_id);
+        bpm_->UnpinPage(bucket_page_id, true);
+
+        Page* directory_page = bpm_->NewPage(&directory_page_id);
+        if (directory_page == nullptr) {
+            bpm_->DeletePage(bucket_page_id);
+            throw std::runtime_error("No free frame for a new index page");
+        }
+        HashTableDirectoryPage(directory_page).Init(directory_page_id, bucket_page_id);
+        bpm_->UnpinPage(directory_page_id, true);
+        header.SetDirectoryPageId(index, directory_page_id);
+    }
+    directory_page_ids_[index].store(directory_page_id, std::memory_order_release);
+    return directory_page_id;
+}
+
+}  // namespace logicmaze
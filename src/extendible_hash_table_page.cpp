@@ -0,0 +1,196 @@
+#include "extendible_hash_table_page.h"
+#include <cstring>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define LOGICMAZE_HAVE_SSE2 1
+#endif
+
+namespace logicmaze {
+
+namespace {
+
+inline uint64_t Rotl(uint64_t value, int bits) {
+    return (value << bits) | (value >> (64 - bits));
+}
+
+inline uint64_t MixWord(uint64_t word) {
+    word *= 0x87C37B91114253D5ULL;
+    word = Rotl(word, 31);
+    return word * 0x4CF5AD432745937FULL;
+}
+
+void InitIndexPage(Page* page, page_id_t page_id) {
+    page->Reset();
+    page->GetHeader()->page_id = page_id;
+    page->GetHeader()->page_type = PageType::INDEX;
+}
+
+}  // namespace
+
+uint64_t HashTableHash(const char* key, size_t size) {
+    uint64_t hash = 0x9E3779B97F4A7C15ULL ^ (size * 0xC6A4A7935BD1E995ULL);
+    size_t offset = 0;
+    for (; offset + 8 <= size; offset += 8) {
+        uint64_t word;
+        std::memcpy(&word, key + offset, 8);
+        hash ^= MixWord(word);
+        hash = Rotl(hash, 27) * 5 + 0x52DCE729;
+    }
+    if (offset < size) {
+        uint64_t word = 0;
+        std::memcpy(&word, key + offset, size - offset);
+        hash ^= MixWord(word);
+    }
+
+    // MurmurHash3 finalizer
+    hash ^= hash >> 33;
+    hash *= 0xFF51AFD7ED558CCDULL;
+    hash ^= hash >> 33;
+    hash *= 0xC4CEB9FE1A85EC53ULL;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+void HashTableHeaderPage::Init(page_id_t page_id, uint32_t depth) {
+    static_assert(sizeof(Header) <= PAGE_DATA_SIZE, "Hash table header must fit a page");
+    InitIndexPage(page_, page_id);
+    GetHeader()->depth = depth;
+    for (uint32_t i = 0; i < GetSize(); ++i) {
+        GetHeader()->directory_page_ids[i] = INVALID_PAGE_ID;
+    }
+}
+
+void HashTableDirectoryPage::Init(page_id_t page_id, page_id_t bucket_page_id) {
+    static_assert(sizeof(Header) <= PAGE_DATA_SIZE, "Hash table directory must fit a page");
+    InitIndexPage(page_, page_id);
+    GetHeader()->global_depth = 0;
+    GetHeader()->bucket_page_ids[0] = bucket_page_id;
+    GetHeader()->local_depths[0] = 0;
+}
+
+void HashTableDirectoryPage::Grow() {
+    Header* header = GetHeader();
+    uint32_t size = GetSize();
+    std::memcpy(header->bucket_page_ids + size, header->bucket_page_ids, size * sizeof(page_id_t));
+    std::memcpy(header->local_depths + size, header->local_depths, size);
+    header->global_depth++;
+}
+
+void HashTableDirectoryPage::SplitBucket(uint32_t index, page_id_t new_bucket_page_id) {
+    Header* header = GetHeader();
+    uint32_t local_depth = header->local_depths[index];
+    uint32_t low_mask = (1u << local_depth) - 1;
+    uint32_t low_bits = index & low_mask;
+    // Every slot of the bucket, from the first one up in steps of its size
+    for (uint32_t slot = low_bits; slot < GetSize(); slot += 1u << local_depth) {
+        if (slot & (1u << local_depth)) {
+            header->bucket_page_ids[slot] = new_bucket_page_id;
+        }
+        header->local_depths[slot] = static_cast<uint8_t>(local_depth + 1);
+    }
+}
+
+void HashTableBucketPage::Init(page_id_t page_id) {
+    static_assert(sizeof(Header) <= PAGE_DATA_SIZE, "Hash table bucket must fit a page");
+    InitIndexPage(page_, page_id);
+    GetHeader()->size = 0;
+}
+
+uint32_t HashTableBucketPage::Find(const char* key, uint16_t key_size, uint8_t fingerprint) const {
+    const Header* header = GetHeader();
+    uint32_t size = header->size;
+#ifdef LOGICMAZE_HAVE_SSE2
+    const __m128i target = _mm_set1_epi8(static_cast<char>(fingerprint));
+    for (uint32_t base = 0; base < size; base += 16) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(header->fingerprints + base));
+        uint32_t matches = static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(block, target)));
+        if (size - base < 16) {
+            matches &= (1u << (size - base)) - 1;  // Slots past the end
+        }
+        while (matches != 0) {
+            uint32_t index = base + static_cast<uint32_t>(__builtin_ctz(matches));
+            const HashTableEntry& entry = header->entries[index];
+            if (entry.key_size == key_size && std::memcmp(entry.key, key, key_size) == 0) {
+                return index;
+            }
+            matches &= matches - 1;
+        }
+    }
+#else
+    for (uint32_t index = 0; index < size; ++index) {
+        if (header->fingerprints[index] != fingerprint) {
+            continue;
+        }
+        const HashTableEntry& entry = header->entries[index];
+        if (entry.key_size == key_size && std::memcmp(entry.key, key, key_size) == 0) {
+            return index;
+        }
+    }
+#endif
+    return size;
+}
+
+bool HashTableBucketPage::Lookup(const char* key, uint16_t key_size, uint8_t fingerprint,
+                                 RID* rid) const {
+    uint32_t index = Find(key, key_size, fingerprint);
+    if (index == GetSize()) {
+        return false;
+    }
+    *rid = EntryAt(index).rid;
+    return true;
+}
+
+bool HashTableBucketPage::Insert(const char* key, uint16_t key_size, uint8_t fingerprint,
+                                 const RID& rid) {
+    if (Find(key, key_size, fingerprint) != GetSize()) {
+        return false;
+    }
+    HashTableEntry entry;
+    entry.rid = rid;
+    entry.key_size = key_size;
+    std::memset(entry.key, 0, sizeof(entry.key));
+    std::memcpy(entry.key, key, key_size);
+    Append(entry, fingerprint);
+    return true;
+}
+
+bool HashTableBucketPage::Remove(const char* key, uint16_t key_size, uint8_t fingerprint) {
+    uint32_t index = Find(key, key_size, fingerprint);
+    if (index == GetSize()) {
+        return false;
+    }
+    RemoveAt(index);
+    return true;
+}
+
+void HashTableBucketPage::MoveSplitTo(HashTableBucketPage* recipient, uint32_t bit) {
+    uint32_t index = 0;
+    while (index < GetSize()) {
+        const HashTableEntry& entry = EntryAt(index);
+        if (HashTableHash(entry.key, entry.key_size) & (1ULL << bit)) {
+            recipient->Append(entry, GetHeader()->fingerprints[index]);
+            RemoveAt(index);  // Brings in the last entry, look at it next
+        } else {
+            index++;
+        }
+    }
+}
+
+void HashTableBucketPage::Append(const HashTableEntry& entry, uint8_t fingerprint) {
+    Header* header = GetHeader();
+    header->fingerprints[header->size] = fingerprint;
+    header->entries[header->size] = entry;
+    header->size++;
+}
+
+void HashTableBucketPage::RemoveAt(uint32_t index) {
+    // Order does not matter: fill the hole with the last entry
+    Header* header = GetHeader();
+    uint32_t last = header->size - 1;
+    header->fingerprints[index] = header->fingerprints[last];
+    header->entries[index] = header->entries[last];
+    header->size = last;
+}
+
+}  // namespace logicmaze
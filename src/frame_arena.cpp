@@ -0,0 +1,62 @@
+#include "frame_arena.h"
+#include <cerrno>
+#include <cstring>
+#include <new>
+#include <string>
+#include <sys/mman.h>
+
+namespace logicmaze {
+
+FrameArena::FrameArena(size_t num_frames, HugePageMode mode)
+    : frames_(nullptr), num_frames_(num_frames), mapped_size_(0), mode_(mode) {
+    size_t size = num_frames * PAGE_SIZE;
+    if (size == 0) {
+        return;
+    }
+
+    void* memory = MAP_FAILED;
+    if (mode_ == HugePageMode::EXPLICIT) {
+        // hugetlbfs mappings must be a whole number of huge pages
+        size_t huge_size = (size + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+        memory = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            mapped_size_ = huge_size;
+        } else {
+            mode_ = HugePageMode::TRANSPARENT;  // Nothing reserved, let THP try
+        }
+    }
+
+    if (memory == MAP_FAILED) {
+        memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+        if (memory == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        mapped_size_ = size;
+
+        if (mode_ == HugePageMode::TRANSPARENT && madvise(memory, size, MADV_HUGEPAGE) != 0) {
+            mode_ = HugePageMode::NONE;  // THP disabled in this kernel
+        }
+    }
+
+    // Zero-filled memory is a valid empty Page, no constructor needs to run
+    frames_ = static_cast<Page*>(memory);
+}
+
+FrameArena::~FrameArena() {
+    if (frames_ != nullptr) {
+        munmap(frames_, mapped_size_);
+    }
+}
+
+void FrameArena::Release(size_t first, size_t count) {
+    if (frames_ == nullptr || count == 0) {
+        return;
+    }
+    // Only a hint: hugetlb mappings reject ranges that are not huge-page
+    // aligned, and then the memory simply stays
+    madvise(frames_ + first, count * PAGE_SIZE, MADV_DONTNEED);
+}
+
+}  // namespace logicmaze
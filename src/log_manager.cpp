@@ -0,0 +1,297 @@
+#include "log_manager.h"
+#include "crc32c.h"
+#include "file_io.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+namespace logicmaze {
+
+namespace {
+
+// CRC32C of a whole record with its checksum field taken as zero
+uint32_t RecordChecksum(const char* record, size_t size) {
+    constexpr size_t offset = offsetof(LogRecordHeader, checksum);
+    constexpr size_t rest = offset + sizeof(uint32_t);
+    const uint32_t zero = 0;
+    uint32_t crc = Crc32c(record, offset);
+    crc = Crc32c(&zero, sizeof(zero), crc);
+    return Crc32c(record + rest, size - rest, crc);
+}
+
+}  // namespace
+
+LogManager::LogManager(const std::string& log_filename)
+    : log_filename_(log_filename), fd_(-1), buffer_(LOG_BUFFER_SIZE),
+      flush_buffer_(LOG_BUFFER_SIZE), buffer_used_(0), next_lsn_(INVALID_LSN),
+      flushing_(false), failed_(false), full_page_image_lsn_(INVALID_LSN),
+      flushed_lsn_(INVALID_LSN), sync_count_(0) {
+    fd_ = open(log_filename_.c_str(), O_RDWR | O_CREAT, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open log file: " + log_filename_ +
+                                 " (" + std::strerror(errno) + ")");
+    }
+
+    // Appends continue after the last intact record; whatever follows it
+    // was never acknowledged as durable
+    lsn_t end;
+    try {
+        LogReader reader(log_filename_);
+        LogRecord record;
+        while (reader.Next(&record)) {
+        }
+        end = reader.GetLSN();
+    } catch (...) {
+        close(fd_);
+        throw;
+    }
+
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0 ||
+        (static_cast<lsn_t>(file_stat.st_size) > end && ftruncate(fd_, end) != 0)) {
+        close(fd_);
+        throw std::runtime_error("Failed to truncate log file: " + log_filename_);
+    }
+
+    next_lsn_ = end;
+    flushed_lsn_ = end;
+    // Pages may have been written torn before the restart
+    full_page_image_lsn_ = end;
+}
+
+LogManager::~LogManager() {
+    try {
+        FlushAll();
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: " << e.what() << std::endl;
+    }
+    close(fd_);
+}
+
+lsn_t LogManager::AppendRecord(LogRecordType type, txn_id_t txn_id, page_id_t page_id,
+                               uint16_t offset, const char* data, size_t length) {
+    size_t size = sizeof(LogRecordHeader) + length;
+    if (size > LOG_BUFFER_SIZE) {
+        throw std::invalid_argument("Log record of " + std::to_string(size) +
+                                    " bytes does not fit the log buffer");
+    }
+
+    std::unique_lock<std::mutex> lock(latch_);
+    while (buffer_used_ + size > buffer_.size()) {
+        // Buffer full: write out what is in it (or wait for whoever is)
+        FlushLocked(next_lsn_, lock);
+    }
+
+    LogRecordHeader header;
+    header.size = static_cast<uint32_t>(size);
+    header.checksum = 0;
+    header.lsn = next_lsn_ + size;
+    header.txn_id = txn_id;
+    header.page_id = page_id;
+    header.offset = offset;
+    header.type = type;
+    header.padding = 0;
+
+    char* record = buffer_.data() + buffer_used_;
+    std::memcpy(record, &header, sizeof(header));
+    if (length > 0) {
+        std::memcpy(record + sizeof(header), data, length);
+    }
+    uint32_t checksum = RecordChecksum(record, size);
+    std::memcpy(record + offsetof(LogRecordHeader, checksum), &checksum, sizeof(checksum));
+
+    buffer_used_ += size;
+    next_lsn_ = header.lsn;
+
+    if (txn_id != INVALID_TXN_ID) {
+        if (type == LogRecordType::COMMIT || type == LogRecordType::ABORT) {
+            active_txns_.erase(txn_id);
+        } else {
+            active_txns_.emplace(txn_id, header.lsn - size);
+        }
+    }
+    return header.lsn;
+}
+
+lsn_t LogManager::LogUpdate(txn_id_t txn_id, page_id_t page_id, Page* page, size_t offset,
+                            size_t length) {
+    if (length == 0 || offset + length > PAGE_SIZE) {
+        throw std::out_of_range("Logged range is outside the page");
+    }
+    if (page->GetLSN() <= full_page_image_lsn_.load()) {
+        return LogPageImage(txn_id, page_id, page);
+    }
+    lsn_t lsn = AppendRecord(LogRecordType::UPDATE, txn_id, page_id, static_cast<uint16_t>(offset),
+                             page->GetRawData() + offset, length);
+    page->SetLSN(lsn);
+    return lsn;
+}
+
+lsn_t LogManager::LogPageImage(txn_id_t txn_id, page_id_t page_id, Page* page) {
+    lsn_t lsn = AppendRecord(LogRecordType::PAGE_IMAGE, txn_id, page_id, 0,
+                             page->GetRawData(), PAGE_SIZE);
+    page->SetLSN(lsn);
+    return lsn;
+}
+
+lsn_t LogManager::Commit(txn_id_t txn_id) {
+    lsn_t lsn = AppendRecord(LogRecordType::COMMIT, txn_id, INVALID_PAGE_ID, 0, nullptr, 0);
+    FlushUntil(lsn);
+    return lsn;
+}
+
+lsn_t LogManager::LogCheckpoint(lsn_t redo_lsn,
+                                const std::vector<std::pair<page_id_t, lsn_t>>& dirty_pages) {
+    std::vector<std::pair<txn_id_t, lsn_t>> active_txns = GetActiveTransactions();
+
+    // Only redo_lsn matters to recovery; keep the record within the log
+    // buffer by dropping dirty page entries if there are very many
+    size_t room = LOG_BUFFER_SIZE - sizeof(LogRecordHeader) - sizeof(CheckpointHeader);
+    size_t num_txns = std::min(active_txns.size(), room / sizeof(ActiveTxnEntry));
+    room -= num_txns * sizeof(ActiveTxnEntry);
+    size_t num_pages = std::min(dirty_pages.size(), room / sizeof(DirtyPageEntry));
+
+    std::vector<char> payload(sizeof(CheckpointHeader) + num_pages * sizeof(DirtyPageEntry) +
+                              num_txns * sizeof(ActiveTxnEntry));
+    CheckpointHeader header;
+    header.redo_lsn = redo_lsn;
+    header.num_dirty_pages = static_cast<uint32_t>(num_pages);
+    header.num_active_txns = static_cast<uint32_t>(num_txns);
+    char* out = payload.data();
+    std::memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (size_t i = 0; i < num_pages; ++i) {
+        DirtyPageEntry entry = {dirty_pages[i].first, 0, dirty_pages[i].second};
+        std::memcpy(out, &entry, sizeof(entry));
+        out += sizeof(entry);
+    }
+    for (size_t i = 0; i < num_txns; ++i) {
+        ActiveTxnEntry entry = {active_txns[i].first, active_txns[i].second};
+        std::memcpy(out, &entry, sizeof(entry));
+        out += sizeof(entry);
+    }
+
+    lsn_t lsn = AppendRecord(LogRecordType::CHECKPOINT, INVALID_TXN_ID, INVALID_PAGE_ID, 0,
+                             payload.data(), payload.size());
+    FlushUntil(lsn);
+    return lsn - sizeof(LogRecordHeader) - payload.size();
+}
+
+std::vector<std::pair<txn_id_t, lsn_t>> LogManager::GetActiveTransactions() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return std::vector<std::pair<txn_id_t, lsn_t>>(active_txns_.begin(), active_txns_.end());
+}
+
+void LogManager::FlushUntil(lsn_t lsn) {
+    if (flushed_lsn_.load() >= lsn) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(latch_);
+    FlushLocked(lsn, lock);
+}
+
+void LogManager::FlushLocked(lsn_t lsn, std::unique_lock<std::mutex>& lock) {
+    // A page can carry an LSN past the end of the log, when the log lost
+    // its tail or was started over; there is nothing beyond next_lsn_ to
+    // make durable
+    lsn = std::min(lsn, next_lsn_);
+    while (flushed_lsn_.load() < lsn) {
+        if (failed_) {
+            throw std::runtime_error("Log file is unusable after a failed write: " + log_filename_);
+        }
+        if (flushing_) {
+            // Someone else is writing; their batch or the next one covers us
+            flush_cv_.wait(lock);
+            continue;
+        }
+
+        // Lead the next batch: everything appended so far, written and synced
+        // without latch_ so appends continue into the other buffer
+        flushing_ = true;
+        std::swap(buffer_, flush_buffer_);
+        size_t bytes = buffer_used_;
+        lsn_t end = next_lsn_;
+        buffer_used_ = 0;
+
+        lock.unlock();
+        bool ok = PwriteFull(fd_, flush_buffer_.data(), bytes, static_cast<off_t>(end - bytes)) ==
+                      static_cast<ssize_t>(bytes) &&
+                  fdatasync(fd_) == 0;
+        lock.lock();
+
+        flushing_ = false;
+        if (ok) {
+            flushed_lsn_ = end;
+            sync_count_++;
+        } else {
+            // The batch is gone; later records must not land after a hole
+            failed_ = true;
+        }
+        flush_cv_.notify_all();
+    }
+}
+
+lsn_t LogManager::GetNextLSN() const {
+    std::lock_guard<std::mutex> lock(latch_);
+    return next_lsn_;
+}
+
+LogReader::LogReader(const std::string& log_filename)
+    : fd_(-1), lsn_(INVALID_LSN), window_(LOG_BUFFER_SIZE), window_start_(0), window_size_(0) {
+    fd_ = open(log_filename.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open log file: " + log_filename +
+                                 " (" + std::strerror(errno) + ")");
+    }
+}
+
+LogReader::~LogReader() {
+    close(fd_);
+}
+
+void LogReader::Seek(lsn_t lsn) {
+    lsn_ = lsn;
+}
+
+bool LogReader::Next(LogRecord* record) {
+    LogRecordHeader header;
+    if (!Load(lsn_, sizeof(header))) {
+        return false;
+    }
+    std::memcpy(&header, window_.data() + (lsn_ - window_start_), sizeof(header));
+    if (header.size < sizeof(header) || header.size > LOG_BUFFER_SIZE ||
+        !Load(lsn_, header.size)) {
+        return false;  // Garbage or torn
+    }
+
+    const char* data = window_.data() + (lsn_ - window_start_);
+    if (header.lsn != lsn_ + header.size || RecordChecksum(data, header.size) != header.checksum) {
+        return false;
+    }
+
+    record->header = header;
+    record->payload.assign(data + sizeof(header), data + header.size);
+    lsn_ = header.lsn;
+    return true;
+}
+
+bool LogReader::Load(lsn_t offset, size_t size) {
+    if (offset >= window_start_ && offset + size <= window_start_ + window_size_) {
+        return true;
+    }
+
+    ssize_t bytes = PreadFull(fd_, window_.data(), window_.size(), static_cast<off_t>(offset));
+    if (bytes < 0) {
+        throw std::runtime_error("Failed to read log file");
+    }
+    window_start_ = offset;
+    window_size_ = static_cast<size_t>(bytes);
+    return size <= window_size_;
+}
+
+}  // namespace logicmaze
@@ -0,0 +1,147 @@
+#include "../include/lru_k_replacer.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace logicmaze {
+
+LRUKReplacer::LRUKReplacer(size_t num_frames, size_t k, uint64_t correlated_period)
+    : k_(k),
+      correlated_period_(correlated_period),
+      current_timestamp_(0),
+      frames_(num_frames, FrameHistory{0, 0, false}),
+      history_(num_frames * k, 0) {
+    if (k_ == 0) {
+        throw std::invalid_argument("LRU-K needs K >= 1");
+    }
+}
+
+bool LRUKReplacer::Victim(frame_id_t* frame_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    if (infinite_.empty() && finite_.empty()) {
+        return false;  // No unpinned frames
+    }
+
+    // Skip frames whose burst is still open, i.e. whose next reference (at
+    // current_timestamp_ + 1) would still be correlated, unless all are
+    frame_id_t victim = FirstClosed(infinite_);
+    if (victim == INVALID_FRAME_ID) {
+        victim = FirstClosed(finite_);
+    }
+    if (victim == INVALID_FRAME_ID) {
+        victim = !infinite_.empty() ? infinite_.begin()->second : finite_.begin()->second;
+    }
+
+    ResetFrame(victim);
+    *frame_id = victim;
+    return true;
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    FrameHistory& frame = frames_[frame_id];
+    if (frame.evictable) {
+        RemoveEvictable(frame_id);
+        frame.evictable = false;
+    }
+    RecordAccess(frame_id);
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    FrameHistory& frame = frames_[frame_id];
+    if (!frame.evictable) {
+        frame.evictable = true;
+        AddEvictable(frame_id);
+    }
+}
+
+void LRUKReplacer::Remove(frame_id_t frame_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ResetFrame(frame_id);
+}
+
+size_t LRUKReplacer::Size() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return infinite_.size() + finite_.size();
+}
+
+void LRUKReplacer::ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    // Same ordering as Victim, ignoring the correlated reference period
+    frames->clear();
+    for (const EvictionSet* set : {&infinite_, &finite_}) {
+        for (auto it = set->begin(); it != set->end() && frames->size() < max; ++it) {
+            frames->push_back(it->second);
+        }
+    }
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id) {
+    uint64_t now = ++current_timestamp_;
+    FrameHistory& frame = frames_[frame_id];
+    uint64_t* history = History(frame_id);
+
+    if (frame.num_refs > 0 && now - frame.last_access <= correlated_period_) {
+        // Correlated reference, part of the same burst
+        frame.last_access = now;
+        return;
+    }
+
+    if (frame.num_refs > 0) {
+        // Close the previous burst: shift older references forward by its
+        // length so the burst counts as a single point in time
+        uint64_t correlation = frame.last_access - history[0];
+        for (size_t i = std::min(frame.num_refs, k_ - 1); i > 0; --i) {
+            history[i] = history[i - 1] + correlation;
+        }
+    }
+
+    history[0] = now;
+    frame.last_access = now;
+    if (frame.num_refs < k_) {
+        frame.num_refs++;
+    }
+}
+
+void LRUKReplacer::ResetFrame(frame_id_t frame_id) {
+    FrameHistory& frame = frames_[frame_id];
+    if (frame.evictable) {
+        RemoveEvictable(frame_id);
+    }
+    frame = FrameHistory{0, 0, false};
+}
+
+void LRUKReplacer::AddEvictable(frame_id_t frame_id) {
+    // A frame's history only changes while it is pinned, so its key stays
+    // put while it is in a set
+    if (frames_[frame_id].num_refs < k_) {
+        infinite_.emplace(History(frame_id)[0], frame_id);
+    } else {
+        finite_.emplace(History(frame_id)[k_ - 1], frame_id);
+    }
+}
+
+void LRUKReplacer::RemoveEvictable(frame_id_t frame_id) {
+    if (frames_[frame_id].num_refs < k_) {
+        infinite_.erase({History(frame_id)[0], frame_id});
+    } else {
+        finite_.erase({History(frame_id)[k_ - 1], frame_id});
+    }
+}
+
+frame_id_t LRUKReplacer::FirstClosed(const EvictionSet& frames) const {
+    // Each reference goes to one frame, so at most correlated_period_
+    // frames have an open burst and the scan stops soon
+    for (const auto& entry : frames) {
+        if (current_timestamp_ - frames_[entry.second].last_access >= correlated_period_) {
+            return entry.second;
+        }
+    }
+    return INVALID_FRAME_ID;
+}
+
+}  // namespace logicmaze
@@ -2,39 +2,34 @@
 
 namespace logicmaze {
 
-LRUReplacer::LRUReplacer(size_t num_frames) {
-    // Create dummy head and tail nodes
-    head_ = new Node(INVALID_FRAME_ID);
-    tail_ = new Node(INVALID_FRAME_ID);
-    head_->next = tail_;
-    tail_->prev = head_;
-}
-
-LRUReplacer::~LRUReplacer() {
-    // Clean up all nodes
-    Node* curr = head_;
-    while (curr != nullptr) {
-        Node* next = curr->next;
-        delete curr;
-        curr = next;
+LRUReplacer::LRUReplacer(size_t num_frames)
+    : nodes_(num_frames + 1),
+      sentinel_(static_cast<frame_id_t>(num_frames)),
+      size_(0) {
+    // Empty circular list: sentinel points at itself
+    // sentinel.next is the most recently used frame, sentinel.prev the least
+    for (Node& node : nodes_) {
+        node.prev = INVALID_FRAME_ID;
+        node.next = INVALID_FRAME_ID;
+        node.in_list = false;
     }
+    nodes_[sentinel_].prev = sentinel_;
+    nodes_[sentinel_].next = sentinel_;
 }
 
+LRUReplacer::~LRUReplacer() = default;
+
 bool LRUReplacer::Victim(frame_id_t* frame_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
     // Check if there are any evictable frames
-    if (tail_->prev == head_) {
+    if (size_ == 0) {
         return false;  // No unpinned frames
     }
 
     // Remove least recently used frame (at tail)
-    Node* victim_node = tail_->prev;
-    *frame_id = victim_node->frame_id;
-
-    RemoveNode(victim_node);
-    node_map_.erase(*frame_id);
-    delete victim_node;
+    *frame_id = nodes_[sentinel_].prev;
+    RemoveNode(*frame_id);
 
     return true;
 }
@@ -42,50 +37,59 @@ bool LRUReplacer::Victim(frame_id_t* frame_id) {
 void LRUReplacer::Pin(frame_id_t frame_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto it = node_map_.find(frame_id);
-    if (it == node_map_.end()) {
+    if (!nodes_[frame_id].in_list) {
         return;  // Frame not in replacer
     }
 
     // Remove from list (pinned frames are not tracked)
-    Node* node = it->second;
-    RemoveNode(node);
-    node_map_.erase(it);
-    delete node;
+    RemoveNode(frame_id);
 }
 
 void LRUReplacer::Unpin(frame_id_t frame_id) {
     std::lock_guard<std::mutex> lock(mutex_);
 
-    auto it = node_map_.find(frame_id);
-    if (it != node_map_.end()) {
+    if (nodes_[frame_id].in_list) {
         // Frame already in replacer, move to front (most recently used)
-        Node* node = it->second;
-        RemoveNode(node);
-        AddToFront(node);
-    } else {
-        // Add new unpinned frame to front
-        Node* node = new Node(frame_id);
-        AddToFront(node);
-        node_map_[frame_id] = node;
+        RemoveNode(frame_id);
     }
+    AddToFront(frame_id);
 }
 
 size_t LRUReplacer::Size() const {
     std::lock_guard<std::mutex> lock(mutex_);
-    return node_map_.size();
+    return size_;
+}
+
+void LRUReplacer::ColdestFrames(size_t max, std::vector<frame_id_t>* frames) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+
+    frames->clear();
+    // Walk from the tail towards the most recently used end
+    for (frame_id_t id = nodes_[sentinel_].prev; id != sentinel_ && frames->size() < max;
+         id = nodes_[id].prev) {
+        frames->push_back(id);
+    }
 }
 
-void LRUReplacer::RemoveNode(Node* node) {
-    node->prev->next = node->next;
-    node->next->prev = node->prev;
+void LRUReplacer::RemoveNode(frame_id_t frame_id) {
+    Node& node = nodes_[frame_id];
+    nodes_[node.prev].next = node.next;
+    nodes_[node.next].prev = node.prev;
+    node.prev = INVALID_FRAME_ID;
+    node.next = INVALID_FRAME_ID;
+    node.in_list = false;
+    size_--;
 }
 
-void LRUReplacer::AddToFront(Node* node) {
-    node->next = head_->next;
-    node->prev = head_;
-    head_->next->prev = node;
-    head_->next = node;
+void LRUReplacer::AddToFront(frame_id_t frame_id) {
+    Node& node = nodes_[frame_id];
+    Node& head = nodes_[sentinel_];
+    node.next = head.next;
+    node.prev = sentinel_;
+    nodes_[head.next].prev = frame_id;
+    head.next = frame_id;
+    node.in_list = true;
+    size_++;
 }
 
-}  // namespace logicmaze
\ No newline at end of file
+}  // namespace logicmaze
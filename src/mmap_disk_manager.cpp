@@ -0,0 +1,114 @@
+#include "mmap_disk_manager.h"
+#include "file_io.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+namespace logicmaze {
+
+MmapDiskManager::MmapDiskManager(const std::string& db_filename)
+    : db_filename_(db_filename), fd_(-1), data_(nullptr), num_pages_(0) {
+    fd_ = open(db_filename_.c_str(), O_RDONLY);
+    if (fd_ < 0) {
+        throw std::runtime_error("Failed to open database file: " + db_filename_ +
+                                 " (" + std::strerror(errno) + ")");
+    }
+
+    struct stat file_stat;
+    if (fstat(fd_, &file_stat) != 0) {
+        close(fd_);
+        throw std::runtime_error("Failed to stat database file: " + db_filename_);
+    }
+    num_pages_ = file_stat.st_size / PAGE_SIZE;
+
+    // Preallocated pages past the ones in use are left out of the mapping
+    Page header_page;
+    if (num_pages_ > 0 &&
+        PreadFull(fd_, header_page.GetRawData(), PAGE_SIZE, 0) == static_cast<ssize_t>(PAGE_SIZE) &&
+        header_page.GetHeader()->page_type == PageType::HEADER) {
+        const char* data = header_page.GetData();
+        uint32_t version;
+        page_id_t used_pages;
+        page_id_t allocated_pages;
+        std::memcpy(&version, data + HEADER_VERSION_OFFSET, sizeof(version));
+        std::memcpy(&used_pages, data + HEADER_NUM_PAGES_OFFSET, sizeof(used_pages));
+        std::memcpy(&allocated_pages, data + HEADER_ALLOCATED_PAGES_OFFSET, sizeof(allocated_pages));
+        if (version >= DB_VERSION && allocated_pages != 0) {
+            num_pages_ = std::min(num_pages_, used_pages);
+        }
+    }
+
+    if (num_pages_ == 0) {
+        return;  // Nothing to map
+    }
+
+    // The mapping is OS-page aligned, so every Page view is suitably aligned
+    void* mapping = mmap(nullptr, static_cast<size_t>(num_pages_) * PAGE_SIZE,
+                         PROT_READ, MAP_SHARED, fd_, 0);
+    if (mapping == MAP_FAILED) {
+        int error = errno;
+        close(fd_);
+        throw std::runtime_error("Failed to map database file: " + db_filename_ +
+                                 " (" + std::strerror(error) + ")");
+    }
+    data_ = static_cast<const char*>(mapping);
+}
+
+MmapDiskManager::~MmapDiskManager() {
+    if (data_ != nullptr) {
+        munmap(const_cast<char*>(data_), static_cast<size_t>(num_pages_) * PAGE_SIZE);
+    }
+    if (fd_ >= 0) {
+        close(fd_);
+    }
+}
+
+const Page* MmapDiskManager::GetPage(page_id_t page_id) const {
+    if (page_id >= num_pages_) {
+        throw std::out_of_range("Page ID out of range: " + std::to_string(page_id));
+    }
+    return reinterpret_cast<const Page*>(data_ + static_cast<size_t>(page_id) * PAGE_SIZE);
+}
+
+void MmapDiskManager::ReadPage(page_id_t page_id, Page* page) const {
+    std::memcpy(page->GetRawData(), GetPage(page_id)->GetRawData(), PAGE_SIZE);
+}
+
+void MmapDiskManager::Advise(AccessPattern pattern) {
+    int advice = MADV_NORMAL;
+    switch (pattern) {
+        case AccessPattern::SEQUENTIAL:
+            advice = MADV_SEQUENTIAL;
+            break;
+        case AccessPattern::RANDOM:
+            advice = MADV_RANDOM;
+            break;
+        case AccessPattern::NORMAL:
+        default:
+            break;
+    }
+    Madvise(0, num_pages_, advice);
+}
+
+void MmapDiskManager::WillNeed(page_id_t first, size_t count) {
+    if (first >= num_pages_) {
+        return;
+    }
+    Madvise(first, std::min<size_t>(count, num_pages_ - first), MADV_WILLNEED);
+}
+
+void MmapDiskManager::Madvise(page_id_t first, size_t count, int advice) {
+    if (data_ == nullptr || count == 0) {
+        return;
+    }
+    // Only a hint; a kernel that ignores it is not an error
+    madvise(const_cast<char*>(data_) + static_cast<size_t>(first) * PAGE_SIZE,
+            count * PAGE_SIZE, advice);
+}
+
+}  // namespace logicmaze
@@ -0,0 +1,74 @@
+#include "page_guard.h"
+#include "buffer_pool_manager.h"
+
+namespace logicmaze {
+
+ReadPageGuard::ReadPageGuard(BufferPoolManager* bpm, Page* page, page_id_t page_id,
+                             std::shared_mutex* latch)
+    : bpm_(bpm), page_(page), page_id_(page_id), latch_(latch) {}
+
+ReadPageGuard::~ReadPageGuard() {
+    Release();
+}
+
+ReadPageGuard::ReadPageGuard(ReadPageGuard&& other) noexcept
+    : bpm_(other.bpm_), page_(other.page_), page_id_(other.page_id_), latch_(other.latch_) {
+    other.page_ = nullptr;
+}
+
+ReadPageGuard& ReadPageGuard::operator=(ReadPageGuard&& other) noexcept {
+    if (this != &other) {
+        Release();
+        bpm_ = other.bpm_;
+        page_ = other.page_;
+        page_id_ = other.page_id_;
+        latch_ = other.latch_;
+        other.page_ = nullptr;
+    }
+    return *this;
+}
+
+void ReadPageGuard::Release() {
+    if (page_ == nullptr) {
+        return;  // Empty or moved-from
+    }
+    latch_->unlock_shared();
+    bpm_->UnpinPage(page_id_, false);
+    page_ = nullptr;
+}
+
+WritePageGuard::WritePageGuard(BufferPoolManager* bpm, Page* page, page_id_t page_id,
+                               std::shared_mutex* latch)
+    : bpm_(bpm), page_(page), page_id_(page_id), latch_(latch) {}
+
+WritePageGuard::~WritePageGuard() {
+    Release();
+}
+
+WritePageGuard::WritePageGuard(WritePageGuard&& other) noexcept
+    : bpm_(other.bpm_), page_(other.page_), page_id_(other.page_id_), latch_(other.latch_) {
+    other.page_ = nullptr;
+}
+
+WritePageGuard& WritePageGuard::operator=(WritePageGuard&& other) noexcept {
+    if (this != &other) {
+        Release();
+        bpm_ = other.bpm_;
+        page_ = other.page_;
+        page_id_ = other.page_id_;
+        latch_ = other.latch_;
+        other.page_ = nullptr;
+    }
+    return *this;
+}
+
+void WritePageGuard::Release() {
+    if (page_ == nullptr) {
+        return;  // Empty or moved-from
+    }
+    latch_->unlock();
+    bpm_->UnpinPage(page_id_, true);
+    page_ = nullptr;
+}
+
+}  // namespace logicmaze
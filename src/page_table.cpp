@@ -0,0 +1,79 @@
+#include "page_table.h"
+#include <stdexcept>
+
+namespace logicmaze {
+
+PageTable::PageTable(size_t max_entries) : size_(0) {
+    // Keep the load factor at or below 50% so probe sequences stay short
+    size_t capacity = 16;
+    unsigned bits = 4;
+    while (capacity < max_entries * 2) {
+        capacity <<= 1;
+        bits++;
+    }
+
+    slots_.assign(capacity, Slot{INVALID_PAGE_ID, INVALID_FRAME_ID});
+    mask_ = capacity - 1;
+    shift_ = 64 - bits;
+}
+
+frame_id_t PageTable::Find(page_id_t page_id) const {
+    for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+        const Slot& slot = slots_[i];
+        if (slot.page_id == page_id) {
+            return slot.frame_id;
+        }
+        if (slot.page_id == INVALID_PAGE_ID) {
+            return INVALID_FRAME_ID;
+        }
+    }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+    for (size_t i = Home(page_id);; i = (i + 1) & mask_) {
+        Slot& slot = slots_[i];
+        if (slot.page_id == page_id) {
+            slot.frame_id = frame_id;
+            return;
+        }
+        if (slot.page_id == INVALID_PAGE_ID) {
+            if (size_ + 1 > slots_.size() / 2) {
+                throw std::length_error("Page table is full");
+            }
+            slot.page_id = page_id;
+            slot.frame_id = frame_id;
+            size_++;
+            return;
+        }
+    }
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+    size_t i = Home(page_id);
+    while (slots_[i].page_id != page_id) {
+        if (slots_[i].page_id == INVALID_PAGE_ID) {
+            return false;  // Not mapped
+        }
+        i = (i + 1) & mask_;
+    }
+
+    // Backward-shift deletion: pull later entries of the probe chain into
+    // the hole so no tombstones are needed
+    size_t hole = i;
+    for (size_t j = (hole + 1) & mask_; slots_[j].page_id != INVALID_PAGE_ID; j = (j + 1) & mask_) {
+        size_t home = Home(slots_[j].page_id);
+        // Move the entry if its home is not cyclically within (hole, j]
+        bool in_range = (hole <= j) ? (hole < home && home <= j)
+                                    : (hole < home || home <= j);
+        if (!in_range) {
+            slots_[hole] = slots_[j];
+            hole = j;
+        }
+    }
+
+    slots_[hole] = Slot{INVALID_PAGE_ID, INVALID_FRAME_ID};
+    size_--;
+    return true;
+}
+
+}  // namespace logicmaze
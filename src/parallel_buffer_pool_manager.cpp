@@ -0,0 +1,218 @@
+#include "parallel_buffer_pool_manager.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace logicmaze {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager* disk_manager,
+                                                     const BufferPoolOptions& options)
+    : disk_manager_(disk_manager),
+      read_ahead_limit_(options.read_ahead_pages),
+      read_ahead_pages_(std::min(options.read_ahead_pages, num_instances * pool_size / 4)),
+      last_fetch_page_id_(INVALID_PAGE_ID),
+      sequential_run_(0),
+      read_ahead_end_(0) {
+    if (num_instances == 0) {
+        throw std::invalid_argument("ParallelBufferPoolManager needs at least one instance");
+    }
+
+    instances_.reserve(num_instances);
+    for (size_t i = 0; i < num_instances; ++i) {
+        // Each instance keeps its own warm-up list
+        BufferPoolOptions instance_options = options;
+        // Read-ahead is driven from here, over the pages of every instance
+        instance_options.read_ahead_pages = 0;
+        if (!options.warm_up_file.empty()) {
+            instance_options.warm_up_file = options.warm_up_file + "." + std::to_string(i);
+        }
+        instances_.push_back(new BufferPoolManager(pool_size, disk_manager_, instance_options));
+    }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+    for (BufferPoolManager* instance : instances_) {
+        delete instance;
+    }
+}
+
+Page* ParallelBufferPoolManager::FetchPage(page_id_t page_id) {
+    ReadAhead(page_id);
+    return GetInstance(page_id)->FetchPage(page_id);
+}
+
+bool ParallelBufferPoolManager::UnpinPage(page_id_t page_id, bool is_dirty) {
+    return GetInstance(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPage(page_id_t page_id) {
+    return GetInstance(page_id)->FlushPage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPages() {
+    for (BufferPoolManager* instance : instances_) {
+        instance->FlushAllPages();
+    }
+}
+
+Page* ParallelBufferPoolManager::NewPage(page_id_t* page_id) {
+    // The disk manager hands out the id, which in turn decides the instance
+    page_id_t new_page_id = disk_manager_->AllocatePage();
+
+    Page* page = GetInstance(new_page_id)->NewPageWithId(new_page_id);
+    if (page == nullptr) {
+        // Owning instance is fully pinned, give the id back
+        disk_manager_->DeallocatePage(new_page_id);
+        return nullptr;
+    }
+
+    *page_id = new_page_id;
+    return page;
+}
+
+bool ParallelBufferPoolManager::DeletePage(page_id_t page_id) {
+    return GetInstance(page_id)->DeletePage(page_id);
+}
+
+ReadPageGuard ParallelBufferPoolManager::FetchPageRead(page_id_t page_id) {
+    ReadAhead(page_id);
+    return GetInstance(page_id)->FetchPageRead(page_id);
+}
+
+WritePageGuard ParallelBufferPoolManager::FetchPageWrite(page_id_t page_id) {
+    ReadAhead(page_id);
+    return GetInstance(page_id)->FetchPageWrite(page_id);
+}
+
+size_t ParallelBufferPoolManager::Prefetch(page_id_t first, size_t count) {
+    page_id_t num_pages = disk_manager_->GetNumPages();
+    if (first >= num_pages) {
+        return 0;
+    }
+    count = std::min<size_t>(count, num_pages - first);
+    size_t issued = 0;
+    for (size_t i = 0; i < count; ++i) {
+        issued += GetInstance(first + i)->Prefetch(first + i, 1);
+    }
+    return issued;
+}
+
+void ParallelBufferPoolManager::Resize(size_t pool_size) {
+    for (BufferPoolManager* instance : instances_) {
+        instance->Resize(pool_size);
+    }
+    read_ahead_pages_ = std::min(read_ahead_limit_, GetPoolSize() / 4);
+}
+
+void ParallelBufferPoolManager::ReadAhead(page_id_t page_id) {
+    size_t window = read_ahead_pages_.load(std::memory_order_relaxed);
+    if (window == 0) {
+        return;
+    }
+    page_id_t previous = last_fetch_page_id_.exchange(page_id, std::memory_order_relaxed);
+    size_t run = page_id == previous + 1 ? sequential_run_.load(std::memory_order_relaxed) + 1 : 1;
+    sequential_run_.store(run, std::memory_order_relaxed);
+    if (run == 1) {
+        read_ahead_end_.store(0, std::memory_order_relaxed);  // A new run, see BufferPoolManager
+    }
+    if (run < READ_AHEAD_TRIGGER) {
+        return;
+    }
+
+    // Same window as BufferPoolManager::ReadAhead, ending at the end of the
+    // file; of concurrent fetches only the one that moves its end tops it up
+    page_id_t end = read_ahead_end_.load(std::memory_order_relaxed);
+    if (end > page_id && end - page_id > window / 2) {
+        return;
+    }
+    page_id_t window_end = static_cast<page_id_t>(std::min<uint64_t>(
+        static_cast<uint64_t>(page_id) + 1 + window, disk_manager_->GetNumPages()));
+    if (window_end <= page_id) {
+        return;
+    }
+    if (!read_ahead_end_.compare_exchange_strong(end, window_end, std::memory_order_relaxed)) {
+        return;
+    }
+    page_id_t start = std::max(page_id + 1, end);
+    if (start < window_end) {
+        Prefetch(start, window_end - start);
+    }
+}
+
+size_t ParallelBufferPoolManager::Checkpoint() {
+    LogManager* log_manager = instances_[0]->log_manager_;
+    if (log_manager == nullptr) {
+        throw std::logic_error("Checkpoint needs a buffer pool with a log manager");
+    }
+    std::lock_guard<std::mutex> checkpoint_lock(checkpoint_mutex_);
+
+    lsn_t start_lsn = log_manager->GetNextLSN();
+    log_manager->SetFullPageImageLSN(start_lsn);
+
+    size_t written = 0;
+    for (BufferPoolManager* instance : instances_) {
+        written += instance->CheckpointWriteBack();
+    }
+    std::vector<std::pair<page_id_t, lsn_t>> dirty_pages;
+    lsn_t redo_lsn = start_lsn;
+    for (BufferPoolManager* instance : instances_) {
+        redo_lsn = std::min(redo_lsn, instance->SnapshotDirtyPages(&dirty_pages));
+    }
+
+    disk_manager_->Flush();
+    lsn_t checkpoint_lsn = log_manager->LogCheckpoint(redo_lsn, dirty_pages);
+    disk_manager_->SetCheckpoint(checkpoint_lsn, redo_lsn);
+    disk_manager_->Flush();
+    return written;
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetPoolSize();
+    }
+    return total;
+}
+
+size_t ParallelBufferPoolManager::GetHitCount() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetHitCount();
+    }
+    return total;
+}
+
+size_t ParallelBufferPoolManager::GetMissCount() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetMissCount();
+    }
+    return total;
+}
+
+size_t ParallelBufferPoolManager::GetPrefetchCount() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetPrefetchCount();
+    }
+    return total;
+}
+
+size_t ParallelBufferPoolManager::GetForegroundWriteCount() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetForegroundWriteCount();
+    }
+    return total;
+}
+
+size_t ParallelBufferPoolManager::GetBackgroundWriteCount() const {
+    size_t total = 0;
+    for (const BufferPoolManager* instance : instances_) {
+        total += instance->GetBackgroundWriteCount();
+    }
+    return total;
+}
+
+}  // namespace logicmaze
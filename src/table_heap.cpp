@@ -0,0 +1,202 @@
+#include "table_heap.h"
+#include <stdexcept>
+#include <string>
+
+namespace logicmaze {
+
+TableIterator::TableIterator(BufferPoolManager* bpm, page_id_t page_id) : bpm_(bpm) {
+    guard_ = bpm_->FetchPageRead(page_id);
+    if (!guard_.IsValid()) {
+        throw std::runtime_error("No free frame to scan page " + std::to_string(page_id));
+    }
+    SeekLive();
+}
+
+void TableIterator::Next() {
+    slot_num_++;
+    SeekLive();
+}
+
+void TableIterator::SeekLive() {
+    while (guard_.IsValid()) {
+        const TablePage page = TablePage::View(guard_.GetPage());
+        for (; slot_num_ < page.GetSlotCount(); ++slot_num_) {
+            if (page.GetRecord(slot_num_, &data_, &size_)) {
+                return;
+            }
+        }
+
+        // Latch the next page before letting go of this one, so it cannot
+        // be unlinked in between
+        page_id_t next_page_id = page.GetNextPageId();
+        if (next_page_id == INVALID_PAGE_ID) {
+            guard_.Release();
+            return;
+        }
+        ReadPageGuard next = bpm_->FetchPageRead(next_page_id);
+        if (!next.IsValid()) {
+            throw std::runtime_error("No free frame to scan page " + std::to_string(next_page_id));
+        }
+        guard_ = std::move(next);
+        slot_num_ = 0;
+    }
+}
+
+TableHeap::TableHeap(BufferPoolManager* bpm) : bpm_(bpm) {
+    Page* page = bpm_->NewPage(&first_page_id_);
+    if (page == nullptr) {
+        throw std::runtime_error("No free frame for a new table page");
+    }
+    // Nobody else knows the page yet, no latch needed
+    TablePage(page).Init(first_page_id_, INVALID_PAGE_ID);
+    bpm_->UnpinPage(first_page_id_, true);
+    last_page_id_ = first_page_id_;
+}
+
+TableHeap::TableHeap(BufferPoolManager* bpm, page_id_t first_page_id)
+    : bpm_(bpm), first_page_id_(first_page_id), last_page_id_(first_page_id) {
+    // Find the end of the chain and the free space of every page for inserts
+    while (true) {
+        ReadPageGuard guard = FetchRead(last_page_id_);
+        const TablePage page = TablePage::View(guard.GetPage());
+        NoteFreeSpace(last_page_id_, page.GetFreeSpace());
+        page_id_t next_page_id = page.GetNextPageId();
+        if (next_page_id == INVALID_PAGE_ID) {
+            break;
+        }
+        last_page_id_ = next_page_id;
+    }
+}
+
+RID TableHeap::InsertRecord(const char* data, uint16_t size) {
+    if (size == 0 || size > TablePage::MAX_RECORD_SIZE) {
+        throw std::invalid_argument("Record size " + std::to_string(size) +
+                                    " does not fit a table page");
+    }
+
+    std::lock_guard<std::mutex> lock(append_mutex_);
+    uint16_t slot_num;
+    // A page whose free space went down meanwhile is noted with what it
+    // has now and not picked again for this record
+    uint32_t needed = size + sizeof(TableSlot);
+    page_id_t page_id;
+    while ((page_id = FindFreePage(needed)) != INVALID_PAGE_ID) {
+        WritePageGuard guard = FetchWrite(page_id);
+        TablePage page(guard.GetPage());
+        bool inserted = page.InsertRecord(data, size, &slot_num);
+        NoteFreeSpace(page_id, page.GetFreeSpace());
+        if (inserted) {
+            return RID(page_id, slot_num);
+        }
+    }
+
+    WritePageGuard guard = FetchWrite(last_page_id_);
+    if (!TablePage(guard.GetPage()).InsertRecord(data, size, &slot_num)) {
+        NoteFreeSpace(last_page_id_, TablePage(guard.GetPage()).GetFreeSpace());
+        guard = AppendPage(&guard);
+        bool inserted = TablePage(guard.GetPage()).InsertRecord(data, size, &slot_num);
+        (void)inserted;  // Always fits an empty page
+    }
+    NoteFreeSpace(guard.GetPageId(), TablePage(guard.GetPage()).GetFreeSpace());
+    return RID(guard.GetPageId(), slot_num);
+}
+
+bool TableHeap::GetRecord(const RID& rid, std::vector<char>* record) {
+    ReadPageGuard guard = FetchRead(rid.page_id);
+    const char* data;
+    uint16_t size;
+    if (!TablePage::View(guard.GetPage()).GetRecord(rid.slot_num, &data, &size)) {
+        return false;
+    }
+    record->assign(data, data + size);
+    return true;
+}
+
+bool TableHeap::DeleteRecord(const RID& rid) {
+    WritePageGuard guard = FetchWrite(rid.page_id);
+    TablePage page(guard.GetPage());
+    if (!page.DeleteRecord(rid.slot_num)) {
+        return false;
+    }
+    NoteFreeSpace(rid.page_id, page.GetFreeSpace());
+    return true;
+}
+
+bool TableHeap::UpdateRecord(const RID& rid, const char* data, uint16_t size) {
+    WritePageGuard guard = FetchWrite(rid.page_id);
+    TablePage page(guard.GetPage());
+    if (!page.UpdateRecord(rid.slot_num, data, size)) {
+        return false;
+    }
+    NoteFreeSpace(rid.page_id, page.GetFreeSpace());
+    return true;
+}
+
+TableIterator TableHeap::Begin() {
+    return TableIterator(bpm_, first_page_id_);
+}
+
+size_t TableHeap::GetPageCount() {
+    size_t count = 0;
+    page_id_t page_id = first_page_id_;
+    while (page_id != INVALID_PAGE_ID) {
+        ReadPageGuard guard = FetchRead(page_id);
+        page_id = TablePage::View(guard.GetPage()).GetNextPageId();
+        count++;
+    }
+    return count;
+}
+
+ReadPageGuard TableHeap::FetchRead(page_id_t page_id) {
+    ReadPageGuard guard = bpm_->FetchPageRead(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for table page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+WritePageGuard TableHeap::FetchWrite(page_id_t page_id) {
+    WritePageGuard guard = bpm_->FetchPageWrite(page_id);
+    if (!guard.IsValid()) {
+        throw std::runtime_error("No free frame for table page " + std::to_string(page_id));
+    }
+    return guard;
+}
+
+WritePageGuard TableHeap::AppendPage(WritePageGuard* last) {
+    page_id_t page_id;
+    Page* page = bpm_->NewPage(&page_id);
+    if (page == nullptr) {
+        throw std::runtime_error("No free frame for a new table page");
+    }
+    TablePage(page).Init(page_id, last_page_id_);
+    bpm_->UnpinPage(page_id, true);
+
+    // Link it while still holding the old last page
+    WritePageGuard guard = FetchWrite(page_id);
+    TablePage(last->GetPage()).SetNextPageId(page_id);
+    last->Release();
+    last_page_id_ = page_id;
+    return guard;
+}
+
+void TableHeap::NoteFreeSpace(page_id_t page_id, uint32_t free_space) {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    auto it = free_space_.find(page_id);
+    if (it != free_space_.end()) {
+        free_pages_.erase({it->second, page_id});
+        free_space_.erase(it);
+    }
+    if (free_space >= TABLE_PAGE_REUSE_SPACE) {
+        free_space_.emplace(page_id, free_space);
+        free_pages_.insert({free_space, page_id});
+    }
+}
+
+page_id_t TableHeap::FindFreePage(uint32_t size) {
+    std::lock_guard<std::mutex> lock(free_mutex_);
+    auto it = free_pages_.lower_bound({size, 0});
+    return it == free_pages_.end() ? INVALID_PAGE_ID : it->second;
+}
+
+}  // namespace logicmaze
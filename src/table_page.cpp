@@ -0,0 +1,171 @@
+#include "table_page.h"
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace logicmaze {
+
+void TablePage::Init(page_id_t page_id, page_id_t prev_page_id) {
+    page_->Reset();
+    PageHeader* header = page_->GetHeader();
+    header->page_id = page_id;
+    header->page_type = PageType::DATA;
+    header->num_records = 0;
+    header->free_space = PAGE_DATA_SIZE - sizeof(TablePageHeader);
+    header->free_space_offset = PAGE_DATA_SIZE;
+
+    TablePageHeader* table_header = GetTableHeader();
+    table_header->prev_page_id = prev_page_id;
+    table_header->next_page_id = INVALID_PAGE_ID;
+    table_header->slot_count = 0;
+    table_header->padding = 0;
+}
+
+bool TablePage::InsertRecord(const char* data, uint16_t size, uint16_t* slot_num) {
+    if (size == 0) {
+        return false;
+    }
+    PageHeader* header = page_->GetHeader();
+    TablePageHeader* table_header = GetTableHeader();
+
+    // Only look for an empty slot if some record was deleted
+    uint16_t slot = table_header->slot_count;
+    if (header->num_records < table_header->slot_count) {
+        const TableSlot* slots = GetSlots();
+        for (uint16_t i = 0; i < table_header->slot_count; ++i) {
+            if (slots[i].offset == 0) {
+                slot = i;
+                break;
+            }
+        }
+    }
+
+    bool new_slot = slot == table_header->slot_count;
+    size_t needed = size + (new_slot ? sizeof(TableSlot) : 0);
+    if (needed > header->free_space) {
+        return false;
+    }
+
+    if (new_slot) {
+        // Claim the slot before placing, so compaction leaves room for it
+        if (header->free_space_offset - SlotsEnd() < sizeof(TableSlot)) {
+            Compact();
+        }
+        GetSlots()[slot] = {0, 0};
+        table_header->slot_count++;
+        header->free_space -= sizeof(TableSlot);
+    }
+    GetSlots()[slot] = {PlaceRecord(data, size), size};
+    header->num_records++;
+    *slot_num = slot;
+    return true;
+}
+
+bool TablePage::GetRecord(uint16_t slot_num, const char** data, uint16_t* size) const {
+    if (slot_num >= GetSlotCount()) {
+        return false;
+    }
+    const TableSlot& slot = GetSlots()[slot_num];
+    if (slot.offset == 0) {
+        return false;
+    }
+    *data = page_->GetData() + slot.offset;
+    *size = slot.size;
+    return true;
+}
+
+bool TablePage::DeleteRecord(uint16_t slot_num) {
+    if (slot_num >= GetSlotCount() || GetSlots()[slot_num].offset == 0) {
+        return false;
+    }
+    PageHeader* header = page_->GetHeader();
+    TablePageHeader* table_header = GetTableHeader();
+    TableSlot* slots = GetSlots();
+
+    if (slots[slot_num].offset == header->free_space_offset) {
+        // Lowest record: the gap simply grows
+        header->free_space_offset += slots[slot_num].size;
+    }
+    header->free_space += slots[slot_num].size;
+    header->num_records--;
+    slots[slot_num] = {0, 0};
+
+    // Empty slots at the end of the directory can go; ids of the others
+    // do not change
+    while (table_header->slot_count > 0 && slots[table_header->slot_count - 1].offset == 0) {
+        table_header->slot_count--;
+        header->free_space += sizeof(TableSlot);
+    }
+    return true;
+}
+
+bool TablePage::UpdateRecord(uint16_t slot_num, const char* data, uint16_t size) {
+    if (size == 0 || slot_num >= GetSlotCount() || GetSlots()[slot_num].offset == 0) {
+        return false;
+    }
+    PageHeader* header = page_->GetHeader();
+    TableSlot& slot = GetSlots()[slot_num];
+
+    if (size <= slot.size) {
+        // Shrink in place; the tail becomes a hole
+        std::memmove(page_->GetData() + slot.offset, data, size);
+        header->free_space += slot.size - size;
+        slot.size = size;
+        return true;
+    }
+    if (size > header->free_space + slot.size) {
+        return false;
+    }
+
+    // Give up the old space, then place the new version like an insert.
+    // The caller's data may point into this page, so keep a copy.
+    std::vector<char> copy(data, data + size);
+    if (slot.offset == header->free_space_offset) {
+        header->free_space_offset += slot.size;
+    }
+    header->free_space += slot.size;
+    slot = {0, 0};
+    GetSlots()[slot_num] = {PlaceRecord(copy.data(), size), size};
+    return true;
+}
+
+void TablePage::Compact() {
+    PageHeader* header = page_->GetHeader();
+    TableSlot* slots = GetSlots();
+    char* data = page_->GetData();
+
+    // Slide records towards the end of the page, highest offset first, so
+    // a move never overwrites a record that has not moved yet
+    std::vector<uint16_t> order;
+    order.reserve(header->num_records);
+    for (uint16_t i = 0; i < GetSlotCount(); ++i) {
+        if (slots[i].offset != 0) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(),
+              [slots](uint16_t a, uint16_t b) { return slots[a].offset > slots[b].offset; });
+
+    size_t end = PAGE_DATA_SIZE;
+    for (uint16_t i : order) {
+        end -= slots[i].size;
+        if (end != slots[i].offset) {
+            std::memmove(data + end, data + slots[i].offset, slots[i].size);
+            slots[i].offset = static_cast<uint16_t>(end);
+        }
+    }
+    header->free_space_offset = static_cast<uint32_t>(end);
+}
+
+uint16_t TablePage::PlaceRecord(const char* data, uint16_t size) {
+    PageHeader* header = page_->GetHeader();
+    if (header->free_space_offset - SlotsEnd() < size) {
+        Compact();
+    }
+    header->free_space_offset -= size;
+    header->free_space -= size;
+    std::memcpy(page_->GetData() + header->free_space_offset, data, size);
+    return static_cast<uint16_t>(header->free_space_offset);
+}
+
+}  // namespace logicmaze
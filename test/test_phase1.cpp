@@ -1,13 +1,60 @@
 #include "../include/buffer_pool_manager.h"
+#include "../include/parallel_buffer_pool_manager.h"
+#include "../include/clock_replacer.h"
+#include "../include/lru_k_replacer.h"
+#include "../include/crc32c.h"
+#include "../include/mmap_disk_manager.h"
+#include "../include/log_manager.h"
+#include "../include/recovery_manager.h"
+#include "../include/table_heap.h"
+#include "../include/b_plus_tree.h"
+#include "../include/async_io.h"
+#include "../include/extendible_hash_table.h"
 #include <iostream>
 #include <cassert>
 #include <chrono>
 #include <random>
+#include <thread>
 #include <vector>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <functional>
+#include <future>
+#include <memory>
+#include <new>
+#include <set>
+#include <fcntl.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 using namespace logicmaze;
 using namespace std;
 
+// Count global heap allocations so tests can check allocation-free paths
+static atomic<size_t> g_allocation_count(0);
+
+void* operator new(size_t size) {
+    g_allocation_count.fetch_add(1, memory_order_relaxed);
+    void* ptr = malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw bad_alloc();
+    }
+    return ptr;
+}
+
+// Kept out of line so GCC does not flag the inlined free() as mismatched
+__attribute__((noinline)) void operator delete(void* ptr) noexcept {
+    free(ptr);
+}
+
+__attribute__((noinline)) void operator delete(void* ptr, size_t) noexcept {
+    free(ptr);
+}
+
 // Test 1: Basic Page Operations
 void TestBasicPageOperations() {
     cout << "\n=== Test 1: Basic Page Operations ===" << endl;
@@ -239,6 +286,3467 @@ void TestChecksumVerification() {
     cout << "Test 6 PASSED" << endl;
 }
 
+// Run cache-hit-only fetch/unpin traffic and return hits per second
+template <typename PoolType>
+double MeasureHitThroughput(PoolType& pool, const vector<page_id_t>& page_ids,
+                            int num_threads, int accesses_per_thread) {
+    vector<thread> workers;
+    auto start = chrono::high_resolution_clock::now();
+    
+    for (int t = 0; t < num_threads; ++t) {
+        workers.emplace_back([&pool, &page_ids, accesses_per_thread, t]() {
+            mt19937 gen(t + 1);
+            uniform_int_distribution<size_t> dis(0, page_ids.size() - 1);
+            for (int i = 0; i < accesses_per_thread; ++i) {
+                page_id_t page_id = page_ids[dis(gen)];
+                Page* page = pool.FetchPage(page_id);
+                assert(page != nullptr);
+                (void)page;
+                pool.UnpinPage(page_id, false);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    auto end = chrono::high_resolution_clock::now();
+    double seconds = chrono::duration<double>(end - start).count();
+    return (static_cast<double>(num_threads) * accesses_per_thread) / seconds;
+}
+
+// Test 7: Parallel Buffer Pool Hit Throughput
+void TestParallelHitThroughput() {
+    cout << "\n=== Test 7: Parallel Buffer Pool Hit Throughput ===" << endl;
+    
+    const size_t NUM_INSTANCES = 8;
+    const size_t FRAMES_PER_INSTANCE = 32;
+    const int NUM_PAGES = 128;  // Fits in either pool, so every access hits
+    const int ACCESSES_PER_THREAD = 50000;
+    
+    DiskManager disk_manager("test_parallel.db");
+    BufferPoolManager single_bpm(NUM_INSTANCES * FRAMES_PER_INSTANCE, &disk_manager);
+    ParallelBufferPoolManager parallel_bpm(NUM_INSTANCES, FRAMES_PER_INSTANCE, &disk_manager);
+    assert(parallel_bpm.GetPoolSize() == single_bpm.GetPoolSize());
+    
+    // Create pages through the parallel pool, then warm the single pool
+    vector<page_id_t> page_ids;
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        page_id_t page_id;
+        Page* page = parallel_bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        snprintf(page->GetData(), 100, "Parallel page %d", i);
+        parallel_bpm.UnpinPage(page_id, true);
+        page_ids.push_back(page_id);
+    }
+    parallel_bpm.FlushAllPages();
+    for (page_id_t page_id : page_ids) {
+        Page* page = single_bpm.FetchPage(page_id);
+        assert(page != nullptr);
+        single_bpm.UnpinPage(page_id, false);
+    }
+    
+    // Same page must come back with the same contents from either pool
+    Page* page = parallel_bpm.FetchPage(page_ids[7]);
+    assert(strcmp(page->GetData(), "Parallel page 7") == 0);
+    parallel_bpm.UnpinPage(page_ids[7], false);
+    cout << "✓ " << NUM_PAGES << " pages spread over " << parallel_bpm.GetNumInstances()
+         << " instances" << endl;
+    
+    cout << "  threads    single-latch hits/s    parallel hits/s" << endl;
+    for (int num_threads : {1, 2, 4, 8}) {
+        double single_rate = MeasureHitThroughput(single_bpm, page_ids, num_threads,
+                                                  ACCESSES_PER_THREAD);
+        double parallel_rate = MeasureHitThroughput(parallel_bpm, page_ids, num_threads,
+                                                    ACCESSES_PER_THREAD);
+        printf("  %7d    %19.0f    %15.0f\n", num_threads, single_rate, parallel_rate);
+    }
+    
+    assert(parallel_bpm.GetMissCount() == 0);
+    cout << "  Parallel pool hit rate: " << (parallel_bpm.GetHitRate() * 100) << "%" << endl;
+    
+    cout << "Test 7 PASSED" << endl;
+}
+
+// Test 8: Allocation-Free Hit Path
+void TestAllocationFreeHitPath() {
+    cout << "\n=== Test 8: Allocation-Free Hit Path ===" << endl;
+    
+    const int NUM_PAGES = 64;
+    const int NUM_ACCESSES = 1000000;
+    
+    DiskManager disk_manager("test_hitpath.db");
+    BufferPoolManager bpm(NUM_PAGES, &disk_manager);
+    
+    vector<page_id_t> page_ids;
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        page_id_t page_id;
+        Page* page = bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        bpm.UnpinPage(page_id, true);
+        page_ids.push_back(page_id);
+    }
+    
+    // Fetch/unpin resident pages only: page table lookup, pin, replacer
+    // relink and unpin must not touch the heap
+    size_t allocations_before = g_allocation_count.load();
+    auto start = chrono::high_resolution_clock::now();
+    
+    for (int i = 0; i < NUM_ACCESSES; ++i) {
+        page_id_t page_id = page_ids[(i * 7) % NUM_PAGES];
+        Page* page = bpm.FetchPage(page_id);
+        assert(page != nullptr);
+        (void)page;
+        bpm.UnpinPage(page_id, false);
+    }
+    
+    auto end = chrono::high_resolution_clock::now();
+    size_t allocations = g_allocation_count.load() - allocations_before;
+    double ns_per_hit = chrono::duration<double, nano>(end - start).count() / NUM_ACCESSES;
+    
+    cout << "✓ " << NUM_ACCESSES << " fetch/unpin hits, " << allocations
+         << " heap allocations" << endl;
+    cout << "  Average: " << ns_per_hit << " ns per hit" << endl;
+    assert(allocations == 0);
+    assert(bpm.GetMissCount() == 0);
+    
+    cout << "Test 8 PASSED" << endl;
+}
+
+// Test 9: CLOCK Replacer
+void TestClockReplacer() {
+    cout << "\n=== Test 9: CLOCK Replacer ===" << endl;
+    
+    // Second chance: frames referenced since the last sweep survive it
+    ClockReplacer replacer(4);
+    for (frame_id_t f = 0; f < 4; ++f) {
+        replacer.Unpin(f);
+    }
+    replacer.Pin(1);
+    assert(replacer.Size() == 3);
+    
+    frame_id_t victim;
+    bool found;
+    found = replacer.Victim(&victim);
+    assert(found && victim == 0);
+    replacer.Unpin(2);  // Re-referenced after the sweep, no double counting
+    assert(replacer.Size() == 2);
+    found = replacer.Victim(&victim);
+    assert(found && victim == 3);
+    found = replacer.Victim(&victim);
+    assert(found && victim == 2);
+    found = replacer.Victim(&victim);
+    assert(!found);
+    cout << "✓ Second-chance eviction order and pinning verified" << endl;
+    
+    // Same workload through LRU and CLOCK pools must return identical data
+    const int NUM_PAGES = 200;
+    const int NUM_ACCESSES = 20000;
+    DiskManager disk_manager("test_clock.db");
+    vector<page_id_t> page_ids;
+    {
+        BufferPoolManager bpm(NUM_PAGES, &disk_manager);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id;
+            Page* page = bpm.NewPage(&page_id);
+            reinterpret_cast<uint32_t*>(page->GetData())[0] = i;
+            bpm.UnpinPage(page_id, true);
+            page_ids.push_back(page_id);
+        }
+    }
+    
+    for (ReplacerType type : {ReplacerType::LRU, ReplacerType::CLOCK}) {
+        BufferPoolOptions options;
+        options.replacer_type = type;
+        BufferPoolManager bpm(50, &disk_manager, options);
+        
+        mt19937 gen(42);
+        uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_ACCESSES; ++i) {
+            int idx = dis(gen);
+            Page* page = bpm.FetchPage(page_ids[idx]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(idx));
+            bpm.UnpinPage(page_ids[idx], false);
+        }
+        auto end = chrono::high_resolution_clock::now();
+        
+        cout << "✓ " << (type == ReplacerType::LRU ? "LRU  " : "CLOCK") << ": "
+             << chrono::duration_cast<chrono::milliseconds>(end - start).count() << " ms, "
+             << "hit rate " << (bpm.GetHitRate() * 100) << "%" << endl;
+    }
+    
+    cout << "Test 9 PASSED" << endl;
+}
+
+// Draws ranks 0..n-1 with probability proportional to 1 / (rank + 1)^theta
+class ZipfianGenerator {
+public:
+    ZipfianGenerator(size_t n, double theta, uint32_t seed) : gen_(seed), dis_(0.0, 1.0) {
+        cdf_.reserve(n);
+        double sum = 0.0;
+        for (size_t i = 0; i < n; ++i) {
+            sum += 1.0 / pow(static_cast<double>(i + 1), theta);
+            cdf_.push_back(sum);
+        }
+        for (double& value : cdf_) {
+            value /= sum;
+        }
+    }
+
+    size_t Next() {
+        double u = dis_(gen_);
+        return lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin();
+    }
+
+private:
+    vector<double> cdf_;
+    mt19937 gen_;
+    uniform_real_distribution<double> dis_;
+};
+
+// Test 10: Scan Resistance (LRU vs CLOCK vs LRU-K)
+void TestScanResistance() {
+    cout << "\n=== Test 10: Scan Resistance ===" << endl;
+    
+    // LRU-K unit check: a frame referenced twice outlives frames seen once
+    LRUKReplacer replacer(3, 2, 0);
+    replacer.Pin(0);
+    replacer.Pin(0);  // Frame 0 now has a K-distance
+    replacer.Pin(1);
+    replacer.Pin(2);
+    for (frame_id_t f = 0; f < 3; ++f) {
+        replacer.Unpin(f);
+    }
+    frame_id_t victim;
+    bool found;
+    found = replacer.Victim(&victim);
+    assert(found && victim == 1);
+    found = replacer.Victim(&victim);
+    assert(found && victim == 2);
+    found = replacer.Victim(&victim);
+    assert(found && victim == 0);
+    cout << "✓ LRU-K evicts infinite-distance frames first" << endl;
+    
+    // Victims come from ordered sets, not a scan of every frame: draining
+    // a large replacer stays cheap and keeps the LRU-K order
+    {
+        const frame_id_t NUM_FRAMES = 1 << 18;
+        LRUKReplacer large(NUM_FRAMES);
+        for (frame_id_t f = 0; f < NUM_FRAMES; ++f) {
+            large.Pin(f);
+            large.Unpin(f);
+        }
+        for (frame_id_t f = 0; f < NUM_FRAMES; f += 2) {
+            large.Pin(f);  // Even frames get their K-th reference
+            large.Unpin(f);
+        }
+        auto start = chrono::high_resolution_clock::now();
+        for (frame_id_t i = 0; i < NUM_FRAMES; ++i) {
+            // Odd frames (one reference) first, then even ones, each oldest first
+            frame_id_t expected = i < NUM_FRAMES / 2 ? 2 * i + 1 : 2 * (i - NUM_FRAMES / 2);
+            found = large.Victim(&victim);
+            assert(found && victim == expected);
+            (void)expected;
+        }
+        double ns = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count();
+        found = large.Victim(&victim);
+        assert(!found);
+        cout << "✓ " << NUM_FRAMES << " LRU-K victims in order, " << static_cast<int>(ns / NUM_FRAMES)
+             << " ns each" << endl;
+    }
+    
+    const int NUM_PAGES = 1000;
+    const size_t POOL_SIZE = 100;
+    const int NUM_LOOKUPS = 60000;
+    const int SCAN_INTERVAL = 5000;  // Full scan after every N lookups
+    
+    DiskManager disk_manager("test_scan.db");
+    vector<page_id_t> page_ids;
+    {
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id;
+            Page* page = bpm.NewPage(&page_id);
+            reinterpret_cast<uint32_t*>(page->GetData())[0] = i;
+            bpm.UnpinPage(page_id, true);
+            page_ids.push_back(page_id);
+        }
+    }
+    
+    // Scatter the hot ranks over the file so they are not one contiguous run
+    vector<int> rank_to_page(NUM_PAGES);
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        rank_to_page[i] = i;
+    }
+    shuffle(rank_to_page.begin(), rank_to_page.end(), mt19937(7));
+    
+    cout << "  policy    lookup hit rate" << endl;
+    double lru_hit_rate = 0.0;
+    double lru_k_hit_rate = 0.0;
+    for (ReplacerType type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K}) {
+        BufferPoolOptions options;
+        options.replacer_type = type;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        ZipfianGenerator zipf(NUM_PAGES, 0.99, 42);
+        
+        size_t lookup_hits = 0;
+        for (int i = 0; i < NUM_LOOKUPS; ++i) {
+            if (i > 0 && i % SCAN_INTERVAL == 0) {
+                for (page_id_t page_id : page_ids) {
+                    bpm.FetchPage(page_id);
+                    bpm.UnpinPage(page_id, false);
+                }
+            }
+            
+            int idx = rank_to_page[zipf.Next()];
+            size_t hits_before = bpm.GetHitCount();
+            Page* page = bpm.FetchPage(page_ids[idx]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(idx));
+            lookup_hits += bpm.GetHitCount() - hits_before;
+            bpm.UnpinPage(page_ids[idx], false);
+        }
+        
+        double hit_rate = static_cast<double>(lookup_hits) / NUM_LOOKUPS;
+        const char* name = type == ReplacerType::LRU ? "LRU  " :
+                           type == ReplacerType::CLOCK ? "CLOCK" : "LRU-K";
+        printf("  %s     %6.2f%%\n", name, hit_rate * 100);
+        if (type == ReplacerType::LRU) {
+            lru_hit_rate = hit_rate;
+        } else if (type == ReplacerType::LRU_K) {
+            lru_k_hit_rate = hit_rate;
+        }
+    }
+    
+    assert(lru_k_hit_rate > lru_hit_rate);
+    (void)lru_hit_rate;
+    (void)lru_k_hit_rate;
+    cout << "Test 10 PASSED" << endl;
+}
+
+// Test 11: RAII Page Guards
+void TestPageGuards() {
+    cout << "\n=== Test 11: RAII Page Guards ===" << endl;
+    
+    DiskManager disk_manager("test_guard.db");
+    BufferPoolManager bpm(1, &disk_manager);  // One frame forces eviction
+    
+    page_id_t page_id;
+    Page* page = bpm.NewPage(&page_id);
+    assert(page != nullptr);
+    bpm.UnpinPage(page_id, false);
+    
+    // Writer guard marks the page dirty and unpins on destruction
+    {
+        WritePageGuard guard = bpm.FetchPageWrite(page_id);
+        assert(guard.IsValid());
+        strcpy(guard.GetData(), "written through guard");
+        
+        WritePageGuard moved = std::move(guard);  // Ownership moves, one unpin
+        assert(!guard.IsValid() && moved.IsValid());
+    }
+    assert(!bpm.UnpinPage(page_id, false));  // Already unpinned by the guard
+    
+    // Evict it through the only frame, then read it back from disk
+    page_id_t other_page_id;
+    page = bpm.NewPage(&other_page_id);
+    assert(page != nullptr);
+    ReadPageGuard blocked = bpm.FetchPageRead(page_id);
+    assert(!blocked.IsValid());  // The only frame is pinned
+    bpm.UnpinPage(other_page_id, false);
+    {
+        ReadPageGuard guard = bpm.FetchPageRead(page_id);
+        assert(guard.IsValid());
+        assert(strcmp(guard.GetData(), "written through guard") == 0);
+    }
+    cout << "✓ Guards unpin on scope exit and writers mark pages dirty" << endl;
+    
+    // Concurrent writers and readers on one page: readers must never see a
+    // half-applied update
+    BufferPoolManager shared_bpm(4, &disk_manager);
+    page_id_t counter_page_id;
+    page = shared_bpm.NewPage(&counter_page_id);
+    memset(page->GetData(), 0, 2 * sizeof(uint64_t));
+    shared_bpm.UnpinPage(counter_page_id, true);
+    
+    const int NUM_WRITERS = 4;
+    const int NUM_READERS = 4;
+    const int OPS_PER_THREAD = 20000;
+    atomic<bool> torn_read(false);
+    vector<thread> workers;
+    for (int t = 0; t < NUM_WRITERS; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                WritePageGuard guard = shared_bpm.FetchPageWrite(counter_page_id);
+                uint64_t* values = reinterpret_cast<uint64_t*>(guard.GetData());
+                values[0]++;
+                values[1] = values[0];
+            }
+        });
+    }
+    for (int t = 0; t < NUM_READERS; ++t) {
+        workers.emplace_back([&]() {
+            for (int i = 0; i < OPS_PER_THREAD; ++i) {
+                ReadPageGuard guard = shared_bpm.FetchPageRead(counter_page_id);
+                const uint64_t* values = reinterpret_cast<const uint64_t*>(guard.GetData());
+                if (values[0] != values[1]) {
+                    torn_read = true;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    ReadPageGuard guard = shared_bpm.FetchPageRead(counter_page_id);
+    const uint64_t* values = reinterpret_cast<const uint64_t*>(guard.GetData());
+    assert(values[0] == static_cast<uint64_t>(NUM_WRITERS) * OPS_PER_THREAD);
+    assert(!torn_read);
+    cout << "✓ " << NUM_WRITERS << " writers and " << NUM_READERS
+         << " readers, counter = " << values[0] << ", no torn reads" << endl;
+    guard.Release();
+    
+    cout << "Test 11 PASSED" << endl;
+}
+
+// DiskManager that sleeps on every read to model a slow device
+class SlowDiskManager : public DiskManager {
+public:
+    SlowDiskManager(const string& db_filename, chrono::milliseconds read_delay)
+        : DiskManager(db_filename), read_delay_(read_delay), read_count_(0) {}
+
+    void ReadPage(page_id_t page_id, Page* page) override {
+        read_count_++;
+        if (slow_) {
+            this_thread::sleep_for(read_delay_);
+        }
+        DiskManager::ReadPage(page_id, page);
+    }
+
+    void SetSlow(bool slow) { slow_ = slow; }
+    size_t GetReadCount() const { return read_count_; }
+
+private:
+    chrono::milliseconds read_delay_;
+    atomic<size_t> read_count_;
+    atomic<bool> slow_{false};
+};
+
+// Test 12: Disk I/O Outside the Pool Latch
+void TestIOOutsideLatch() {
+    cout << "\n=== Test 12: Disk I/O Outside the Pool Latch ===" << endl;
+    
+    const auto READ_DELAY = chrono::milliseconds(20);
+    const int NUM_HOT = 8;
+    const int NUM_COLD = 10;
+    
+    SlowDiskManager disk_manager("test_slowdisk.db", READ_DELAY);
+    BufferPoolManager bpm(NUM_HOT + 2, &disk_manager);
+    
+    vector<page_id_t> hot_ids;
+    vector<page_id_t> cold_ids;
+    for (int i = 0; i < NUM_HOT + NUM_COLD; ++i) {
+        page_id_t page_id;
+        Page* page = bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        reinterpret_cast<uint32_t*>(page->GetData())[0] = i;
+        bpm.UnpinPage(page_id, true);
+        (i < NUM_COLD ? cold_ids : hot_ids).push_back(page_id);
+    }
+    // The hot pages were created last, so they are resident; pin them
+    // while the cold pages cycle through the two spare frames
+    for (page_id_t page_id : hot_ids) {
+        bpm.FetchPage(page_id);
+    }
+    disk_manager.SetSlow(true);
+    
+    // One thread misses on cold pages while another measures hit latency
+    atomic<bool> done(false);
+    thread misser([&]() {
+        for (int i = 0; i < NUM_COLD; ++i) {
+            Page* page = bpm.FetchPage(cold_ids[i]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+            bpm.UnpinPage(cold_ids[i], false);
+        }
+        done = true;
+    });
+    
+    double max_hit_us = 0.0;
+    size_t num_hits = 0;
+    while (!done) {
+        page_id_t page_id = hot_ids[num_hits % NUM_HOT];
+        auto start = chrono::high_resolution_clock::now();
+        Page* page = bpm.FetchPage(page_id);
+        auto end = chrono::high_resolution_clock::now();
+        assert(page != nullptr);
+        bpm.UnpinPage(page_id, false);
+        max_hit_us = max(max_hit_us, chrono::duration<double, micro>(end - start).count());
+        num_hits++;
+        this_thread::yield();
+    }
+    misser.join();
+    
+    cout << "✓ " << NUM_COLD << " misses at " << READ_DELAY.count() << " ms each, "
+         << num_hits << " concurrent hits, max hit latency " << max_hit_us << " μs" << endl;
+    double read_delay_us = chrono::duration<double, micro>(READ_DELAY).count();
+    assert(max_hit_us < read_delay_us);
+    (void)read_delay_us;
+    
+    // Concurrent requesters of one missing page share a single read
+    page_id_t target = cold_ids[0];
+    size_t reads_before = disk_manager.GetReadCount();
+    vector<thread> requesters;
+    for (int t = 0; t < 4; ++t) {
+        requesters.emplace_back([&]() {
+            Page* page = bpm.FetchPage(target);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == 0);
+            (void)page;
+            bpm.UnpinPage(target, false);
+        });
+    }
+    for (auto& requester : requesters) {
+        requester.join();
+    }
+    size_t reads = disk_manager.GetReadCount() - reads_before;
+    cout << "✓ 4 concurrent fetches of an evicted page issued " << reads << " disk read" << endl;
+    assert(reads == 1);
+    
+    for (page_id_t page_id : hot_ids) {
+        bpm.UnpinPage(page_id, false);
+    }
+    
+    // Dirty evictions racing with re-fetches must never lose an update
+    disk_manager.SetSlow(false);
+    const int NUM_PAGES = 64;
+    const int UPDATES_PER_THREAD = 5000;
+    BufferPoolManager small_bpm(8, &disk_manager);
+    vector<page_id_t> page_ids;
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        page_id_t page_id;
+        Page* page = small_bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        reinterpret_cast<uint32_t*>(page->GetData())[0] = 0;
+        small_bpm.UnpinPage(page_id, true);
+        page_ids.push_back(page_id);
+    }
+    vector<atomic<uint32_t>> expected(NUM_PAGES);
+    vector<thread> updaters;
+    for (int t = 0; t < 4; ++t) {
+        updaters.emplace_back([&, t]() {
+            mt19937 gen(t);
+            uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+            for (int i = 0; i < UPDATES_PER_THREAD; ++i) {
+                int idx = dis(gen);
+                WritePageGuard guard = small_bpm.FetchPageWrite(page_ids[idx]);
+                assert(guard.IsValid());
+                reinterpret_cast<uint32_t*>(guard.GetData())[0]++;
+                expected[idx]++;
+            }
+        });
+    }
+    for (auto& updater : updaters) {
+        updater.join();
+    }
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        ReadPageGuard guard = small_bpm.FetchPageRead(page_ids[i]);
+        assert(reinterpret_cast<const uint32_t*>(guard.GetData())[0] == expected[i]);
+    }
+    cout << "✓ " << 4 * UPDATES_PER_THREAD << " updates through an 8-frame pool, none lost" << endl;
+    
+    cout << "Test 12 PASSED" << endl;
+}
+
+// Test 13: Concurrent Positional I/O and O_DIRECT
+void TestConcurrentDiskIO() {
+    cout << "\n=== Test 13: Concurrent Positional I/O and O_DIRECT ===" << endl;
+    
+    const int NUM_PAGES = 256;
+    const int NUM_THREADS = 4;
+    const int READS_PER_THREAD = 5000;
+    
+    for (bool direct_io : {false, true}) {
+        DiskManager disk_manager(direct_io ? "test_direct.db" : "test_pread.db", direct_io);
+        
+        // Write pages concurrently, each thread its own stripe
+        vector<page_id_t> page_ids;
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+        }
+        vector<thread> workers;
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            workers.emplace_back([&, t]() {
+                Page page;
+                for (int i = t; i < NUM_PAGES; i += NUM_THREADS) {
+                    page.Reset();
+                    page.GetHeader()->page_id = page_ids[i];
+                    page.GetHeader()->page_type = PageType::DATA;
+                    reinterpret_cast<uint32_t*>(page.GetData())[0] = i;
+                    page.UpdateChecksum();
+                    disk_manager.WritePage(page_ids[i], &page);
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+        
+        // Random reads from all threads at once
+        atomic<bool> mismatch(false);
+        auto start = chrono::high_resolution_clock::now();
+        for (int t = 0; t < NUM_THREADS; ++t) {
+            workers.emplace_back([&, t]() {
+                Page page;
+                mt19937 gen(t);
+                uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+                for (int i = 0; i < READS_PER_THREAD; ++i) {
+                    int idx = dis(gen);
+                    disk_manager.ReadPage(page_ids[idx], &page);
+                    if (reinterpret_cast<uint32_t*>(page.GetData())[0] != static_cast<uint32_t>(idx)) {
+                        mismatch = true;
+                    }
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        auto end = chrono::high_resolution_clock::now();
+        assert(!mismatch);
+        
+        double seconds = chrono::duration<double>(end - start).count();
+        cout << "✓ " << (disk_manager.IsDirectIO() ? "O_DIRECT" : "buffered") << ": "
+             << NUM_THREADS << " threads, "
+             << static_cast<size_t>(NUM_THREADS * READS_PER_THREAD / seconds)
+             << " page reads/s, all contents verified" << endl;
+    }
+    
+    cout << "Test 13 PASSED" << endl;
+}
+
+// Test 14: Group Flush Bulk Load
+void TestGroupFlushBulkLoad() {
+    cout << "\n=== Test 14: Group Flush Bulk Load ===" << endl;
+    
+    const int NUM_PAGES = 500;  // Same shape as the Test 5 creation loop
+    
+    // Durable per page: every page written and synced on its own
+    double per_page_ms;
+    {
+        DiskManager disk_manager("test_bulk_single.db");
+        BufferPoolManager bpm(100, &disk_manager);
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id;
+            Page* page = bpm.NewPage(&page_id);
+            reinterpret_cast<uint32_t*>(page->GetData())[0] = i;
+            bpm.UnpinPage(page_id, true);
+            bpm.FlushPage(page_id);
+        }
+        auto end = chrono::high_resolution_clock::now();
+        per_page_ms = chrono::duration<double, milli>(end - start).count();
+    }
+    
+    // Group: evictions only reach the OS, one sorted, coalesced, synced batch at the end
+    double group_ms;
+    vector<page_id_t> page_ids;
+    {
+        DiskManager disk_manager("test_bulk_group.db");
+        BufferPoolManager bpm(100, &disk_manager);
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id;
+            Page* page = bpm.NewPage(&page_id);
+            reinterpret_cast<uint32_t*>(page->GetData())[0] = i;
+            bpm.UnpinPage(page_id, true);
+            page_ids.push_back(page_id);
+        }
+        bpm.FlushAllPages();
+        auto end = chrono::high_resolution_clock::now();
+        group_ms = chrono::duration<double, milli>(end - start).count();
+    }
+    
+    // Everything from the group load must be readable after reopening
+    {
+        DiskManager disk_manager("test_bulk_group.db");
+        BufferPoolManager bpm(100, &disk_manager);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            Page* page = bpm.FetchPage(page_ids[i]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+            bpm.UnpinPage(page_ids[i], false);
+        }
+    }
+    
+    cout << "✓ " << NUM_PAGES << " pages, sync per page: " << per_page_ms << " ms ("
+         << (NUM_PAGES / per_page_ms * 1000) << " pages/s)" << endl;
+    cout << "✓ " << NUM_PAGES << " pages, group flush:   " << group_ms << " ms ("
+         << (NUM_PAGES / group_ms * 1000) << " pages/s)" << endl;
+    
+    cout << "Test 14 PASSED" << endl;
+}
+
+// Test 15: Asynchronous Disk I/O Queue Depth
+void TestAsyncDiskIO() {
+    cout << "\n=== Test 15: Asynchronous Disk I/O Queue Depth ===" << endl;
+    
+    const int NUM_PAGES = 2048;
+    const int NUM_READS = 4000;
+    const size_t QUEUE_DEPTH = 32;
+    
+    for (bool allow_io_uring : {true, false}) {
+        DiskManager disk_manager(allow_io_uring ? "test_async.db" : "test_async_pool.db",
+                                 true, allow_io_uring);
+        
+        // Lay out the file with async writes, all in flight together
+        vector<page_id_t> page_ids;
+        vector<Page> sources(NUM_PAGES);
+        vector<future<void>> writes;
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+            sources[i].GetHeader()->page_id = page_ids[i];
+            sources[i].GetHeader()->page_type = PageType::DATA;
+            reinterpret_cast<uint32_t*>(sources[i].GetData())[0] = i;
+            sources[i].UpdateChecksum();
+            writes.push_back(disk_manager.WritePageAsync(page_ids[i], &sources[i]));
+        }
+        for (auto& write : writes) {
+            write.get();
+        }
+        
+        mt19937 gen(15);
+        uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+        vector<int> order(NUM_READS);
+        for (int& idx : order) {
+            idx = dis(gen);
+        }
+        
+        // Synchronous baseline
+        Page page;
+        auto start = chrono::high_resolution_clock::now();
+        for (int idx : order) {
+            disk_manager.ReadPage(page_ids[idx], &page);
+            assert(reinterpret_cast<uint32_t*>(page.GetData())[0] == static_cast<uint32_t>(idx));
+        }
+        double sync_seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        
+        // Async with a window of depth outstanding reads
+        auto run_async = [&](size_t depth) {
+            vector<Page> buffers(depth);
+            deque<pair<future<void>, int>> window;  // (completion, read number)
+            auto retire = [&]() {
+                window.front().first.get();
+                int i = window.front().second;
+                uint32_t value = reinterpret_cast<const uint32_t*>(buffers[i % depth].GetData())[0];
+                assert(value == static_cast<uint32_t>(order[i]));
+                (void)value;
+                window.pop_front();
+            };
+            
+            auto async_start = chrono::high_resolution_clock::now();
+            for (int i = 0; i < NUM_READS; ++i) {
+                if (window.size() == depth) {
+                    retire();  // Oldest read frees the buffer we reuse next
+                }
+                window.emplace_back(disk_manager.ReadPageAsync(page_ids[order[i]], &buffers[i % depth]), i);
+            }
+            while (!window.empty()) {
+                retire();
+            }
+            return chrono::duration<double>(chrono::high_resolution_clock::now() - async_start).count();
+        };
+        double qd1_seconds = run_async(1);
+        double qd32_seconds = run_async(QUEUE_DEPTH);
+        
+        // Out-of-range reads still fail synchronously
+        bool threw = false;
+        try {
+            disk_manager.ReadPageAsync(disk_manager.GetNumPages() + 10, &page);
+        } catch (const out_of_range&) {
+            threw = true;
+        }
+        assert(threw);
+        
+        string backend = disk_manager.GetAsyncBackendName();
+        assert(allow_io_uring || backend == "thread-pool");
+        cout << "✓ " << backend << (disk_manager.IsDirectIO() ? ", O_DIRECT" : ", buffered")
+             << ", " << NUM_READS << " random reads of " << NUM_PAGES << " pages:" << endl;
+        cout << "    sync ReadPage: " << static_cast<size_t>(NUM_READS / sync_seconds) << " IOPS" << endl;
+        cout << "    async QD1:     " << static_cast<size_t>(NUM_READS / qd1_seconds) << " IOPS" << endl;
+        cout << "    async QD" << QUEUE_DEPTH << ":    "
+             << static_cast<size_t>(NUM_READS / qd32_seconds) << " IOPS" << endl;
+    }
+    
+    // A read that runs into the end of the file comes back short; the
+    // engine asks for the rest, and fails the read only when none is left
+    {
+        const char* FILE_NAME = "test_async_short.db";
+        vector<char> contents(PAGE_SIZE + PAGE_SIZE / 2, 'x');
+        {
+            ofstream file(FILE_NAME, ios::binary | ios::trunc);
+            file.write(contents.data(), contents.size());
+        }
+        int fd = open(FILE_NAME, O_RDONLY);
+        assert(fd >= 0);
+        for (bool allow_io_uring : {true, false}) {
+            unique_ptr<AsyncIOEngine> engine = AsyncIOEngine::Create(4, allow_io_uring);
+            vector<char> buffer(2 * PAGE_SIZE, 0);
+            promise<bool> whole;
+            promise<bool> past_end;
+            engine->SubmitRead(fd, buffer.data(), PAGE_SIZE, PAGE_SIZE / 2,
+                               [&whole](bool ok) { whole.set_value(ok); });
+            engine->SubmitRead(fd, buffer.data() + PAGE_SIZE, PAGE_SIZE, PAGE_SIZE,
+                               [&past_end](bool ok) { past_end.set_value(ok); });
+            bool whole_ok = whole.get_future().get();
+            bool past_end_ok = past_end.get_future().get();
+            assert(whole_ok && !past_end_ok);
+            assert(buffer[PAGE_SIZE - 1] == 'x' && buffer[PAGE_SIZE + PAGE_SIZE / 2 - 1] == 'x');
+            (void)whole_ok;
+            (void)past_end_ok;
+        }
+        close(fd);
+        remove(FILE_NAME);
+        cout << "✓ Reads past the end of the file fail on both backends" << endl;
+    }
+    
+    // The thread pool queues at most queue_depth requests, counting those
+    // being worked on: a submission past that waits for a completion
+    {
+        const char* FILE_NAME = "test_async_queue.db";
+        {
+            ofstream file(FILE_NAME, ios::binary | ios::trunc);
+            file.write(string(PAGE_SIZE, 'x').data(), PAGE_SIZE);
+        }
+        int fd = open(FILE_NAME, O_RDONLY);
+        assert(fd >= 0);
+        const size_t DEPTH = 2;
+        unique_ptr<AsyncIOEngine> engine = AsyncIOEngine::Create(DEPTH, false);
+        vector<char> buffer(PAGE_SIZE);
+        promise<void> release;
+        shared_future<void> released = release.get_future().share();
+        atomic<size_t> completed{0};
+        for (size_t i = 0; i < DEPTH; ++i) {
+            engine->SubmitRead(fd, buffer.data(), PAGE_SIZE, 0, [&, released](bool) {
+                released.wait();
+                completed++;
+            });
+        }
+        future<void> extra = async(launch::async, [&]() {
+            engine->SubmitRead(fd, buffer.data(), PAGE_SIZE, 0, [&](bool) { completed++; });
+        });
+        bool blocked = extra.wait_for(chrono::milliseconds(100)) == future_status::timeout;
+        assert(blocked);
+        (void)blocked;
+        release.set_value();
+        extra.get();
+        engine.reset();  // Waits for the queue to drain
+        assert(completed == DEPTH + 1);
+        close(fd);
+        remove(FILE_NAME);
+        cout << "✓ A full thread-pool queue blocks the next submission" << endl;
+    }
+    
+    cout << "Test 15 PASSED" << endl;
+}
+
+// Test 16: Sequential Read-Ahead and Prefetch
+void TestReadAhead() {
+    cout << "\n=== Test 16: Sequential Read-Ahead and Prefetch ===" << endl;
+    
+    const int NUM_PAGES = 4096;
+    const size_t POOL_SIZE = 256;
+    
+    // O_DIRECT so every miss really goes to the device
+    DiskManager disk_manager("test_readahead.db", true);
+    vector<page_id_t> page_ids;
+    {
+        vector<Page> pages(NUM_PAGES);
+        vector<pair<page_id_t, const Page*>> batch;
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+            pages[i].GetHeader()->page_id = page_ids[i];
+            pages[i].GetHeader()->page_type = PageType::DATA;
+            reinterpret_cast<uint32_t*>(pages[i].GetData())[0] = i;
+            pages[i].UpdateChecksum();
+            batch.emplace_back(page_ids[i], &pages[i]);
+        }
+        disk_manager.WritePages(batch);
+        disk_manager.Flush();
+    }
+    
+    // Explicit hint: prefetched pages are resident but not pinned
+    {
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        BufferPoolManager bpm(8, &disk_manager, options);
+        for (int batch = 0; batch < 2; ++batch) {
+            // The second batch can only land by evicting the first
+            size_t issued = bpm.Prefetch(page_ids[batch * 8], 8);
+            assert(issued == 8);
+            (void)issued;
+            for (int i = batch * 8; i < batch * 8 + 8; ++i) {
+                Page* page = bpm.FetchPage(page_ids[i]);  // Waits for the read if needed
+                assert(page != nullptr);
+                assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+                bpm.UnpinPage(page_ids[i], false);
+            }
+        }
+        assert(bpm.GetMissCount() == 0);
+        assert(bpm.Prefetch(disk_manager.GetNumPages(), 4) == 0);  // Past the end
+        cout << "✓ Prefetch hint: 16 pages read into an 8-frame pool, fetches all hit" << endl;
+    }
+    
+    // Full scan, with and without automatic read-ahead
+    auto scan = [&](size_t read_ahead_pages, size_t* misses, size_t* prefetched) {
+        BufferPoolOptions options;
+        options.read_ahead_pages = read_ahead_pages;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            Page* page = bpm.FetchPage(page_ids[i]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+            bpm.UnpinPage(page_ids[i], false);
+        }
+        double ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        *misses = bpm.GetMissCount();
+        *prefetched = bpm.GetPrefetchCount();
+        return ms;
+    };
+    
+    size_t sync_misses, sync_prefetched, ra_misses, ra_prefetched;
+    double sync_ms = scan(0, &sync_misses, &sync_prefetched);
+    double ra_ms = scan(READ_AHEAD_PAGES, &ra_misses, &ra_prefetched);
+    assert(sync_misses == static_cast<size_t>(NUM_PAGES) && sync_prefetched == 0);
+    assert(ra_misses < static_cast<size_t>(NUM_PAGES) / 10);
+    assert(ra_prefetched + ra_misses >= static_cast<size_t>(NUM_PAGES));
+    
+    cout << "✓ Scan of " << NUM_PAGES << " pages (" << POOL_SIZE << "-frame pool, "
+         << disk_manager.GetAsyncBackendName() << "):" << endl;
+    cout << "    one miss per page: " << sync_ms << " ms, " << sync_misses << " misses" << endl;
+    cout << "    read-ahead:        " << ra_ms << " ms, " << ra_misses << " misses, "
+         << ra_prefetched << " pages prefetched" << endl;
+    
+    // Scanning again on the same pool reads ahead again, although the new
+    // run starts below where the first one's window ended
+    {
+        BufferPoolOptions options;
+        options.read_ahead_pages = READ_AHEAD_PAGES;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        const int SCANS = 3;
+        size_t misses_before = 0;
+        size_t prefetched_before = 0;
+        for (int pass = 0; pass < SCANS; ++pass) {
+            for (int i = 0; i < NUM_PAGES; ++i) {
+                Page* page = bpm.FetchPage(page_ids[i]);
+                assert(page != nullptr);
+                assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+                bpm.UnpinPage(page_ids[i], false);
+            }
+            size_t misses = bpm.GetMissCount() - misses_before;
+            size_t prefetched = bpm.GetPrefetchCount() - prefetched_before;
+            assert(misses < static_cast<size_t>(NUM_PAGES) / 10);
+            assert(prefetched + misses >= static_cast<size_t>(NUM_PAGES) - POOL_SIZE);
+            (void)misses;
+            (void)prefetched;
+            misses_before = bpm.GetMissCount();
+            prefetched_before = bpm.GetPrefetchCount();
+        }
+        cout << "✓ " << SCANS << " scans on one pool: " << bpm.GetMissCount() << " misses, "
+             << bpm.GetPrefetchCount() << " pages prefetched" << endl;
+    }
+
+    // On the parallel pool consecutive pages live in different instances,
+    // so the run is only visible over all of them
+    {
+        BufferPoolOptions options;
+        options.read_ahead_pages = READ_AHEAD_PAGES;
+        ParallelBufferPoolManager parallel_bpm(4, POOL_SIZE / 4, &disk_manager, options);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            Page* page = parallel_bpm.FetchPage(page_ids[i]);
+            assert(page != nullptr);
+            assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(i));
+            parallel_bpm.UnpinPage(page_ids[i], false);
+        }
+        assert(parallel_bpm.GetMissCount() < static_cast<size_t>(NUM_PAGES) / 10);
+        assert(parallel_bpm.GetPrefetchCount() + parallel_bpm.GetMissCount() >=
+               static_cast<size_t>(NUM_PAGES));
+        // Counts running past the end of the file stop there
+        assert(parallel_bpm.Prefetch(disk_manager.GetNumPages(), SIZE_MAX) == 0);
+        assert(parallel_bpm.Prefetch(disk_manager.GetNumPages() - 1, SIZE_MAX) <= 1);
+        cout << "✓ Parallel pool, 4 instances: " << parallel_bpm.GetMissCount() << " misses, "
+             << parallel_bpm.GetPrefetchCount() << " pages prefetched" << endl;
+    }
+
+    cout << "Test 16 PASSED" << endl;
+}
+
+// Test 17: Background Page Cleaner
+void TestPageCleaner() {
+    cout << "\n=== Test 17: Background Page Cleaner ===" << endl;
+    
+    const int NUM_PAGES = 1024;
+    const size_t POOL_SIZE = 128;
+    const int NUM_ACCESSES = 20000;
+    
+    DiskManager disk_manager("test_cleaner.db", true);
+    vector<page_id_t> page_ids;
+    {
+        vector<Page> pages(NUM_PAGES);
+        vector<pair<page_id_t, const Page*>> batch;
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+            pages[i].GetHeader()->page_id = page_ids[i];
+            pages[i].GetHeader()->page_type = PageType::DATA;
+            batch.emplace_back(page_ids[i], &pages[i]);
+        }
+        disk_manager.WritePages(batch);
+    }
+    vector<uint32_t> expected(NUM_PAGES, 0);
+    
+    // Random reads and updates, half of the accesses dirty their page
+    auto run = [&](bool cleaner, size_t* foreground, size_t* background) {
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        options.enable_page_cleaner = cleaner;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        mt19937 gen(17);
+        uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+        
+        double miss_ns = 0;
+        size_t misses = 0;
+        for (int i = 0; i < NUM_ACCESSES; ++i) {
+            int idx = dis(gen);
+            bool write = (i % 2) == 0;
+            size_t misses_before = bpm.GetMissCount();
+            auto start = chrono::high_resolution_clock::now();
+            Page* page = bpm.FetchPage(page_ids[idx]);
+            auto end = chrono::high_resolution_clock::now();
+            assert(page != nullptr);
+            if (bpm.GetMissCount() != misses_before) {
+                miss_ns += chrono::duration<double, nano>(end - start).count();
+                misses++;
+            }
+            uint32_t* counter = reinterpret_cast<uint32_t*>(page->GetData());
+            assert(*counter == expected[idx]);
+            if (write) {
+                (*counter)++;
+                expected[idx]++;
+            }
+            bpm.UnpinPage(page_ids[idx], write);
+        }
+        *foreground = bpm.GetForegroundWriteCount();
+        *background = bpm.GetBackgroundWriteCount();
+        return miss_ns / misses / 1000.0;
+    };
+    
+    size_t off_foreground, off_background, on_foreground, on_background;
+    double off_us = run(false, &off_foreground, &off_background);
+    double on_us = run(true, &on_foreground, &on_background);
+    assert(off_background == 0);
+    assert(on_background > 0);
+    assert(on_foreground < off_foreground / 2);
+    
+    // Every update made it to disk through one path or the other
+    {
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            ReadPageGuard guard = bpm.FetchPageRead(page_ids[i]);
+            assert(reinterpret_cast<const uint32_t*>(guard.GetData())[0] == expected[i]);
+        }
+    }
+    
+    cout << "✓ " << NUM_ACCESSES << " accesses, 50% updates, " << POOL_SIZE << " frames over "
+         << NUM_PAGES << " pages:" << endl;
+    cout << "    no cleaner: " << off_us << " us per miss, " << off_foreground
+         << " foreground write-backs" << endl;
+    cout << "    cleaner:    " << on_us << " us per miss, " << on_foreground
+         << " foreground / " << on_background << " background write-backs" << endl;
+    
+    // Over the high ratio the cleaner drains the whole pool, not just the cold end
+    {
+        BufferPoolOptions options;
+        options.enable_page_cleaner = true;
+        options.cleaner_lru_depth = 1;
+        options.cleaner_dirty_ratio_high = 0.5;
+        options.cleaner_dirty_ratio_low = 0.1;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        for (size_t i = 0; i < POOL_SIZE; ++i) {
+            Page* page = bpm.FetchPage(page_ids[i]);
+            assert(page != nullptr);
+            reinterpret_cast<uint32_t*>(page->GetData())[0]++;
+            expected[i]++;
+            bpm.UnpinPage(page_ids[i], true);
+        }
+        auto deadline = chrono::steady_clock::now() + chrono::seconds(5);
+        while (bpm.GetBackgroundWriteCount() < POOL_SIZE - POOL_SIZE / 10 &&
+               chrono::steady_clock::now() < deadline) {
+            this_thread::sleep_for(chrono::milliseconds(1));
+        }
+        assert(bpm.GetBackgroundWriteCount() >= POOL_SIZE - POOL_SIZE / 10);
+        cout << "✓ Fully dirty pool: " << bpm.GetBackgroundWriteCount() << " of " << POOL_SIZE
+             << " frames cleaned in the background" << endl;
+    }
+    
+    cout << "Test 17 PASSED" << endl;
+}
+
+// The XOR fold Page used before CRC32C, kept for comparison
+uint32_t XorFoldChecksum(const Page& page) {
+    uint32_t sum = 0;
+    const uint32_t* data = reinterpret_cast<const uint32_t*>(page.GetData());
+    for (size_t i = 0; i < PAGE_DATA_SIZE / sizeof(uint32_t); ++i) {
+        sum ^= data[i];
+    }
+    return sum;
+}
+
+// Test 18: CRC32C Page Checksums
+void TestCrc32cChecksums() {
+    cout << "\n=== Test 18: CRC32C Page Checksums ===" << endl;
+    
+    // Standard check value, and chaining across buffers
+    const char* check = "123456789";
+    assert(Crc32c(check, 9) == 0xE3069283);
+    assert(Crc32cPortable(check, 9) == 0xE3069283);
+    assert(Crc32c(check + 4, 5, Crc32c(check, 4)) == 0xE3069283);
+    
+    // Dispatched and portable versions agree on every length and alignment
+    mt19937 gen(18);
+    unsigned char buffer[PAGE_SIZE + 16];
+    for (auto& byte : buffer) {
+        byte = static_cast<unsigned char>(gen());
+    }
+    for (size_t offset = 0; offset < 8; ++offset) {
+        for (size_t size : {0, 1, 7, 8, 9, 63, 1000, static_cast<int>(PAGE_SIZE)}) {
+            uint32_t hardware = Crc32c(buffer + offset, size);
+            assert(hardware == Crc32cPortable(buffer + offset, size));
+            (void)hardware;
+        }
+    }
+    cout << "✓ Crc32c (" << Crc32cImplementation() << ") matches the table version" << endl;
+    
+    // Corruptions the XOR fold cannot see
+    Page page;
+    for (size_t i = 0; i < PAGE_DATA_SIZE / sizeof(uint32_t); ++i) {
+        reinterpret_cast<uint32_t*>(page.GetData())[i] = gen();
+    }
+    page.UpdateChecksum();
+    assert(page.VerifyChecksum());
+    
+    Page swapped = page;
+    uint32_t* words = reinterpret_cast<uint32_t*>(swapped.GetData());
+    swap(words[3], words[700]);
+    assert(XorFoldChecksum(swapped) == XorFoldChecksum(page));
+    assert(!swapped.VerifyChecksum());
+    
+    Page zeroed = page;
+    words = reinterpret_cast<uint32_t*>(zeroed.GetData());
+    words[10] = words[11] = 0x5A5A5A5A;  // Equal words cancel out in the fold
+    Page zeroed_pair = zeroed;
+    words = reinterpret_cast<uint32_t*>(zeroed_pair.GetData());
+    words[10] = words[11] = 0;
+    assert(XorFoldChecksum(zeroed) == XorFoldChecksum(zeroed_pair));
+    zeroed.UpdateChecksum();
+    zeroed_pair.GetHeader()->checksum = zeroed.GetHeader()->checksum;
+    assert(!zeroed_pair.VerifyChecksum());
+    
+    Page header_changed = page;
+    header_changed.GetHeader()->num_records++;
+    assert(!header_changed.VerifyChecksum());
+    cout << "✓ Swapped words, zeroed word pairs and header changes are detected" << endl;
+    
+    // Flushes of a page another thread keeps rewriting under a write guard
+    // write whole versions of it, never a torn mix with a stale checksum
+    {
+        const char* DB_FILE = "test_crc_flush.db";
+        remove(DB_FILE);
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(16, &disk_manager);
+        page_id_t page_id;
+        bpm.NewPage(&page_id);
+        bpm.UnpinPage(page_id, true);
+        atomic<bool> done(false);
+        thread writer([&]() {
+            for (int round = 0; !done; ++round) {
+                WritePageGuard guard = bpm.FetchPageWrite(page_id);
+                memset(guard.GetData(), round & 0xFF, PAGE_DATA_SIZE);
+            }
+        });
+        Page on_disk;
+        for (int i = 0; i < 200; ++i) {
+            // Pinned meanwhile, like a page in use
+            bpm.FetchPage(page_id);
+            if (i % 2 == 0) {
+                bpm.FlushPage(page_id);
+            } else {
+                bpm.FlushAllPages();
+            }
+            bpm.UnpinPage(page_id, false);
+            disk_manager.ReadPage(page_id, &on_disk);
+            assert(on_disk.VerifyChecksum());
+            const char* data = on_disk.GetData();
+            assert(all_of(data, data + PAGE_DATA_SIZE, [data](char c) { return c == data[0]; }));
+            (void)data;
+        }
+        done = true;
+        writer.join();
+
+        // Both write a pinned page whether or not it was reported dirty yet
+        bpm.FlushPage(page_id);
+        Page* page = bpm.FetchPage(page_id);
+        memset(page->GetData(), 0xAB, PAGE_DATA_SIZE);
+        bpm.FlushAllPages();
+        disk_manager.ReadPage(page_id, &on_disk);
+        assert(static_cast<unsigned char>(on_disk.GetData()[0]) == 0xAB);
+        bpm.UnpinPage(page_id, true);
+        remove(DB_FILE);
+    }
+    cout << "✓ Flushes of a page changing under a write guard write whole, checksummed versions" << endl;
+    
+    // Throughput over one page, old fold vs table vs dispatched
+    const int ITERATIONS = 20000;
+    volatile uint32_t sink = 0;
+    auto measure = [&](auto checksum) {
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < ITERATIONS; ++i) {
+            page.GetData()[0] = static_cast<char>(i);  // Keep the compiler honest
+            sink = sink + checksum();
+        }
+        double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        return static_cast<double>(ITERATIONS) * PAGE_SIZE / seconds / 1e9;
+    };
+    double xor_gbps = measure([&]() { return XorFoldChecksum(page); });
+    double table_gbps = measure([&]() { return Crc32cPortable(page.GetRawData(), PAGE_SIZE); });
+    double crc_gbps = measure([&]() { return page.CalculateChecksum(); });
+    
+    cout << "✓ Checksum throughput over 8KB pages:" << endl;
+    cout << "    XOR fold (old):  " << xor_gbps << " GB/s" << endl;
+    cout << "    CRC32C table:    " << table_gbps << " GB/s" << endl;
+    cout << "    CRC32C " << Crc32cImplementation() << ":   " << crc_gbps << " GB/s" << endl;
+    
+    cout << "Test 18 PASSED" << endl;
+}
+
+// Sum every word of a page's data area, so a scan touches all its bytes
+uint64_t SumPageData(const Page& page) {
+    uint64_t sum = 0;
+    const uint64_t* words = reinterpret_cast<const uint64_t*>(page.GetData());
+    for (size_t i = 0; i < PAGE_DATA_SIZE / sizeof(uint64_t); ++i) {
+        sum += words[i];
+    }
+    return sum;
+}
+
+// Test 19: Memory-Mapped Read-Only Scans
+void TestMmapDiskManager() {
+    cout << "\n=== Test 19: Memory-Mapped Read-Only Scans ===" << endl;
+    
+    const int NUM_PAGES = 8192;  // 64MB
+    const int BATCH = 1024;
+    const int NUM_LOOKUPS = 20000;
+    
+    uint64_t expected_sum = 0;
+    {
+        DiskManager disk_manager("test_mmap.db");
+        vector<Page> pages(BATCH);
+        for (int start = 0; start < NUM_PAGES; start += BATCH) {
+            vector<pair<page_id_t, const Page*>> batch;
+            for (int i = 0; i < BATCH; ++i) {
+                page_id_t page_id = disk_manager.AllocatePage();
+                pages[i].Reset();
+                pages[i].GetHeader()->page_id = page_id;
+                pages[i].GetHeader()->page_type = PageType::DATA;
+                uint32_t* data = reinterpret_cast<uint32_t*>(pages[i].GetData());
+                for (size_t w = 0; w < PAGE_DATA_SIZE / sizeof(uint32_t); w += 16) {
+                    data[w] = page_id + static_cast<uint32_t>(w);
+                }
+                pages[i].UpdateChecksum();
+                expected_sum += SumPageData(pages[i]);
+                batch.emplace_back(page_id, &pages[i]);
+            }
+            disk_manager.WritePages(batch);
+        }
+    }
+    
+    MmapDiskManager mmap_manager("test_mmap.db");
+    DiskManager disk_manager("test_mmap.db");
+    page_id_t num_pages = mmap_manager.GetNumPages();
+    assert(num_pages == disk_manager.GetNumPages());
+    
+    // Views come straight from the mapping and match what ReadPage returns
+    Page copy;
+    for (page_id_t page_id : {page_id_t(2), page_id_t(num_pages / 2), page_id_t(num_pages - 1)}) {
+        const Page* view = mmap_manager.GetPage(page_id);
+        assert(reinterpret_cast<uintptr_t>(view) % PAGE_ALIGNMENT == 0);
+        assert(view->GetHeader()->page_id == page_id);
+        assert(view->VerifyChecksum());
+        disk_manager.ReadPage(page_id, &copy);
+        assert(memcmp(view, &copy, PAGE_SIZE) == 0);
+        mmap_manager.ReadPage(page_id, &copy);
+        assert(memcmp(view, &copy, PAGE_SIZE) == 0);
+    }
+    bool threw = false;
+    try {
+        mmap_manager.GetPage(num_pages);
+    } catch (const out_of_range&) {
+        threw = true;
+    }
+    assert(threw);
+    cout << "✓ " << num_pages << " pages mapped read-only, views match ReadPage" << endl;
+    
+    // Full scan of the data pages; the file is in the page cache for both
+    auto timed = [](auto body) {
+        auto start = chrono::high_resolution_clock::now();
+        body();
+        return chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+    };
+    uint64_t read_sum = 0;
+    uint64_t mmap_sum = 0;
+    double read_ms = timed([&]() {
+        for (page_id_t page_id = 2; page_id < num_pages; ++page_id) {
+            disk_manager.ReadPage(page_id, &copy);
+            read_sum += SumPageData(copy);
+        }
+    });
+    mmap_manager.Advise(MmapDiskManager::AccessPattern::SEQUENTIAL);
+    double mmap_ms = timed([&]() {
+        for (page_id_t page_id = 2; page_id < num_pages; ++page_id) {
+            mmap_sum += SumPageData(*mmap_manager.GetPage(page_id));
+        }
+    });
+    assert(read_sum == expected_sum && mmap_sum == expected_sum);
+    
+    // Random point lookups
+    mt19937 gen(19);
+    uniform_int_distribution<page_id_t> dis(2, num_pages - 1);
+    vector<page_id_t> lookups(NUM_LOOKUPS);
+    for (auto& page_id : lookups) {
+        page_id = dis(gen);
+    }
+    uint64_t read_lookup_sum = 0;
+    uint64_t mmap_lookup_sum = 0;
+    double read_lookup_ms = timed([&]() {
+        for (page_id_t page_id : lookups) {
+            disk_manager.ReadPage(page_id, &copy);
+            read_lookup_sum += reinterpret_cast<const uint32_t*>(copy.GetData())[0];
+        }
+    });
+    mmap_manager.Advise(MmapDiskManager::AccessPattern::RANDOM);
+    double mmap_lookup_ms = timed([&]() {
+        for (page_id_t page_id : lookups) {
+            mmap_lookup_sum += reinterpret_cast<const uint32_t*>(mmap_manager.GetPage(page_id)->GetData())[0];
+        }
+    });
+    assert(read_lookup_sum == mmap_lookup_sum);
+    
+    double megabytes = static_cast<double>(num_pages - 2) * PAGE_SIZE / (1024 * 1024);
+    cout << "✓ Full scan of " << megabytes << " MB:" << endl;
+    cout << "    ReadPage copy:   " << read_ms << " ms (" << megabytes / read_ms * 1000 << " MB/s)" << endl;
+    cout << "    mmap view:       " << mmap_ms << " ms (" << megabytes / mmap_ms * 1000 << " MB/s)" << endl;
+    cout << "✓ " << NUM_LOOKUPS << " random page lookups:" << endl;
+    cout << "    ReadPage copy:   " << read_lookup_ms << " ms" << endl;
+    cout << "    mmap view:       " << mmap_lookup_ms << " ms" << endl;
+    
+    cout << "Test 19 PASSED" << endl;
+}
+
+// Test 20: Frame Arena and Huge Pages
+void TestFrameArena() {
+    cout << "\n=== Test 20: Frame Arena and Huge Pages ===" << endl;
+    
+    const int NUM_PAGES = 32768;  // 256MB pool
+    const int BATCH = 1024;
+    const int NUM_ACCESSES = 2000000;
+    
+    DiskManager disk_manager("test_arena.db");
+    vector<page_id_t> page_ids;
+    {
+        vector<Page> pages(BATCH);
+        for (int start = 0; start < NUM_PAGES; start += BATCH) {
+            vector<pair<page_id_t, const Page*>> batch;
+            for (int i = 0; i < BATCH; ++i) {
+                page_id_t page_id = disk_manager.AllocatePage();
+                page_ids.push_back(page_id);
+                pages[i].GetHeader()->page_id = page_id;
+                reinterpret_cast<uint32_t*>(pages[i].GetData())[0] = page_id;
+                batch.emplace_back(page_id, &pages[i]);
+            }
+            disk_manager.WritePages(batch);
+        }
+    }
+    
+    // Arena frames are aligned and read as empty pages before first use
+    {
+        FrameArena arena(4);
+        for (size_t i = 0; i < arena.GetNumFrames(); ++i) {
+            const Page& frame = arena.GetFrames()[i];
+            assert(reinterpret_cast<uintptr_t>(&frame) % PAGE_ALIGNMENT == 0);
+            assert(frame.GetHeader()->page_id == 0 && frame.GetHeader()->checksum == 0);
+            (void)frame;
+        }
+    }
+    
+    // What the previous new Page[] startup cost: every frame is memset
+    auto start = chrono::high_resolution_clock::now();
+    Page* old_frames = new Page[NUM_PAGES];
+    double old_startup_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+    delete[] old_frames;
+    cout << "✓ new Page[" << NUM_PAGES << "] startup: " << old_startup_ms << " ms" << endl;
+    
+    const char* mode_names[] = {"none", "transparent", "explicit"};
+    for (HugePageMode mode : {HugePageMode::NONE, HugePageMode::TRANSPARENT, HugePageMode::EXPLICIT}) {
+        BufferPoolOptions options;
+        options.huge_pages = mode;
+        options.read_ahead_pages = 0;
+        start = chrono::high_resolution_clock::now();
+        BufferPoolManager bpm(NUM_PAGES, &disk_manager, options);
+        double startup_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        
+        // Load every page, then random hits that also read the page
+        for (page_id_t page_id : page_ids) {
+            Page* page = bpm.FetchPage(page_id);
+            assert(page != nullptr);
+            (void)page;
+            bpm.UnpinPage(page_id, false);
+        }
+        mt19937 gen(20);
+        uniform_int_distribution<size_t> dis(0, page_ids.size() - 1);
+        uint64_t sum = 0;
+        start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_ACCESSES; ++i) {
+            page_id_t page_id = page_ids[dis(gen)];
+            Page* page = bpm.FetchPage(page_id);
+            sum += reinterpret_cast<const uint32_t*>(page->GetData())[0];
+            bpm.UnpinPage(page_id, false);
+        }
+        double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        assert(bpm.GetMissCount() == static_cast<size_t>(NUM_PAGES));
+        assert(sum > 0);
+        
+        cout << "✓ huge pages " << mode_names[static_cast<int>(mode)] << " (got "
+             << mode_names[static_cast<int>(bpm.GetHugePageMode())] << "): startup "
+             << startup_ms << " ms, " << static_cast<size_t>(NUM_ACCESSES / seconds)
+             << " random hits/s" << endl;
+    }
+    
+    cout << "Test 20 PASSED" << endl;
+}
+
+// Test 21: Online Buffer Pool Resize
+void TestOnlineResize() {
+    cout << "\n=== Test 21: Online Buffer Pool Resize ===" << endl;
+    
+    const int NUM_PAGES = 400;
+    const int NUM_THREADS = 3;
+    const size_t MAX_POOL = 256;
+    
+    DiskManager disk_manager("test_resize.db");
+    BufferPoolOptions options;
+    options.max_pool_size = MAX_POOL;
+    options.enable_page_cleaner = true;
+    options.read_ahead_pages = 0;  // Keeps check_frames' frame accounting exact
+    BufferPoolManager bpm(64, &disk_manager, options);
+    assert(bpm.GetPoolSize() == 64 && bpm.GetMaxPoolSize() == MAX_POOL);
+    
+    vector<page_id_t> page_ids;
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        page_id_t page_id;
+        Page* page = bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        bpm.UnpinPage(page_id, true);
+        page_ids.push_back(page_id);
+    }
+    
+    // Only pool_size frames are usable, each holds a distinct page
+    auto check_frames = [&]() {
+        size_t pool_size = bpm.GetPoolSize();
+        vector<Page*> pinned;
+        for (size_t i = 0; i < pool_size; ++i) {
+            Page* page = bpm.FetchPage(page_ids[i]);
+            assert(page != nullptr);
+            pinned.push_back(page);
+        }
+        assert(bpm.FetchPage(page_ids[pool_size]) == nullptr);
+        vector<Page*> sorted = pinned;
+        sort(sorted.begin(), sorted.end());
+        assert(adjacent_find(sorted.begin(), sorted.end()) == sorted.end());
+        assert(sorted.back() - sorted.front() < static_cast<ptrdiff_t>(pool_size));
+        for (size_t i = 0; i < pool_size; ++i) {
+            assert(pinned[i]->GetHeader()->page_id == page_ids[i]);
+            bpm.UnpinPage(page_ids[i], false);
+        }
+    };
+    check_frames();
+    
+    // Increment per-page counters from several threads while resizing
+    vector<atomic<uint32_t>> expected(NUM_PAGES);
+    atomic<bool> stop(false);
+    vector<thread> workers;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        workers.emplace_back([&, t]() {
+            mt19937 gen(t + 21);
+            uniform_int_distribution<> dis(0, NUM_PAGES - 1);
+            while (!stop) {
+                int idx = dis(gen);
+                WritePageGuard guard = bpm.FetchPageWrite(page_ids[idx]);
+                if (!guard.IsValid()) {
+                    continue;  // Every frame pinned at this size, retry
+                }
+                reinterpret_cast<uint32_t*>(guard.GetData())[0]++;
+                expected[idx]++;
+            }
+        });
+    }
+    
+    const size_t sizes[] = {256, 32, 128, 8, 200, 16, 256, 64};
+    for (int round = 0; round < 3; ++round) {
+        for (size_t size : sizes) {
+            bpm.Resize(size);
+            assert(bpm.GetPoolSize() == size);
+            this_thread::sleep_for(chrono::milliseconds(5));
+        }
+    }
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    check_frames();
+    
+    bool threw = false;
+    try {
+        bpm.Resize(MAX_POOL + 1);
+    } catch (const invalid_argument&) {
+        threw = true;
+    }
+    assert(threw);
+    
+    // Every update survived the evictions that shrinking forced
+    uint32_t total = 0;
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        ReadPageGuard guard = bpm.FetchPageRead(page_ids[i]);
+        assert(reinterpret_cast<const uint32_t*>(guard.GetData())[0] == expected[i]);
+        total += expected[i];
+    }
+    cout << "✓ " << total << " updates from " << NUM_THREADS << " threads across "
+         << 3 * sizeof(sizes) / sizeof(sizes[0]) << " resizes between 8 and " << MAX_POOL
+         << " frames, none lost" << endl;
+    cout << "✓ No page double-mapped, only the active frames are used" << endl;
+    
+    cout << "Test 21 PASSED" << endl;
+}
+
+// Test 22: Warm-Up Across Restarts
+void TestWarmUp() {
+    cout << "\n=== Test 22: Warm-Up Across Restarts ===" << endl;
+    
+    const int NUM_PAGES = 16384;
+    const size_t POOL_SIZE = 2048;
+    const int WINDOW = 1000;
+    const int NUM_WINDOWS = 40;
+    const char* WARM_UP_FILE = "test_warmup.warm";
+    
+    DiskManager disk_manager("test_warmup.db", true);
+    vector<page_id_t> page_ids;
+    {
+        vector<Page> pages(NUM_PAGES);
+        vector<pair<page_id_t, const Page*>> batch;
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+            pages[i].GetHeader()->page_id = page_ids[i];
+            reinterpret_cast<uint32_t*>(pages[i].GetData())[0] = i;
+            batch.emplace_back(page_ids[i], &pages[i]);
+        }
+        disk_manager.WritePages(batch);
+    }
+    remove(WARM_UP_FILE);
+    
+    // Skewed traffic with the hot pages scattered over the file
+    vector<int> rank_to_page(NUM_PAGES);
+    for (int i = 0; i < NUM_PAGES; ++i) {
+        rank_to_page[i] = i;
+    }
+    shuffle(rank_to_page.begin(), rank_to_page.end(), mt19937(22));
+    
+    // Hit rate of each window of accesses, and the time they took
+    auto run = [&](BufferPoolManager& bpm, uint32_t seed, vector<double>* hit_rates,
+                   vector<double>* elapsed_ms) {
+        ZipfianGenerator zipf(NUM_PAGES, 0.99, seed);
+        auto start = chrono::high_resolution_clock::now();
+        for (int w = 0; w < NUM_WINDOWS; ++w) {
+            size_t hits_before = bpm.GetHitCount();
+            for (int i = 0; i < WINDOW; ++i) {
+                int idx = rank_to_page[zipf.Next()];
+                Page* page = bpm.FetchPage(page_ids[idx]);
+                assert(page != nullptr);
+                assert(reinterpret_cast<uint32_t*>(page->GetData())[0] == static_cast<uint32_t>(idx));
+                bpm.UnpinPage(page_ids[idx], false);
+            }
+            hit_rates->push_back(static_cast<double>(bpm.GetHitCount() - hits_before) / WINDOW);
+            elapsed_ms->push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
+        }
+    };
+    
+    BufferPoolOptions options;
+    options.read_ahead_pages = 0;
+    vector<double> steady_rates, steady_ms;
+    {
+        // Previous run: reach steady state, then shut down with a dump
+        BufferPoolOptions dumping = options;
+        dumping.warm_up_file = WARM_UP_FILE;
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, dumping);
+        run(bpm, 1, &steady_rates, &steady_ms);
+        run(bpm, 2, &steady_rates, &steady_ms);
+    }
+    double steady = 0;
+    for (int w = NUM_WINDOWS; w < 2 * NUM_WINDOWS; ++w) {
+        steady += steady_rates[w] / NUM_WINDOWS;
+    }
+    
+    // First window at 95% of the steady hit rate, or -1
+    auto settle = [&](const vector<double>& hit_rates) {
+        for (size_t w = 0; w < hit_rates.size(); ++w) {
+            if (hit_rates[w] >= 0.95 * steady) {
+                return static_cast<int>(w);
+            }
+        }
+        return -1;
+    };
+    
+    vector<double> cold_rates, cold_ms, warm_rates, warm_ms;
+    {
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+        run(bpm, 3, &cold_rates, &cold_ms);
+    }
+    double restore_ms;
+    size_t restored;
+    {
+        BufferPoolOptions restoring = options;
+        restoring.warm_up_file = WARM_UP_FILE;
+        auto start = chrono::high_resolution_clock::now();
+        BufferPoolManager bpm(POOL_SIZE, &disk_manager, restoring);
+        restore_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        restored = bpm.GetPrefetchCount();
+        run(bpm, 3, &warm_rates, &warm_ms);
+    }
+    assert(restored == POOL_SIZE);
+    
+    int cold_settle = settle(cold_rates);
+    int warm_settle = settle(warm_rates);
+    assert(warm_rates[0] > cold_rates[0] + 0.1);
+    assert(warm_settle >= 0 && (cold_settle < 0 || warm_settle <= cold_settle));
+    
+    auto describe = [&](int settle_window, const vector<double>& elapsed) {
+        if (settle_window < 0) {
+            return string("not within ") + to_string(NUM_WINDOWS * WINDOW) + " accesses";
+        }
+        return to_string((settle_window + 1) * WINDOW) + " accesses, " +
+               to_string(static_cast<int>(elapsed[settle_window])) + " ms";
+    };
+    cout << "✓ Steady-state hit rate " << (steady * 100) << "% (" << POOL_SIZE
+         << " frames, Zipfian over " << NUM_PAGES << " O_DIRECT pages)" << endl;
+    cout << "    cold start: first " << WINDOW << " accesses " << (cold_rates[0] * 100)
+         << "% hits, steady after " << describe(cold_settle, cold_ms) << endl;
+    cout << "    warm-up:    " << restored << " pages restored in " << restore_ms << " ms, first "
+         << WINDOW << " accesses " << (warm_rates[0] * 100) << "% hits, steady after "
+         << describe(warm_settle, warm_ms) << endl;
+    
+    cout << "Test 22 PASSED" << endl;
+}
+
+// Test 23: Free Space Map
+void TestFreeSpaceMap() {
+    cout << "\n=== Test 23: Free Space Map ===" << endl;
+    
+    const int NUM_PAGES = 150000;
+    const int NUM_FREED = 100000;
+    const char* DB_FILE = "test_fsm.db";
+    remove(DB_FILE);
+    
+    vector<page_id_t> page_ids;
+    vector<page_id_t> freed;
+    page_id_t num_pages;
+    double free_ns;
+    {
+        DiskManager disk_manager(DB_FILE);
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_ids.push_back(disk_manager.AllocatePage());
+        }
+        // Sequential ids that step over the map pages of each group
+        for (page_id_t page_id : page_ids) {
+            assert((page_id - FIRST_FSM_PAGE_ID) % FSM_PAGE_BITS != 0);
+            (void)page_id;
+        }
+        num_pages = disk_manager.GetNumPages();
+        assert(num_pages == page_ids.back() + 1);
+        
+        freed = page_ids;
+        shuffle(freed.begin(), freed.end(), mt19937(23));
+        freed.resize(NUM_FREED);
+        auto start = chrono::high_resolution_clock::now();
+        for (page_id_t page_id : freed) {
+            disk_manager.DeallocatePage(page_id);
+        }
+        free_ns = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / NUM_FREED;
+        // Freeing twice is harmless
+        disk_manager.DeallocatePage(freed[0]);
+        assert(disk_manager.GetFreePageCount() == static_cast<size_t>(NUM_FREED));
+        
+        // Flush persists the map without closing the file
+        disk_manager.Flush();
+        DiskManager reader(DB_FILE);
+        assert(reader.GetNumPages() == num_pages);
+        assert(reader.GetFreePageCount() == static_cast<size_t>(NUM_FREED));
+    }
+    cout << "✓ Freed " << NUM_FREED << " of " << NUM_PAGES << " pages, "
+         << free_ns << " ns per deallocation" << endl;
+    
+    sort(freed.begin(), freed.end());
+    {
+        DiskManager disk_manager(DB_FILE);
+        assert(disk_manager.GetNumPages() == num_pages);
+        assert(disk_manager.GetFreePageCount() == static_cast<size_t>(NUM_FREED));
+        
+        // Every freed page comes back exactly once before the file grows
+        vector<page_id_t> reused;
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_FREED; ++i) {
+            reused.push_back(disk_manager.AllocatePage());
+        }
+        double alloc_ns = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() / NUM_FREED;
+        sort(reused.begin(), reused.end());
+        assert(reused == freed);
+        assert(disk_manager.GetFreePageCount() == 0);
+        assert(disk_manager.GetNumPages() == num_pages);
+        assert(disk_manager.AllocatePage() == num_pages);
+        cout << "✓ Reopened and reallocated all " << NUM_FREED << " pages, "
+             << alloc_ns << " ns per allocation" << endl;
+        
+        // Contiguous runs reuse a free run, else extend the file
+        page_id_t run_first = page_ids[1000];
+        for (int i = 0; i < 64; ++i) {
+            disk_manager.DeallocatePage(run_first + i);
+        }
+        disk_manager.DeallocatePage(page_ids[5000]);
+        assert(disk_manager.AllocatePages(64) == run_first);
+        page_id_t end = disk_manager.GetNumPages();
+        assert(disk_manager.AllocatePages(100) == end);
+        assert(disk_manager.GetNumPages() == end + 100);
+        assert(disk_manager.AllocatePage() == page_ids[5000]);
+        cout << "✓ 64-page run reused in place, 100-page run appended" << endl;
+    }
+    
+    // Version 1 files are migrated from the old single-page free list
+    remove(DB_FILE);
+    {
+        vector<Page> pages(10);
+        pages[0].GetHeader()->page_id = HEADER_PAGE_ID;
+        pages[0].GetHeader()->page_type = PageType::HEADER;
+        uint32_t version = 1;
+        memcpy(pages[0].GetData(), &version, sizeof(version));
+        pages[1].GetHeader()->page_id = 1;
+        pages[1].GetHeader()->page_type = PageType::FREE_LIST;
+        pages[1].GetHeader()->num_records = 2;
+        page_id_t old_free[2] = {7, 4};
+        memcpy(pages[1].GetData(), old_free, sizeof(old_free));
+        ofstream out(DB_FILE, ios::binary);
+        for (const Page& page : pages) {
+            out.write(page.GetRawData(), PAGE_SIZE);
+        }
+    }
+    {
+        DiskManager disk_manager(DB_FILE);
+        assert(disk_manager.GetFreePageCount() == 2);
+        assert(disk_manager.AllocatePage() == 4);
+        assert(disk_manager.AllocatePage() == 7);
+        assert(disk_manager.AllocatePage() == 10);
+    }
+    {
+        DiskManager disk_manager(DB_FILE);
+        assert(disk_manager.GetNumPages() == 11);
+        assert(disk_manager.GetFreePageCount() == 0);
+    }
+    cout << "✓ Version 1 free list migrated" << endl;
+    remove(DB_FILE);
+    
+    cout << "Test 23 PASSED" << endl;
+}
+
+// Test 24: Extent-Based File Growth
+void TestExtentGrowth() {
+    cout << "\n=== Test 24: Extent-Based File Growth ===" << endl;
+    
+    const int NUM_PAGES = 65536;  // 512MB
+    const char* DB_FILE = "test_extent.db";
+    
+    Page page;
+    page.GetHeader()->page_type = PageType::DATA;
+    
+    // Bulk insert one page at a time, as a loader appending to the file
+    // would; returns the time for the writes and for the final sync
+    auto insert = [&](bool direct_io, size_t extent_pages) {
+        remove(DB_FILE);
+        DiskManager disk_manager(DB_FILE, direct_io, true, extent_pages);
+        auto start = chrono::high_resolution_clock::now();
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id = disk_manager.AllocatePage();
+            page.GetHeader()->page_id = page_id;
+            disk_manager.WritePage(page_id, &page);
+        }
+        auto written = chrono::high_resolution_clock::now();
+        disk_manager.Flush();
+        auto synced = chrono::high_resolution_clock::now();
+        return make_pair(chrono::duration<double, milli>(written - start).count(),
+                         chrono::duration<double, milli>(synced - written).count());
+    };
+    
+    for (bool direct_io : {false, true}) {
+        auto per_page = insert(direct_io, 0);
+        page_id_t used_pages;
+        {
+            DiskManager disk_manager(DB_FILE, direct_io, true, 0);
+            used_pages = disk_manager.GetNumPages();
+            assert(disk_manager.GetAllocatedPages() == used_pages);
+        }
+        
+        auto extents = insert(direct_io, FILE_EXTENT_PAGES);
+        {
+            // The header tells pages in use from the preallocated tail
+            DiskManager disk_manager(DB_FILE, direct_io);
+            assert(disk_manager.GetNumPages() == used_pages);
+            assert(disk_manager.GetAllocatedPages() % FILE_EXTENT_PAGES == 0);
+            assert(disk_manager.GetAllocatedPages() >= used_pages);
+            assert(disk_manager.GetAllocatedPages() < used_pages + FILE_EXTENT_PAGES);
+            MmapDiskManager mmap_manager(DB_FILE);
+            assert(mmap_manager.GetNumPages() == used_pages);
+            
+            // Reopened, the file keeps growing at the end of the used pages
+            assert(disk_manager.AllocatePage() == used_pages);
+        }
+        
+        cout << "✓ " << NUM_PAGES << (direct_io ? " O_DIRECT" : " buffered")
+             << " page inserts + sync, page-by-page growth: " << per_page.first << " + "
+             << per_page.second << " ms, " << FILE_EXTENT_PAGES << "-page extents: "
+             << extents.first << " + " << extents.second << " ms" << endl;
+    }
+    remove(DB_FILE);
+    
+    cout << "Test 24 PASSED" << endl;
+}
+
+// Test 25: Write-Ahead Log and Group Commit
+void TestWriteAheadLog() {
+    cout << "\n=== Test 25: Write-Ahead Log and Group Commit ===" << endl;
+    
+    const char* LOG_FILE = "test_wal.log";
+    remove(LOG_FILE);
+    
+    // Records come back intact; a torn record at the end is dropped on open
+    const int NUM_RECORDS = 1000;
+    lsn_t end_lsn;
+    {
+        LogManager log_manager(LOG_FILE);
+        char payload[100];
+        for (int i = 0; i < NUM_RECORDS; ++i) {
+            memset(payload, i & 0xFF, sizeof(payload));
+            log_manager.AppendRecord(LogRecordType::UPDATE, i, i, PAGE_HEADER_SIZE, payload, 1 + i % 100);
+        }
+        end_lsn = log_manager.Commit(NUM_RECORDS);
+        assert(log_manager.GetFlushedLSN() == end_lsn);
+        assert(log_manager.GetSyncCount() == 1);
+    }
+    {
+        ofstream out(LOG_FILE, ios::binary | ios::app);
+        LogRecordHeader torn = {};
+        torn.size = 4096;
+        out.write(reinterpret_cast<const char*>(&torn), sizeof(torn));
+    }
+    {
+        LogManager log_manager(LOG_FILE);
+        assert(log_manager.GetNextLSN() == end_lsn);
+        log_manager.Commit(NUM_RECORDS + 1);
+    }
+    {
+        LogReader reader(LOG_FILE);
+        LogRecord record;
+        for (int i = 0; i < NUM_RECORDS; ++i) {
+            bool ok = reader.Next(&record);
+            assert(ok);
+            (void)ok;
+            assert(record.header.type == LogRecordType::UPDATE);
+            assert(record.header.txn_id == static_cast<txn_id_t>(i));
+            assert(record.payload.size() == static_cast<size_t>(1 + i % 100));
+            assert(record.payload[0] == static_cast<char>(i & 0xFF));
+        }
+        assert(reader.Next(&record) && record.header.type == LogRecordType::COMMIT);
+        assert(reader.GetLSN() == end_lsn);
+        assert(reader.Next(&record) && record.header.txn_id == NUM_RECORDS + 1);
+        assert(!reader.Next(&record));
+    }
+    cout << "✓ " << NUM_RECORDS << " records read back, torn tail dropped on reopen" << endl;
+    
+    // Write-ahead rule: evicting a dirty page first makes its log durable
+    remove(LOG_FILE);
+    {
+        DiskManager disk_manager("test_wal.db");
+        LogManager log_manager(LOG_FILE);
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        options.log_manager = &log_manager;
+        BufferPoolManager bpm(4, &disk_manager, options);
+        
+        vector<page_id_t> page_ids(4);
+        vector<lsn_t> page_lsns(4);
+        for (int i = 0; i < 4; ++i) {
+            Page* page = bpm.NewPage(&page_ids[i]);
+            assert(page != nullptr);
+            memcpy(page->GetData(), "logged", 6);
+            page_lsns[i] = log_manager.LogUpdate(1, page_ids[i], page, PAGE_HEADER_SIZE, 6);
+            bpm.UnpinPage(page_ids[i], true);
+        }
+        assert(log_manager.GetFlushedLSN() == INVALID_LSN);
+        
+        page_id_t extra_id;
+        assert(bpm.NewPage(&extra_id) != nullptr);  // Evicts page_ids[0]
+        bpm.UnpinPage(extra_id, false);
+        assert(log_manager.GetFlushedLSN() >= page_lsns[0]);
+        
+        Page on_disk;
+        disk_manager.ReadPage(page_ids[0], &on_disk);
+        assert(on_disk.GetLSN() == page_lsns[0]);
+        assert(memcmp(on_disk.GetData(), "logged", 6) == 0);
+        
+        bpm.FlushAllPages();
+        assert(log_manager.GetFlushedLSN() >= page_lsns[3]);
+    }
+    remove("test_wal.db");
+    cout << "✓ Dirty pages reach disk only after their log records" << endl;
+    
+    // A page stamped past the end of a new log is still written back,
+    // flushing the log only as far as it goes
+    remove(LOG_FILE);
+    {
+        DiskManager disk_manager("test_wal.db");
+        LogManager log_manager(LOG_FILE);
+        BufferPoolOptions options;
+        options.log_manager = &log_manager;
+        BufferPoolManager bpm(4, &disk_manager, options);
+        
+        lsn_t log_end = log_manager.Commit(1);
+        page_id_t page_id;
+        Page* page = bpm.NewPage(&page_id);
+        assert(page != nullptr);
+        page->SetLSN(log_end + 1000000);
+        bpm.UnpinPage(page_id, true);
+        bool flushed = bpm.FlushPage(page_id);
+        assert(flushed);
+        (void)flushed;
+        assert(log_manager.GetFlushedLSN() == log_end);
+        
+        Page on_disk;
+        disk_manager.ReadPage(page_id, &on_disk);
+        assert(on_disk.GetLSN() == log_end + 1000000);
+    }
+    remove("test_wal.db");
+    cout << "✓ A page with an LSN past the log end is written back" << endl;
+    
+    // Commit throughput: each commit logs an update and waits for it to be durable
+    const int TOTAL_COMMITS = 4096;
+    vector<double> rates;
+    vector<double> commits_per_sync;
+    for (int writers : {1, 8, 64}) {
+        remove(LOG_FILE);
+        LogManager log_manager(LOG_FILE);
+        int per_writer = TOTAL_COMMITS / writers;
+        
+        auto start = chrono::high_resolution_clock::now();
+        vector<thread> threads;
+        for (int t = 0; t < writers; ++t) {
+            threads.emplace_back([&, t]() {
+                char payload[64];
+                memset(payload, t, sizeof(payload));
+                for (int i = 0; i < per_writer; ++i) {
+                    txn_id_t txn_id = static_cast<txn_id_t>(t) * per_writer + i + 1;
+                    log_manager.AppendRecord(LogRecordType::UPDATE, txn_id, t, PAGE_HEADER_SIZE,
+                                             payload, sizeof(payload));
+                    lsn_t lsn = log_manager.Commit(txn_id);
+                    assert(log_manager.GetFlushedLSN() >= lsn);
+                    (void)lsn;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        double seconds = chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        
+        int commits = per_writer * writers;
+        rates.push_back(commits / seconds);
+        commits_per_sync.push_back(static_cast<double>(commits) / log_manager.GetSyncCount());
+    }
+    remove(LOG_FILE);
+    
+    // One writer pays one sync per commit; concurrent ones share them
+    assert(commits_per_sync[0] == 1.0);
+    assert(commits_per_sync[2] > 4.0);
+    assert(rates[2] > 2 * rates[0]);
+    
+    cout << "✓ Commit throughput (update + commit record, fdatasync per group):" << endl;
+    const int writer_counts[] = {1, 8, 64};
+    for (size_t i = 0; i < rates.size(); ++i) {
+        cout << "    " << writer_counts[i] << " writer" << (writer_counts[i] == 1 ? ": " : "s: ")
+             << static_cast<int>(rates[i]) << " commits/s, " << commits_per_sync[i]
+             << " commits per sync" << endl;
+    }
+    
+    cout << "Test 25 PASSED" << endl;
+}
+
+// Test 26: Fuzzy Checkpoint and Recovery
+void TestCheckpointRecovery() {
+    cout << "\n=== Test 26: Fuzzy Checkpoint and Recovery ===" << endl;
+    
+    const char* DB_FILE = "test_recovery.db";
+    const char* LOG_FILE = "test_recovery.log";
+    remove(DB_FILE);
+    remove(LOG_FILE);
+    
+    // A child process fills pages, checkpoints, keeps committing and then
+    // dies without flushing the pool; the last transaction never commits
+    const int NUM_PAGES = 256;
+    const int ROUNDS = 4;
+    const txn_id_t UNCOMMITTED_TXN = 1000;
+    pid_t pid = fork();
+    if (pid == 0) {
+        DiskManager disk_manager(DB_FILE);
+        LogManager log_manager(LOG_FILE);
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        options.log_manager = &log_manager;
+        BufferPoolManager bpm(64, &disk_manager, options);
+        
+        auto update = [&](txn_id_t txn_id, page_id_t page_id, uint64_t value) {
+            Page* page = bpm.FetchPage(page_id);
+            memcpy(page->GetData(), &value, sizeof(value));
+            log_manager.LogUpdate(txn_id, page_id, page, PAGE_HEADER_SIZE, sizeof(value));
+            bpm.UnpinPage(page_id, true);
+        };
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            page_id_t page_id;
+            bpm.NewPage(&page_id);
+            assert(page_id == static_cast<page_id_t>(FIRST_FSM_PAGE_ID + 1 + i));
+            bpm.UnpinPage(page_id, true);
+        }
+        for (int round = 1; round <= ROUNDS; ++round) {
+            for (int i = 0; i < NUM_PAGES; ++i) {
+                update(round, FIRST_FSM_PAGE_ID + 1 + i, round);
+            }
+            log_manager.Commit(round);
+            if (round == ROUNDS / 2) {
+                bpm.Checkpoint();
+            }
+        }
+        for (int i = 0; i < 10; ++i) {
+            update(UNCOMMITTED_TXN, FIRST_FSM_PAGE_ID + 1 + i, 99);
+        }
+        log_manager.FlushAll();
+        _exit(0);
+    }
+    int status;
+    waitpid(pid, &status, 0);
+    assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+    
+    size_t total_records = 0;
+    {
+        LogReader reader(LOG_FILE);
+        LogRecord record;
+        while (reader.Next(&record)) {
+            total_records++;
+        }
+    }
+    
+    // Tear a page: only its first half made it to disk
+    page_id_t torn_page_id = FIRST_FSM_PAGE_ID + 1 + NUM_PAGES / 2;
+    {
+        fstream file(DB_FILE, ios::in | ios::out | ios::binary);
+        vector<char> garbage(PAGE_SIZE / 2, static_cast<char>(0xAB));
+        file.seekp(static_cast<streamoff>(torn_page_id) * PAGE_SIZE + PAGE_SIZE / 2);
+        file.write(garbage.data(), garbage.size());
+    }
+    
+    {
+        DiskManager disk_manager(DB_FILE);
+        RecoveryStats stats = RecoveryManager(&disk_manager, LOG_FILE).Recover();
+        assert(stats.checkpoint_lsn != INVALID_LSN);
+        assert(stats.redo_lsn <= stats.checkpoint_lsn);
+        assert(stats.records_scanned < total_records);
+        assert(stats.records_applied > 0);
+        assert(stats.uncommitted_txns == vector<txn_id_t>{UNCOMMITTED_TXN});
+        
+        for (int i = 0; i < NUM_PAGES; ++i) {
+            Page page;
+            disk_manager.ReadPage(FIRST_FSM_PAGE_ID + 1 + i, &page);
+            uint64_t value;
+            memcpy(&value, page.GetData(), sizeof(value));
+            assert(page.VerifyChecksum());
+            // Redo only: the uncommitted changes are reported, not undone
+            assert(value == (i < 10 ? 99u : static_cast<uint64_t>(ROUNDS)));
+        }
+        cout << "✓ Recovered " << NUM_PAGES << " pages and a torn page from the checkpoint: "
+             << stats.records_scanned << " of " << total_records << " log records scanned, "
+             << stats.records_applied << " applied, " << stats.uncommitted_txns.size()
+             << " uncommitted transaction" << endl;
+        
+        // Recovery is idempotent: nothing left to apply the second time
+        RecoveryStats again = RecoveryManager(&disk_manager, LOG_FILE).Recover();
+        assert(again.records_applied == 0);
+        (void)again;
+    }
+    
+    // Allocations are not logged: a page reused after the free space map
+    // was last written is rebuilt from the log and must stay allocated
+    {
+        page_id_t freed_page_id = FIRST_FSM_PAGE_ID + NUM_PAGES;
+        {
+            DiskManager disk_manager(DB_FILE);
+            disk_manager.DeallocatePage(freed_page_id);
+            disk_manager.Flush();
+        }
+        pid_t child = fork();
+        if (child == 0) {
+            DiskManager disk_manager(DB_FILE);
+            LogManager log_manager(LOG_FILE);
+            BufferPoolOptions options;
+            options.read_ahead_pages = 0;
+            options.log_manager = &log_manager;
+            BufferPoolManager bpm(16, &disk_manager, options);
+            page_id_t page_id;
+            Page* page = bpm.NewPage(&page_id);
+            if (page_id != freed_page_id) {
+                _exit(1);
+            }
+            uint64_t value = 42;
+            memcpy(page->GetData(), &value, sizeof(value));
+            log_manager.LogUpdate(2000, page_id, page, PAGE_HEADER_SIZE, sizeof(value));
+            log_manager.Commit(2000);
+            log_manager.FlushAll();
+            _exit(0);
+        }
+        waitpid(child, &status, 0);
+        assert(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+        
+        DiskManager disk_manager(DB_FILE);
+        RecoveryManager(&disk_manager, LOG_FILE).Recover();
+        Page page;
+        disk_manager.ReadPage(freed_page_id, &page);
+        uint64_t value;
+        memcpy(&value, page.GetData(), sizeof(value));
+        assert(value == 42);
+        (void)value;
+        page_id_t next_page_id = disk_manager.AllocatePage();
+        assert(next_page_id != freed_page_id);
+        disk_manager.DeallocatePage(next_page_id);
+    }
+    {
+        // The claim is durable, not only in the recovering process
+        DiskManager disk_manager(DB_FILE);
+        page_id_t next_page_id = disk_manager.AllocatePage();
+        assert(next_page_id != FIRST_FSM_PAGE_ID + NUM_PAGES);
+        (void)next_page_id;
+    }
+    cout << "✓ A page allocated after the last flush stays allocated after recovery" << endl;
+    
+    // A parallel pool checkpoints all of its instances under one record
+    {
+        DiskManager disk_manager(DB_FILE);
+        LogManager log_manager(LOG_FILE);
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        options.log_manager = &log_manager;
+        ParallelBufferPoolManager bpm(4, 16, &disk_manager, options);
+        for (int i = 0; i < 32; ++i) {
+            Page* page = bpm.FetchPage(FIRST_FSM_PAGE_ID + 1 + i);
+            assert(page != nullptr);
+            (void)page;
+            bpm.UnpinPage(FIRST_FSM_PAGE_ID + 1 + i, true);
+        }
+        lsn_t before = log_manager.GetNextLSN();
+        size_t written = bpm.Checkpoint();
+        assert(written == 32);
+        assert(disk_manager.GetCheckpointLSN() == before);
+        assert(disk_manager.GetRedoLSN() == before);
+        (void)written;
+        (void)before;
+    }
+    cout << "✓ Parallel pool writes back every instance in one checkpoint" << endl;
+    
+    // Flushing a pinned page leaves it dirty at its old recovery LSN: the
+    // pin holder may have logged a change it has not finished applying, so
+    // the next checkpoint must still redo from before that change
+    {
+        DiskManager disk_manager(DB_FILE);
+        LogManager log_manager(LOG_FILE);
+        BufferPoolOptions options;
+        options.read_ahead_pages = 0;
+        options.log_manager = &log_manager;
+        BufferPoolManager bpm(16, &disk_manager, options);
+        page_id_t page_id = FIRST_FSM_PAGE_ID + 1;
+        Page* page = bpm.FetchPage(page_id);
+        uint64_t value = 7;
+        memcpy(page->GetData(), &value, sizeof(value));
+        lsn_t update_lsn = log_manager.LogUpdate(1, page_id, page, PAGE_HEADER_SIZE, sizeof(value));
+        log_manager.Commit(1);
+        bool flushed = bpm.FlushPage(page_id);
+        assert(flushed);
+        (void)flushed;
+        bpm.Checkpoint();
+        assert(disk_manager.GetRedoLSN() <= update_lsn);
+        (void)update_lsn;
+        bpm.UnpinPage(page_id, true);
+        // Unpinned, the page is written once more and the redo point moves on
+        size_t written = bpm.Checkpoint();
+        assert(written == 1 && disk_manager.GetRedoLSN() > update_lsn);
+        (void)written;
+    }
+    cout << "✓ A flushed pinned page keeps the redo point at its recovery LSN" << endl;
+    remove(DB_FILE);
+    remove(LOG_FILE);
+    
+    // Foreground latency while every page of the pool is written back:
+    // FlushAllPages holds the pool latch for the whole write, a checkpoint
+    // only for one batch of copies at a time
+    const size_t POOL_SIZE = 4096;
+    DiskManager disk_manager("test_checkpoint.db", true);
+    LogManager log_manager(LOG_FILE);
+    BufferPoolOptions options;
+    options.read_ahead_pages = 0;
+    options.log_manager = &log_manager;
+    BufferPoolManager bpm(POOL_SIZE, &disk_manager, options);
+    vector<page_id_t> page_ids(POOL_SIZE);
+    for (size_t i = 0; i < POOL_SIZE; ++i) {
+        bpm.NewPage(&page_ids[i]);
+        bpm.UnpinPage(page_ids[i], true);
+    }
+    
+    atomic<bool> measuring(false);
+    atomic<bool> stop(false);
+    mutex latencies_mutex;
+    vector<double> latencies;
+    thread worker([&]() {
+        mt19937 rng(26);
+        uniform_int_distribution<size_t> pick(0, POOL_SIZE - 1);
+        while (!stop) {
+            page_id_t page_id = page_ids[pick(rng)];
+            auto start = chrono::high_resolution_clock::now();
+            Page* page = bpm.FetchPage(page_id);
+            page->GetData()[0]++;
+            bpm.UnpinPage(page_id, true);
+            double micros = chrono::duration<double, micro>(chrono::high_resolution_clock::now() - start).count();
+            if (measuring) {
+                lock_guard<mutex> lock(latencies_mutex);
+                latencies.push_back(micros);
+            }
+        }
+    });
+    
+    auto measure = [&](const function<void()>& write_back, double* p99, double* max_latency) {
+        for (page_id_t page_id : page_ids) {
+            bpm.FetchPage(page_id);
+            bpm.UnpinPage(page_id, true);
+        }
+        {
+            lock_guard<mutex> lock(latencies_mutex);
+            latencies.clear();
+        }
+        measuring = true;
+        auto start = chrono::high_resolution_clock::now();
+        write_back();
+        double millis = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        measuring = false;
+        
+        vector<double> sorted;
+        {
+            lock_guard<mutex> lock(latencies_mutex);
+            sorted = latencies;
+        }
+        sort(sorted.begin(), sorted.end());
+        assert(!sorted.empty());
+        *p99 = sorted[sorted.size() * 99 / 100];
+        *max_latency = sorted.back();
+        return millis;
+    };
+    
+    double flush_p99, flush_max, checkpoint_p99, checkpoint_max;
+    double flush_ms = measure([&]() { bpm.FlushAllPages(); }, &flush_p99, &flush_max);
+    double checkpoint_ms = measure([&]() { bpm.Checkpoint(); }, &checkpoint_p99, &checkpoint_max);
+    stop = true;
+    worker.join();
+    remove("test_checkpoint.db");
+    remove(LOG_FILE);
+    
+    assert(checkpoint_max < flush_max);
+    
+    cout << "✓ Worker latency while " << POOL_SIZE << " dirty O_DIRECT pages are written back:" << endl;
+    cout << "    FlushAllPages: " << flush_ms << " ms, p99 " << flush_p99 << " us, max "
+         << flush_max << " us" << endl;
+    cout << "    Checkpoint:    " << checkpoint_ms << " ms, p99 " << checkpoint_p99 << " us, max "
+         << checkpoint_max << " us" << endl;
+    
+    cout << "Test 26 PASSED" << endl;
+}
+
+// Test 27: Slotted Table Pages and Table Heap
+void TestTableHeap() {
+    cout << "\n=== Test 27: Slotted Table Pages and Table Heap ===" << endl;
+    
+    // Record i: its index, then its low byte repeated, 16 to 80 bytes long
+    auto make_record = [](uint32_t i, vector<char>* record) {
+        record->assign(16 + (i * 7) % 65, static_cast<char>(i & 0xFF));
+        memcpy(record->data(), &i, sizeof(i));
+    };
+    auto check_record = [&](uint32_t i, const char* data, uint16_t size) {
+        vector<char> expected;
+        make_record(i, &expected);
+        return size == expected.size() && memcmp(data, expected.data(), size) == 0;
+    };
+    
+    // One page: fill it, punch holes, and fill the holes via compaction
+    {
+        Page raw;
+        TablePage page(&raw);
+        page.Init(7, INVALID_PAGE_ID);
+        vector<char> record;
+        vector<uint16_t> slots;
+        uint16_t slot;
+        for (uint32_t i = 0;; ++i) {
+            make_record(i, &record);
+            if (!page.InsertRecord(record.data(), record.size(), &slot)) {
+                break;
+            }
+            assert(slot == i);
+            slots.push_back(slot);
+        }
+        size_t full_count = slots.size();
+        assert(page.GetRecordCount() == full_count);
+        assert(page.GetFreeSpace() < record.size() + sizeof(TableSlot));
+        
+        for (size_t i = 0; i < full_count; i += 2) {
+            assert(page.DeleteRecord(slots[i]));
+        }
+        assert(!page.DeleteRecord(slots[0]));
+        const char* data;
+        uint16_t size;
+        assert(!page.GetRecord(slots[0], &data, &size));
+        
+        // Deleted slots are reused; the holes only fit after compaction
+        size_t refilled = 0;
+        for (uint32_t i = 1000;; ++i) {
+            make_record(i, &record);
+            if (!page.InsertRecord(record.data(), record.size(), &slot)) {
+                break;
+            }
+            assert(slot % 2 == 0);
+            refilled++;
+        }
+        assert(refilled >= full_count / 2 - 1);
+        for (size_t i = 1; i < full_count; i += 2) {
+            assert(page.GetRecord(slots[i], &data, &size));
+            assert(check_record(static_cast<uint32_t>(i), data, size));
+        }
+        
+        // Shrink in place, then grow into the space that freed up
+        make_record(1, &record);
+        assert(page.UpdateRecord(slots[1], record.data(), 8));
+        vector<char> grown(40, 'g');
+        assert(page.UpdateRecord(slots[1], grown.data(), grown.size()));
+        assert(page.GetRecord(slots[1], &data, &size) && size == 40 && data[39] == 'g');
+        vector<char> huge(TablePage::MAX_RECORD_SIZE, 'h');
+        assert(!page.UpdateRecord(slots[3], huge.data(), huge.size()));
+        assert(page.GetRecord(slots[3], &data, &size) && check_record(3, data, size));
+        (void)full_count;
+        cout << "✓ " << full_count << " records per page, " << refilled
+             << " reinserted into the holes of half of them" << endl;
+    }
+    
+    // A table heap across many pages through the buffer pool
+    const char* DB_FILE = "test_table_heap.db";
+    remove(DB_FILE);
+    const uint32_t NUM_RECORDS = 200000;
+    vector<RID> rids(NUM_RECORDS);
+    page_id_t first_page_id;
+    double insert_rate, scan_rate;
+    size_t payload_bytes = 0;
+    size_t num_pages;
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        TableHeap table(&bpm);
+        first_page_id = table.GetFirstPageId();
+        
+        vector<char> record;
+        auto start = chrono::high_resolution_clock::now();
+        for (uint32_t i = 0; i < NUM_RECORDS; ++i) {
+            make_record(i, &record);
+            rids[i] = table.InsertRecord(record.data(), record.size());
+            payload_bytes += record.size();
+        }
+        insert_rate = NUM_RECORDS / chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        
+        start = chrono::high_resolution_clock::now();
+        uint32_t scanned = 0;
+        for (TableIterator it = table.Begin(); !it.IsEnd(); it.Next()) {
+            uint32_t i;
+            memcpy(&i, it.GetData(), sizeof(i));
+            assert(i == scanned && it.GetRID() == rids[i]);
+            assert(check_record(i, it.GetData(), it.GetSize()));
+            scanned++;
+        }
+        scan_rate = NUM_RECORDS / chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        assert(scanned == NUM_RECORDS);
+        num_pages = table.GetPageCount();
+        
+        // Delete every third record, then grow some others by 40 bytes, which
+        // only works while their page has room
+        for (uint32_t i = 0; i < NUM_RECORDS; i += 3) {
+            assert(table.DeleteRecord(rids[i]));
+        }
+        assert(!table.DeleteRecord(rids[0]));
+        vector<char> fetched;
+        assert(!table.GetRecord(rids[0], &fetched));
+        size_t updated = 0;
+        for (uint32_t i = 1; i < NUM_RECORDS; i += 5) {
+            if (i % 3 == 0) {
+                continue;
+            }
+            make_record(i, &record);
+            record.resize(record.size() + 40, static_cast<char>(i & 0xFF));
+            if (table.UpdateRecord(rids[i], record.data(), record.size())) {
+                updated++;
+            }
+        }
+        assert(updated > 0);
+        (void)updated;
+        
+        assert(table.GetRecord(rids[2], &fetched) && check_record(2, fetched.data(), fetched.size()));
+        RID reused = table.InsertRecord(record.data(), record.size());
+        assert(table.GetPageCount() == num_pages);
+        assert(table.DeleteRecord(reused));
+    }
+    
+    // Reopened from its first page, the table has what was left in it
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        TableHeap table(&bpm, first_page_id);
+        uint32_t live = 0;
+        for (TableIterator it = table.Begin(); !it.IsEnd(); it.Next()) {
+            uint32_t i;
+            memcpy(&i, it.GetData(), sizeof(i));
+            assert(i % 3 != 0 && it.GetRID() == rids[i]);
+            assert(i % 5 == 1 || check_record(i, it.GetData(), it.GetSize()));
+            live++;
+        }
+        assert(live == NUM_RECORDS - (NUM_RECORDS + 2) / 3);
+        assert(table.GetPageCount() == num_pages);
+    }
+    
+    // Rounds of deleting half the records and inserting as many again
+    // refill the space the deletes freed instead of growing the table;
+    // pages only take inserts again once a quarter of them is free, so it
+    // grows a little at first
+    size_t churn_pages;
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        TableHeap table(&bpm, first_page_id);
+        vector<uint32_t> live;
+        for (TableIterator it = table.Begin(); !it.IsEnd(); it.Next()) {
+            uint32_t i;
+            memcpy(&i, it.GetData(), sizeof(i));
+            live.push_back(i);
+        }
+        mt19937 rng(27);
+        vector<char> record;
+        for (int round = 0; round < 10; ++round) {
+            shuffle(live.begin(), live.end(), rng);
+            for (size_t j = 0; j < live.size() / 2; ++j) {
+                bool deleted = table.DeleteRecord(rids[live[j]]);
+                assert(deleted);
+                (void)deleted;
+                make_record(live[j], &record);
+                rids[live[j]] = table.InsertRecord(record.data(), record.size());
+            }
+        }
+        churn_pages = table.GetPageCount();
+        assert(churn_pages < num_pages * 11 / 10);
+        for (uint32_t i : live) {
+            vector<char> fetched;
+            bool found = table.GetRecord(rids[i], &fetched);
+            assert(found && (i % 5 == 1 || check_record(i, fetched.data(), fetched.size())));
+            (void)found;
+        }
+    }
+    remove(DB_FILE);
+    
+    double overhead = static_cast<double>(num_pages * PAGE_SIZE - payload_bytes) / NUM_RECORDS;
+    cout << "✓ " << NUM_RECORDS << " records (16-80 bytes) on " << num_pages << " pages: insert "
+         << static_cast<int>(insert_rate) << " records/s, scan " << static_cast<int>(scan_rate)
+         << " records/s" << endl;
+    cout << "✓ " << overhead << " bytes of overhead per record (4-byte slot, page headers, unused tail)"
+         << endl;
+    cout << "✓ 10 rounds of deleting and reinserting half the records: " << churn_pages << " pages, was "
+         << num_pages << endl;
+    
+    cout << "Test 27 PASSED" << endl;
+}
+
+// Test 28: B+ Tree Index with Optimistic Latch Crabbing
+void TestBPlusTree() {
+    cout << "\n=== Test 28: B+ Tree Index with Optimistic Latch Crabbing ===" << endl;
+    
+    const char* DB_FILE = "test_bplus_tree.db";
+    remove(DB_FILE);
+    auto rid_for = [](int64_t key) {
+        return RID(static_cast<page_id_t>(key / 100), static_cast<uint16_t>(key % 100));
+    };
+    
+    // Tiny nodes so splits, borrows and merges happen at every level; the
+    // pool is smaller than the tree, so nodes also go to disk and back
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        BPlusTree tree(&bpm, 4, 4);
+        const int64_t NUM_KEYS = 5000;
+        vector<int64_t> keys(NUM_KEYS);
+        for (int64_t i = 0; i < NUM_KEYS; ++i) {
+            keys[i] = i * 2;  // Odd keys stay missing
+        }
+        mt19937 rng(28);
+        shuffle(keys.begin(), keys.end(), rng);
+        for (int64_t key : keys) {
+            bool inserted = tree.Insert(key, rid_for(key));
+            assert(inserted);
+            (void)inserted;
+        }
+        assert(!tree.Insert(keys[0], RID()));
+        uint32_t full_height = tree.GetHeight();
+        assert(full_height >= 6);
+        
+        RID rid;
+        for (int64_t key = 0; key < NUM_KEYS * 2; ++key) {
+            bool found = tree.GetValue(key, &rid);
+            assert(found == (key % 2 == 0));
+            assert(!found || rid == rid_for(key));
+            (void)found;
+        }
+        int64_t expected = 0;
+        for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            assert(it.GetKey() == expected && it.GetRID() == rid_for(expected));
+            expected += 2;
+        }
+        assert(expected == NUM_KEYS * 2);
+        
+        // Range scan from a missing key starts at the next one
+        int64_t count = 0;
+        for (BPlusTreeIterator it = tree.Begin(1001); !it.IsEnd() && it.GetKey() <= 2000; it.Next()) {
+            assert(it.GetKey() == 1002 + 2 * count);
+            count++;
+        }
+        assert(count == 500);
+        
+        // Remove half, then the rest: the tree shrinks back to a single leaf
+        shuffle(keys.begin(), keys.end(), rng);
+        for (int64_t i = 0; i < NUM_KEYS / 2; ++i) {
+            bool removed = tree.Remove(keys[i]);
+            assert(removed);
+            (void)removed;
+        }
+        assert(!tree.Remove(keys[0]));
+        assert(!tree.Remove(1));
+        for (int64_t i = 0; i < NUM_KEYS; ++i) {
+            assert(tree.GetValue(keys[i], &rid) == (i >= NUM_KEYS / 2));
+        }
+        int64_t previous = -1;
+        count = 0;
+        for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            assert(it.GetKey() > previous);
+            previous = it.GetKey();
+            count++;
+        }
+        assert(count == NUM_KEYS / 2);
+        for (int64_t i = NUM_KEYS / 2; i < NUM_KEYS; ++i) {
+            tree.Remove(keys[i]);
+        }
+        assert(tree.Begin().IsEnd());
+        assert(tree.GetHeight() == 1);
+        cout << "✓ " << NUM_KEYS << " keys with 4-entry nodes: height " << full_height
+             << ", point and range lookups correct, height 1 after removing all" << endl;
+        (void)full_height;
+    }
+    remove(DB_FILE);
+    
+    // Full-page nodes: 100K keys, reopened from the header page
+    const int64_t NUM_KEYS = 100000;
+    page_id_t header_page_id;
+    uint32_t height;
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(1024, &disk_manager);
+        BPlusTree tree(&bpm);
+        header_page_id = tree.GetHeaderPageId();
+        vector<int64_t> keys(NUM_KEYS);
+        for (int64_t i = 0; i < NUM_KEYS; ++i) {
+            keys[i] = i;
+        }
+        shuffle(keys.begin(), keys.end(), mt19937(7));
+        for (int64_t key : keys) {
+            tree.Insert(key, rid_for(key));
+        }
+        height = tree.GetHeight();
+        assert(height == 2);
+    }
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(1024, &disk_manager);
+        BPlusTree tree(&bpm, header_page_id);
+        int64_t expected = 0;
+        for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            assert(it.GetKey() == expected && it.GetRID() == rid_for(expected));
+            expected++;
+        }
+        assert(expected == NUM_KEYS);
+    }
+    remove(DB_FILE);
+    cout << "✓ " << NUM_KEYS << " keys in " << BPlusTreeLeafPage<BPlusTreeKey>::CAPACITY - 1
+         << "-entry leaves, height " << height << ", intact after reopening" << endl;
+    
+    // Concurrent inserts and removes on small nodes, so many go pessimistic:
+    // thread t owns keys congruent to t, inserts them all, removes half
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(512, &disk_manager);
+        BPlusTree tree(&bpm, 8, 8);
+        const int THREADS = 8;
+        const int64_t PER_THREAD = 2000;
+        vector<thread> threads;
+        for (int t = 0; t < THREADS; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int64_t i = 0; i < PER_THREAD; ++i) {
+                    int64_t key = i * THREADS + t;
+                    bool inserted = tree.Insert(key, rid_for(key));
+                    assert(inserted);
+                    (void)inserted;
+                }
+                for (int64_t i = 0; i < PER_THREAD; i += 2) {
+                    bool removed = tree.Remove(i * THREADS + t);
+                    assert(removed);
+                    (void)removed;
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        int64_t count = 0;
+        for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            assert((it.GetKey() / THREADS) % 2 == 1);
+            assert(it.GetRID() == rid_for(it.GetKey()));
+            count++;
+        }
+        assert(count == THREADS * PER_THREAD / 2);
+        cout << "✓ " << THREADS << " threads inserted and removed concurrently, "
+             << tree.GetPessimisticCount() << " of " << THREADS * PER_THREAD * 3 / 2
+             << " writes restarted with write latches" << endl;
+    }
+    remove(DB_FILE);
+    
+    // Throughput against thread count on a resident tree
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(4096, &disk_manager);
+        BPlusTree tree(&bpm);
+        const int64_t PRELOADED = 200000;
+        for (int64_t key = 0; key < PRELOADED; ++key) {
+            tree.Insert(key * 2, rid_for(key * 2));
+        }
+        
+        const int64_t OPS = 400000;
+        cout << "✓ Throughput (" << PRELOADED << " keys preloaded, " << thread::hardware_concurrency()
+             << " hardware threads):" << endl;
+        int64_t next_odd = 1;
+        for (int threads_count : {1, 2, 4, 8}) {
+            int64_t per_thread = OPS / threads_count;
+            auto run = [&](const function<void(int, int64_t)>& op) {
+                auto start = chrono::high_resolution_clock::now();
+                vector<thread> threads;
+                for (int t = 0; t < threads_count; ++t) {
+                    threads.emplace_back([&, t]() {
+                        for (int64_t i = 0; i < per_thread; ++i) {
+                            op(t, i);
+                        }
+                    });
+                }
+                for (auto& thread : threads) {
+                    thread.join();
+                }
+                return per_thread * threads_count /
+                       chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+            };
+            
+            double lookups = run([&](int t, int64_t i) {
+                RID rid;
+                int64_t key = ((i * 7919 + t * 104729) % PRELOADED) * 2;
+                bool found = tree.GetValue(key, &rid);
+                assert(found);
+                (void)found;
+            });
+            // Inserts of fresh odd keys, each thread its own stripe
+            int64_t base = next_odd;
+            double inserts = run([&](int t, int64_t i) {
+                int64_t key = base + 2 * (i * threads_count + t);
+                bool inserted = tree.Insert(key, rid_for(key));
+                assert(inserted);
+                (void)inserted;
+            });
+            next_odd += 2 * per_thread * threads_count;
+            cout << "    " << threads_count << " thread" << (threads_count == 1 ? ": " : "s: ")
+                 << static_cast<int>(lookups) << " lookups/s, " << static_cast<int>(inserts)
+                 << " inserts/s" << endl;
+        }
+    }
+    remove(DB_FILE);
+    
+    cout << "Test 28 PASSED" << endl;
+}
+
+// Test 29: B+ Tree Bulk Loading
+void TestBPlusTreeBulkLoad() {
+    cout << "\n=== Test 29: B+ Tree Bulk Loading ===" << endl;
+    
+    const char* DB_FILE = "test_bulk_load.db";
+    remove(DB_FILE);
+    auto rid_for = [](int64_t key) {
+        return RID(static_cast<page_id_t>(key / 100), static_cast<uint16_t>(key % 100));
+    };
+    // Even keys from 0 up to 2 * (count - 1)
+    auto even_keys = [&](int64_t count) {
+        auto next = make_shared<int64_t>(0);
+        return BPlusTreeEntrySource([=](BPlusTreeKey* key, RID* rid) {
+            if (*next == count) {
+                return false;
+            }
+            *key = 2 * (*next)++;
+            *rid = rid_for(*key);
+            return true;
+        });
+    };
+    
+    // Every size around the node boundaries of 4-entry nodes, then usable
+    // as a normal tree
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(128, &disk_manager);
+        for (double fill_factor : {1.0, 0.5}) {
+            for (int64_t count : {0, 1, 2, 3, 4, 5, 7, 9, 16, 17, 63, 65, 100, 1000, 4097}) {
+                BPlusTree tree(&bpm, 4, 4);
+                size_t loaded = tree.BulkLoad(even_keys(count), fill_factor);
+                assert(static_cast<int64_t>(loaded) == count);
+                (void)loaded;
+                int64_t expected = 0;
+                for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+                    assert(it.GetKey() == expected && it.GetRID() == rid_for(expected));
+                    expected += 2;
+                }
+                assert(expected == 2 * count);
+                
+                // Fill the gaps, then empty it again
+                RID rid;
+                for (int64_t key = 1; key < 2 * count; key += 2) {
+                    bool inserted = tree.Insert(key, rid_for(key));
+                    assert(inserted);
+                    (void)inserted;
+                }
+                for (int64_t key = 0; key < 2 * count; ++key) {
+                    assert(tree.GetValue(key, &rid) && rid == rid_for(key));
+                }
+                for (int64_t key = 0; key < 2 * count; ++key) {
+                    bool removed = tree.Remove(key);
+                    assert(removed);
+                    (void)removed;
+                }
+                assert(tree.Begin().IsEnd() && tree.GetHeight() == 1);
+            }
+        }
+        
+        // Only an empty tree can be loaded, and bad input leaves it empty
+        BPlusTree tree(&bpm, 4, 4);
+        page_id_t pages_before = disk_manager.GetNumPages();
+        bool threw = false;
+        try {
+            vector<int64_t> keys = {1, 2, 3, 5, 4};
+            size_t next = 0;
+            tree.BulkLoad([&](BPlusTreeKey* key, RID* rid) {
+                if (next == keys.size()) {
+                    return false;
+                }
+                *key = keys[next++];
+                *rid = RID();
+                return true;
+            });
+        } catch (const invalid_argument&) {
+            threw = true;
+        }
+        assert(threw && tree.Begin().IsEnd());
+        assert(disk_manager.GetNumPages() == pages_before);
+        tree.BulkLoad(even_keys(10));
+        threw = false;
+        try {
+            tree.BulkLoad(even_keys(10));
+        } catch (const logic_error&) {
+            threw = true;
+        }
+        assert(threw);
+        (void)pages_before;
+    }
+    remove(DB_FILE);
+    cout << "✓ Loads of 0 to 4097 keys into 4-entry nodes at fill factors 1.0 and 0.5 "
+         << "take inserts and removes afterwards" << endl;
+    
+    // The loaded root takes over the empty root's page, so a reader that
+    // still has that page pinned does not make the load leak it
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(128, &disk_manager);
+        auto used_pages = [&]() {
+            return static_cast<size_t>(disk_manager.GetNumPages()) - disk_manager.GetFreePageCount();
+        };
+        auto root_of = [&](const BPlusTree& tree) {
+            ReadPageGuard guard = bpm.FetchPageRead(tree.GetHeaderPageId());
+            return reinterpret_cast<const BPlusTreeHeader*>(guard.GetData())->root_page_id;
+        };
+        size_t used[2];
+        for (int pinned = 0; pinned < 2; ++pinned) {
+            size_t before = used_pages();
+            BPlusTree tree(&bpm, 4, 4);
+            page_id_t root_page_id = root_of(tree);
+            if (pinned) {
+                Page* page = bpm.FetchPage(root_page_id);
+                assert(page != nullptr);
+                (void)page;
+            }
+            tree.BulkLoad(even_keys(100));
+            if (pinned) {
+                bpm.UnpinPage(root_page_id, false);
+            }
+            assert(root_of(tree) == root_page_id && tree.GetHeight() > 1);
+            RID rid;
+            assert(tree.GetValue(198, &rid) && rid == rid_for(198));
+            (void)rid;
+            used[pinned] = used_pages() - before;
+        }
+        assert(used[0] == used[1]);
+    }
+    remove(DB_FILE);
+    cout << "✓ Bulk load keeps the empty root's page, pinned or not" << endl;
+    
+    // Bulk load against single-key inserts of the same ascending keys
+    const int64_t NUM_KEYS = 1000000;
+    struct BuildResult {
+        double build_ms;
+        double scan_ms;
+        page_id_t pages;
+        uint32_t height;
+        size_t leaves;
+        size_t sequential_leaves;  // Leaves whose right sibling is the next page
+    };
+    auto build = [&](bool bulk) {
+        BuildResult result;
+        remove(DB_FILE);
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(1024, &disk_manager);
+        page_id_t pages_before = disk_manager.GetNumPages();
+        
+        auto start = chrono::high_resolution_clock::now();
+        BPlusTree tree(&bpm);
+        if (bulk) {
+            tree.BulkLoad(even_keys(NUM_KEYS));
+        } else {
+            for (int64_t i = 0; i < NUM_KEYS; ++i) {
+                tree.Insert(2 * i, rid_for(2 * i));
+            }
+        }
+        bpm.FlushAllPages();
+        result.build_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        result.pages = disk_manager.GetNumPages() - pages_before;
+        result.height = tree.GetHeight();
+        
+        start = chrono::high_resolution_clock::now();
+        int64_t count = 0;
+        for (BPlusTreeIterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            count++;
+        }
+        result.scan_ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+        assert(count == NUM_KEYS);
+        
+        // Walk the leaf chain from the leftmost leaf
+        page_id_t page_id;
+        {
+            ReadPageGuard header = bpm.FetchPageRead(tree.GetHeaderPageId());
+            page_id = reinterpret_cast<const BPlusTreeHeader*>(header.GetData())->root_page_id;
+        }
+        for (uint32_t level = 1; level < result.height; ++level) {
+            ReadPageGuard node = bpm.FetchPageRead(page_id);
+            page_id = BPlusTreeInternalPage<BPlusTreeKey>::View(node.GetPage()).ChildAt(0);
+        }
+        result.leaves = 0;
+        result.sequential_leaves = 0;
+        while (page_id != INVALID_PAGE_ID) {
+            ReadPageGuard leaf = bpm.FetchPageRead(page_id);
+            page_id_t next_page_id = BPlusTreeLeafPage<BPlusTreeKey>::View(leaf.GetPage()).GetNextPageId();
+            result.leaves++;
+            if (next_page_id == page_id + 1) {
+                result.sequential_leaves++;
+            }
+            page_id = next_page_id;
+        }
+        return result;
+    };
+    BuildResult inserted = build(false);
+    BuildResult loaded = build(true);
+    remove(DB_FILE);
+    
+    assert(loaded.pages < inserted.pages);
+    assert(loaded.height <= inserted.height);
+    // Leaves only leave their run at its end
+    assert(loaded.sequential_leaves + loaded.leaves / (BPLUS_TREE_BULK_LOAD_RUN_PAGES - 1) + 1 >= loaded.leaves);
+    cout << "✓ " << NUM_KEYS << " ascending keys:" << endl;
+    for (const auto& entry : {make_pair("Inserts:  ", inserted), make_pair("Bulk load:", loaded)}) {
+        const BuildResult& result = entry.second;
+        cout << "    " << entry.first << " build " << result.build_ms << " ms, " << result.pages
+             << " pages (" << result.leaves << " leaves, " << result.sequential_leaves
+             << " followed by the next page), height " << result.height << ", scan "
+             << result.scan_ms << " ms" << endl;
+    }
+    
+    cout << "Test 29 PASSED" << endl;
+}
+
+// Test 30: Extendible Hash Index
+void TestExtendibleHashTable() {
+    cout << "\n=== Test 30: Extendible Hash Index ===" << endl;
+    
+    const char* DB_FILE = "test_hash_table.db";
+    remove(DB_FILE);
+    auto rid_for = [](int64_t value) {
+        return RID(static_cast<page_id_t>(value / 100), static_cast<uint16_t>(value % 100));
+    };
+    
+    // Cell positions of 1000 sessions and player names, in a pool smaller
+    // than the table
+    const int SESSIONS = 1000;
+    const int NAMES = 20000;
+    page_id_t header_page_id;
+    size_t buckets;
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        ExtendibleHashTable table(&bpm);
+        header_page_id = table.GetHeaderPageId();
+        for (int session = 0; session < SESSIONS; ++session) {
+            for (int cell = 0; cell < 100; ++cell) {
+                bool inserted = table.Insert(HashTablePositionKey(session, cell / 10, cell % 10),
+                                             rid_for(session * 100 + cell));
+                assert(inserted);
+                (void)inserted;
+            }
+        }
+        for (int i = 0; i < NAMES; ++i) {
+            table.Insert("player_" + to_string(i), rid_for(i));
+        }
+        assert(!table.Insert(HashTablePositionKey(7, 3, 4), RID()));
+        assert(!table.Insert("player_42", RID()));
+        
+        bool threw = false;
+        try {
+            table.Insert(string(HASH_TABLE_MAX_KEY_SIZE + 1, 'x'), RID());
+        } catch (const invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        (void)threw;
+        
+        RID rid;
+        for (int session = 0; session < SESSIONS; ++session) {
+            for (int cell = 0; cell < 100; ++cell) {
+                assert(table.GetValue(HashTablePositionKey(session, cell / 10, cell % 10), &rid));
+                assert(rid == rid_for(session * 100 + cell));
+            }
+        }
+        assert(!table.GetValue(HashTablePositionKey(SESSIONS, 0, 0), &rid));
+        assert(!table.GetValue("player_" + to_string(NAMES), &rid));
+        
+        // Remove the odd sessions
+        for (int session = 1; session < SESSIONS; session += 2) {
+            for (int cell = 0; cell < 100; ++cell) {
+                bool removed = table.Remove(HashTablePositionKey(session, cell / 10, cell % 10));
+                assert(removed);
+                (void)removed;
+            }
+        }
+        assert(!table.Remove(HashTablePositionKey(1, 0, 0)));
+        buckets = table.GetBucketCount();
+    }
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        ExtendibleHashTable table(&bpm, header_page_id);
+        RID rid;
+        for (int session = 0; session < SESSIONS; ++session) {
+            bool found = table.GetValue(HashTablePositionKey(session, 9, 9), &rid);
+            assert(found == (session % 2 == 0));
+            assert(!found || rid == rid_for(session * 100 + 99));
+            (void)found;
+        }
+        for (int i = 0; i < NAMES; ++i) {
+            assert(table.GetValue("player_" + to_string(i), &rid) && rid == rid_for(i));
+        }
+        assert(table.GetBucketCount() == buckets);
+    }
+    remove(DB_FILE);
+    cout << "✓ " << SESSIONS * 100 << " positions and " << NAMES << " player names in " << buckets
+         << " buckets, intact after removals and reopening" << endl;
+    
+    // The README's composite hash, hash(session) ^ (hash(row) << 1) ^
+    // (hash(col) << 2) with identity hashes, folds positions together
+    {
+        vector<uint64_t> composite;
+        vector<uint64_t> hashed;
+        for (int64_t session = 0; session < SESSIONS; ++session) {
+            for (int64_t cell = 0; cell < 100; ++cell) {
+                composite.push_back(static_cast<uint64_t>(session ^ ((cell / 10) << 1) ^ ((cell % 10) << 2)));
+                string key = HashTablePositionKey(static_cast<int32_t>(session), static_cast<int32_t>(cell / 10),
+                                                  static_cast<int32_t>(cell % 10));
+                hashed.push_back(HashTableHash(key.data(), key.size()));
+            }
+        }
+        auto distinct = [](vector<uint64_t>* values) {
+            sort(values->begin(), values->end());
+            return static_cast<size_t>(unique(values->begin(), values->end()) - values->begin());
+        };
+        size_t distinct_composite = distinct(&composite);
+        size_t distinct_hashed = distinct(&hashed);
+        assert(distinct_hashed == static_cast<size_t>(SESSIONS * 100));
+        cout << "✓ Distinct hashes of " << SESSIONS * 100 << " positions: " << distinct_composite
+             << " with the XOR-shift composite, " << distinct_hashed << " with HashTableHash" << endl;
+    }
+    
+    // Concurrent inserts splitting buckets under concurrent lookups
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(1024, &disk_manager);
+        ExtendibleHashTable table(&bpm);
+        const int WRITERS = 4;
+        const int PER_WRITER = 25000;
+        atomic<bool> done(false);
+        atomic<size_t> lookups(0);
+        vector<thread> threads;
+        for (int t = 0; t < WRITERS; ++t) {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < PER_WRITER; ++i) {
+                    int value = i * WRITERS + t;
+                    bool inserted = table.Insert("k" + to_string(value), rid_for(value));
+                    assert(inserted);
+                    (void)inserted;
+                }
+            });
+        }
+        thread reader([&]() {
+            mt19937 rng(30);
+            RID rid;
+            while (!done) {
+                int value = static_cast<int>(rng() % (WRITERS * PER_WRITER));
+                if (table.GetValue("k" + to_string(value), &rid)) {
+                    assert(rid == rid_for(value));
+                }
+                lookups++;
+            }
+        });
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        done = true;
+        reader.join();
+        RID rid;
+        for (int value = 0; value < WRITERS * PER_WRITER; ++value) {
+            assert(table.GetValue("k" + to_string(value), &rid) && rid == rid_for(value));
+        }
+        cout << "✓ " << WRITERS << " threads inserted " << WRITERS * PER_WRITER << " keys while "
+             << lookups << " lookups ran" << endl;
+    }
+    remove(DB_FILE);
+    
+    // Point lookups against the B+ tree on the same positions, all resident
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(16384, &disk_manager);
+        const int32_t BENCH_SESSIONS = 10000;
+        const int64_t NUM_KEYS = BENCH_SESSIONS * 100;
+        ExtendibleHashTable table(&bpm);
+        BPlusTree tree(&bpm);
+        page_id_t pages_before = disk_manager.GetNumPages();
+        int64_t next = 0;
+        tree.BulkLoad([&](BPlusTreeKey* key, RID* rid) {
+            if (next == NUM_KEYS) {
+                return false;
+            }
+            *key = next;
+            *rid = rid_for(next++);
+            return true;
+        });
+        page_id_t tree_pages = disk_manager.GetNumPages() - pages_before;
+        pages_before = disk_manager.GetNumPages();
+        vector<string> keys(NUM_KEYS);
+        for (int64_t i = 0; i < NUM_KEYS; ++i) {
+            keys[i] = HashTablePositionKey(static_cast<int32_t>(i / 100), static_cast<int32_t>(i % 100 / 10),
+                                           static_cast<int32_t>(i % 10));
+            table.Insert(keys[i], rid_for(i));
+        }
+        page_id_t table_pages = disk_manager.GetNumPages() - pages_before;
+        
+        vector<int64_t> order(NUM_KEYS);
+        for (int64_t i = 0; i < NUM_KEYS; ++i) {
+            order[i] = i;
+        }
+        shuffle(order.begin(), order.end(), mt19937(24));
+        const int64_t LOOKUPS = 1000000;
+        auto time_lookups = [&](const function<bool(int64_t, RID*)>& lookup) {
+            RID rid;
+            auto start = chrono::high_resolution_clock::now();
+            for (int64_t i = 0; i < LOOKUPS; ++i) {
+                int64_t value = order[i % NUM_KEYS];
+                bool found = lookup(value, &rid);
+                assert(found && rid == rid_for(value));
+                (void)found;
+            }
+            return LOOKUPS / chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        };
+        double tree_rate = time_lookups([&](int64_t value, RID* rid) { return tree.GetValue(value, rid); });
+        double table_rate = time_lookups([&](int64_t value, RID* rid) { return table.GetValue(keys[value], rid); });
+        
+        // Misses: the hash table mostly stops at the fingerprints
+        auto start = chrono::high_resolution_clock::now();
+        RID rid;
+        for (int64_t i = 0; i < LOOKUPS; ++i) {
+            string key = HashTablePositionKey(BENCH_SESSIONS + static_cast<int32_t>(i / 100),
+                                              static_cast<int32_t>(i % 100 / 10), static_cast<int32_t>(i % 10));
+            bool found = table.GetValue(key, &rid);
+            assert(!found);
+            (void)found;
+        }
+        double miss_rate = LOOKUPS / chrono::duration<double>(chrono::high_resolution_clock::now() - start).count();
+        
+        cout << "✓ Point lookups over " << NUM_KEYS << " positions:" << endl;
+        cout << "    B+ tree:    " << static_cast<int>(tree_rate) << " lookups/s, height "
+             << tree.GetHeight() << ", " << tree_pages << " pages" << endl;
+        cout << "    Hash index: " << static_cast<int>(table_rate) << " lookups/s ("
+             << static_cast<int>(miss_rate) << "/s for misses), " << table.GetBucketCount()
+             << " buckets, " << table_pages << " pages" << endl;
+    }
+    remove(DB_FILE);
+    
+    cout << "Test 30 PASSED" << endl;
+}
+
+// Fan-out, height and lookup latency of a bulk-loaded tree over
+// (session_id, row_index) positions, with make_key encoding a position
+struct KeyLayoutResult {
+    uint32_t leaf_fan_out;
+    uint32_t internal_fan_out;
+    uint32_t height;
+    size_t leaves;
+    double lookup_ns;
+};
+
+template <typename KeyType, typename KeyComparator = std::less<KeyType>>
+KeyLayoutResult MeasureKeyLayout(const function<KeyType(int32_t, int32_t)>& make_key,
+                                 int32_t sessions, int32_t rows, int64_t lookups) {
+    const char* DB_FILE = "test_key_layout.db";
+    remove(DB_FILE);
+    KeyLayoutResult result;
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(8192, &disk_manager);
+        BPlusTreeIndex<KeyType, KeyComparator> tree(&bpm);
+        int64_t next = 0;
+        int64_t total = static_cast<int64_t>(sessions) * rows;
+        tree.BulkLoad([&](KeyType* key, RID* rid) {
+            if (next == total) {
+                return false;
+            }
+            *key = make_key(static_cast<int32_t>(next / rows), static_cast<int32_t>(next % rows));
+            *rid = RID(static_cast<page_id_t>(next / rows), static_cast<uint16_t>(next % rows));
+            next++;
+            return true;
+        });
+        result.height = tree.GetHeight();
+        
+        // Fan-outs are the max sizes of the leftmost nodes, which grow when
+        // a node stores its keys' shared prefix once
+        page_id_t page_id;
+        {
+            ReadPageGuard header = bpm.FetchPageRead(tree.GetHeaderPageId());
+            page_id = reinterpret_cast<const BPlusTreeHeader*>(header.GetData())->root_page_id;
+        }
+        for (uint32_t level = 1; level < result.height; ++level) {
+            ReadPageGuard node = bpm.FetchPageRead(page_id);
+            const BPlusTreeInternalPage<KeyType, KeyComparator> internal =
+                BPlusTreeInternalPage<KeyType, KeyComparator>::View(node.GetPage());
+            result.internal_fan_out = internal.GetMaxSize();
+            page_id = internal.ChildAt(0);
+        }
+        {
+            ReadPageGuard leaf = bpm.FetchPageRead(page_id);
+            result.leaf_fan_out = BPlusTreeLeafPage<KeyType, KeyComparator>::View(leaf.GetPage()).GetMaxSize();
+        }
+        
+        // Count the leaves along the chain from the leftmost one
+        result.leaves = 0;
+        while (page_id != INVALID_PAGE_ID) {
+            ReadPageGuard leaf = bpm.FetchPageRead(page_id);
+            page_id = BPlusTreeLeafPage<KeyType, KeyComparator>::View(leaf.GetPage()).GetNextPageId();
+            result.leaves++;
+        }
+        
+        mt19937 rng(31);
+        vector<pair<int32_t, int32_t>> positions(lookups);
+        for (auto& position : positions) {
+            position = {static_cast<int32_t>(rng() % sessions), static_cast<int32_t>(rng() % rows)};
+        }
+        RID rid;
+        auto start = chrono::high_resolution_clock::now();
+        for (const auto& position : positions) {
+            bool found = tree.GetValue(make_key(position.first, position.second), &rid);
+            assert(found && rid == RID(static_cast<page_id_t>(position.first),
+                                        static_cast<uint16_t>(position.second)));
+            (void)found;
+        }
+        result.lookup_ns = chrono::duration<double, nano>(chrono::high_resolution_clock::now() - start).count() /
+                           static_cast<double>(lookups);
+    }
+    remove(DB_FILE);
+    return result;
+}
+
+// Test 31: Fixed-Width Key Pages
+void TestFixedWidthKeys() {
+    cout << "\n=== Test 31: Fixed-Width Key Pages ===" << endl;
+    
+    const char* DB_FILE = "test_fixed_width_keys.db";
+    remove(DB_FILE);
+    using CompositeTree = BPlusTreeIndex<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>;
+    auto rid_for = [](int32_t session_id, int32_t row_index) {
+        return RID(static_cast<page_id_t>(session_id + 1000), static_cast<uint16_t>(row_index));
+    };
+    
+    // Composite keys on small nodes, inserted out of order, with negative
+    // sessions so the comparator's signed order is exercised
+    {
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        CompositeTree tree(&bpm, 4, 4);
+        const int32_t FIRST_SESSION = -100;
+        const int32_t SESSIONS = 200;
+        const int32_t ROWS = 10;
+        vector<BPlusTreeCompositeKey> keys;
+        for (int32_t session_id = FIRST_SESSION; session_id < FIRST_SESSION + SESSIONS; ++session_id) {
+            for (int32_t row_index = 0; row_index < ROWS; ++row_index) {
+                keys.push_back({session_id, row_index});
+            }
+        }
+        shuffle(keys.begin(), keys.end(), mt19937(31));
+        for (const BPlusTreeCompositeKey& key : keys) {
+            bool inserted = tree.Insert(key, rid_for(key.first, key.second));
+            assert(inserted);
+            (void)inserted;
+        }
+        bool duplicate = tree.Insert({FIRST_SESSION, 0}, rid_for(0, 0));
+        assert(!duplicate);
+        (void)duplicate;
+        
+        // A scan visits sessions in order and rows in order within each
+        int32_t expected = 0;
+        for (CompositeTree::Iterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            int32_t session_id = FIRST_SESSION + expected / ROWS;
+            int32_t row_index = expected % ROWS;
+            assert(it.GetKey().first == session_id && it.GetKey().second == row_index);
+            assert(it.GetRID() == rid_for(session_id, row_index));
+            (void)session_id;
+            (void)row_index;
+            expected++;
+        }
+        assert(expected == SESSIONS * ROWS);
+        
+        // Remove the odd rows, then read one session's rows from its first key
+        for (const BPlusTreeCompositeKey& key : keys) {
+            if (key.second % 2 == 1) {
+                bool removed = tree.Remove(key);
+                assert(removed);
+                (void)removed;
+            }
+        }
+        vector<int32_t> session_rows;
+        for (CompositeTree::Iterator it = tree.Begin({-1, 0}); !it.IsEnd() && it.GetKey().first == -1; it.Next()) {
+            session_rows.push_back(it.GetKey().second);
+        }
+        assert((session_rows == vector<int32_t>{0, 2, 4, 6, 8}));
+        RID rid;
+        bool found = tree.GetValue({-1, 3}, &rid);
+        assert(!found);
+        found = tree.GetValue({-1, 4}, &rid);
+        assert(found && rid == rid_for(-1, 4));
+        (void)found;
+        
+        // Bulk loading rejects a key that is not above the previous one
+        int calls = 0;
+        bool threw = false;
+        try {
+            CompositeTree empty(&bpm, 4, 4);
+            empty.BulkLoad([&](BPlusTreeCompositeKey* key, RID* rid) {
+                *key = {0, calls == 1 ? 0 : calls};
+                *rid = rid_for(0, calls);
+                return ++calls <= 3;
+            });
+        } catch (const invalid_argument&) {
+            threw = true;
+        }
+        assert(threw);
+        (void)threw;
+    }
+    remove(DB_FILE);
+    cout << "✓ Composite keys keep (session_id, row_index) order through inserts, removes and scans" << endl;
+    
+    // Random inserts and removes over a few long sessions, so nodes keep
+    // switching between a shared session and full keys, checked against
+    // a std::set. Trees start bulk loaded, with small and larger nodes.
+    for (uint32_t max_size : {4u, 16u}) {
+        remove(DB_FILE);
+        DiskManager disk_manager(DB_FILE);
+        BufferPoolManager bpm(256, &disk_manager);
+        CompositeTree tree(&bpm, max_size, max_size);
+        const int32_t SESSIONS = 3;
+        const int32_t ROWS = 2000;
+        set<pair<int32_t, int32_t>> expected;
+        int32_t next = 0;
+        tree.BulkLoad([&](BPlusTreeCompositeKey* key, RID* rid) {
+            if (next == SESSIONS * ROWS) {
+                return false;
+            }
+            *key = {next / ROWS - 1, next % ROWS};
+            *rid = rid_for(key->first, key->second);
+            expected.insert({key->first, key->second});
+            next += 2;
+            return true;
+        }, 0.5);
+        
+        mt19937 rng(max_size);
+        for (int op = 0; op < 40000; ++op) {
+            BPlusTreeCompositeKey key{static_cast<int32_t>(rng() % SESSIONS) - 1,
+                                      static_cast<int32_t>(rng() % ROWS)};
+            if (rng() % 2 == 0) {
+                bool inserted = tree.Insert(key, rid_for(key.first, key.second));
+                bool added = expected.insert({key.first, key.second}).second;
+                assert(inserted == added);
+                (void)inserted;
+                (void)added;
+            } else {
+                bool removed = tree.Remove(key);
+                bool erased = expected.erase({key.first, key.second}) == 1;
+                assert(removed == erased);
+                (void)removed;
+                (void)erased;
+            }
+        }
+        
+        auto expected_it = expected.begin();
+        for (CompositeTree::Iterator it = tree.Begin(); !it.IsEnd(); it.Next()) {
+            assert(expected_it != expected.end());
+            assert(it.GetKey().first == expected_it->first && it.GetKey().second == expected_it->second);
+            assert(it.GetRID() == rid_for(expected_it->first, expected_it->second));
+            ++expected_it;
+        }
+        assert(expected_it == expected.end());
+        for (int32_t session_id = -1; session_id < SESSIONS - 1; ++session_id) {
+            for (int32_t row_index = 0; row_index < ROWS; ++row_index) {
+                RID rid;
+                bool found = tree.GetValue({session_id, row_index}, &rid);
+                assert(found == (expected.count({session_id, row_index}) == 1));
+                assert(!found || rid == rid_for(session_id, row_index));
+                (void)found;
+            }
+        }
+    }
+    remove(DB_FILE);
+    cout << "✓ Nodes storing a shared session stay consistent through random inserts and removes" << endl;
+    
+    // Nodes search a shared prefix's suffixes in their own order, so any
+    // other comparator keeps composite keys in full
+    {
+        struct SecondFirst {
+            bool operator()(const BPlusTreeCompositeKey& a, const BPlusTreeCompositeKey& b) const {
+                return a.second < b.second || (a.second == b.second && a.first < b.first);
+            }
+        };
+        static_assert(BPlusTreeLeafPage<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>::PREFIX_CAPACITY >
+                          BPlusTreeLeafPage<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>::CAPACITY,
+                      "composite keys share a prefix in their own order");
+        static_assert(BPlusTreeLeafPage<BPlusTreeCompositeKey, SecondFirst>::PREFIX_CAPACITY ==
+                          BPlusTreeLeafPage<BPlusTreeCompositeKey, SecondFirst>::CAPACITY,
+                      "composite keys in another order are stored in full");
+    }
+    cout << "✓ Composite keys share a prefix only in their lexicographic order" << endl;
+    
+    // The same positions under three encodings, in long sessions. Composite
+    // keys drop the session in a node within one session, so their leaves
+    // hold as many entries as packed 32-bit ones; internal nodes span many
+    // sessions and keep full keys.
+    const int32_t SESSIONS = 50;
+    const int32_t ROWS = 10000;
+    const int64_t LOOKUPS = 1000000;
+    KeyLayoutResult wide = MeasureKeyLayout<int64_t>(
+        [](int32_t session_id, int32_t row_index) { return (static_cast<int64_t>(session_id) << 32) | row_index; },
+        SESSIONS, ROWS, LOOKUPS);
+    KeyLayoutResult composite = MeasureKeyLayout<BPlusTreeCompositeKey, BPlusTreeCompositeKeyComparator>(
+        [](int32_t session_id, int32_t row_index) { return BPlusTreeCompositeKey{session_id, row_index}; },
+        SESSIONS, ROWS, LOOKUPS);
+    KeyLayoutResult packed = MeasureKeyLayout<int32_t>(
+        [](int32_t session_id, int32_t row_index) { return (session_id << 14) | row_index; },
+        SESSIONS, ROWS, LOOKUPS);
+    
+    // One root over the 32-bit leaves; 64-bit keys need another level.
+    // Composite leaves only fall short of packed ones where a session ends.
+    assert(packed.internal_fan_out > wide.internal_fan_out);
+    assert(composite.leaf_fan_out == packed.leaf_fan_out && composite.leaf_fan_out > wide.leaf_fan_out);
+    assert(composite.leaves < wide.leaves && composite.leaves <= packed.leaves + SESSIONS);
+    assert(packed.height == 2 && wide.height == 3 && composite.height <= wide.height);
+    
+    cout << "✓ " << SESSIONS * ROWS << " positions, " << LOOKUPS << " random lookups:" << endl;
+    auto report = [](const char* name, const KeyLayoutResult& result) {
+        cout << "    " << name << result.leaf_fan_out << "/" << result.internal_fan_out
+             << " fan-out, height " << result.height << ", " << result.leaves << " leaves, "
+             << static_cast<int>(result.lookup_ns) << " ns/lookup" << endl;
+    };
+    report("int64_t:               ", wide);
+    report("BPlusTreeCompositeKey: ", composite);
+    report("packed int32_t:        ", packed);
+    
+    cout << "Test 31 PASSED" << endl;
+}
+
 int main() {
     cout << "=====================================" << endl;
     cout << "  Logic Maze Database - Phase 1 Tests" << endl;
@@ -251,6 +3759,31 @@ int main() {
         TestLRUEviction();
         TestRandomAccessBenchmark();
         TestChecksumVerification();
+        TestParallelHitThroughput();
+        TestAllocationFreeHitPath();
+        TestClockReplacer();
+        TestScanResistance();
+        TestPageGuards();
+        TestIOOutsideLatch();
+        TestConcurrentDiskIO();
+        TestGroupFlushBulkLoad();
+        TestAsyncDiskIO();
+        TestReadAhead();
+        TestPageCleaner();
+        TestCrc32cChecksums();
+        TestMmapDiskManager();
+        TestFrameArena();
+        TestOnlineResize();
+        TestWarmUp();
+        TestFreeSpaceMap();
+        TestExtentGrowth();
+        TestWriteAheadLog();
+        TestCheckpointRecovery();
+        TestTableHeap();
+        TestBPlusTree();
+        TestBPlusTreeBulkLoad();
+        TestExtendibleHashTable();
+        TestFixedWidthKeys();
         
         cout << "\n=====================================" << endl;
         cout << "  ✓ ALL TESTS PASSED!" << endl;